@@ -0,0 +1,131 @@
+#include "Configuration/ConfigFileWriter.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Configuration/ConfigManager.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#elif PLATFORM_UNIX || PLATFORM_MAC
+#include <stdio.h>
+#endif
+
+FConfigFileWriter::~FConfigFileWriter() {
+    Flush();
+}
+
+void FConfigFileWriter::EnqueueWrite(const FString& FilePath, FString&& FileContents) {
+    FPendingWrite PendingWrite;
+    PendingWrite.TextContents = MoveTemp(FileContents);
+    EnqueueWriteInternal(FilePath, MoveTemp(PendingWrite));
+}
+
+void FConfigFileWriter::EnqueueWrite(const FString& FilePath, TArray<uint8>&& FileContents) {
+    FPendingWrite PendingWrite;
+    PendingWrite.BinaryContents = MoveTemp(FileContents);
+    PendingWrite.bIsBinary = true;
+    EnqueueWriteInternal(FilePath, MoveTemp(PendingWrite));
+}
+
+void FConfigFileWriter::EnqueueWriteInternal(const FString& FilePath, FPendingWrite&& PendingWrite) {
+    check(IsInGameThread());
+    FScopeLock Lock(&QueueLock);
+    PendingWrites.Add(FilePath, MoveTemp(PendingWrite));
+
+    //Start the worker if it is not running already, otherwise it will pick the new write up before finishing
+    if (!bWriteTaskRunning) {
+        bWriteTaskRunning = true;
+        WriteTask = Async(EAsyncExecution::ThreadPool, [this]() { ProcessPendingWrites(); });
+    }
+}
+
+void FConfigFileWriter::Flush() {
+    while (true) {
+        {
+            FScopeLock Lock(&QueueLock);
+            if (!bWriteTaskRunning) {
+                return;
+            }
+        }
+        WriteTask.Wait();
+    }
+}
+
+void FConfigFileWriter::ProcessPendingWrites() {
+    while (true) {
+        TMap<FString, FPendingWrite> CurrentWrites;
+        {
+            FScopeLock Lock(&QueueLock);
+            if (PendingWrites.Num() == 0) {
+                bWriteTaskRunning = false;
+                return;
+            }
+            CurrentWrites = MoveTemp(PendingWrites);
+            PendingWrites.Reset();
+        }
+        for (const TPair<FString, FPendingWrite>& Pair : CurrentWrites) {
+            if (!WriteFileAtomically(Pair.Key, Pair.Value)) {
+                UE_LOG(LogConfigManager, Error, TEXT("Failed to save configuration file to %s"), *Pair.Key);
+                continue;
+            }
+            UE_LOG(LogConfigManager, Display, TEXT("Saved configuration to %s"), *Pair.Key);
+        }
+    }
+}
+
+bool FConfigFileWriter::WriteFileAtomically(const FString& FilePath, const FPendingWrite& PendingWrite) {
+    //Make sure configuration directory exists
+    FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*FPaths::GetPath(FilePath));
+
+    const FString TempFilePath = FilePath + TEXT(".tmp");
+    const bool bWrittenTempFile = PendingWrite.bIsBinary ?
+        FFileHelper::SaveArrayToFile(PendingWrite.BinaryContents, *TempFilePath) :
+        FFileHelper::SaveStringToFile(PendingWrite.TextContents, *TempFilePath);
+    if (!bWrittenTempFile) {
+        return false;
+    }
+    if (!ReplaceFile(FilePath, TempFilePath)) {
+        IFileManager::Get().Delete(*TempFilePath, false, false, true);
+        return false;
+    }
+    return true;
+}
+
+bool FConfigFileWriter::ReplaceFile(const FString& FilePath, const FString& SourceFilePath) {
+    //IFileManager::Move deletes the destination before renaming the source, so a crash in between would leave no file at all.
+    //Platform rename replaces the destination in a single step instead, so the file either has old or new contents
+    const FString AbsoluteFilePath = IFileManager::Get().ConvertToAbsolutePathForExternalAppForWrite(*FilePath);
+    const FString AbsoluteSourceFilePath = IFileManager::Get().ConvertToAbsolutePathForExternalAppForWrite(*SourceFilePath);
+#if PLATFORM_WINDOWS
+    return MoveFileExW(*AbsoluteSourceFilePath, *AbsoluteFilePath, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#elif PLATFORM_UNIX || PLATFORM_MAC
+    return rename(TCHAR_TO_UTF8(*AbsoluteSourceFilePath), TCHAR_TO_UTF8(*AbsoluteFilePath)) == 0;
+#else
+    //No atomic replace available, keep the previous contents around until the new file is in place
+    const FString BackupFilePath = GetBackupFilePath(FilePath);
+    if (IFileManager::Get().FileExists(*FilePath) && !IFileManager::Get().Move(*BackupFilePath, *FilePath, true, true)) {
+        return false;
+    }
+    if (!IFileManager::Get().Move(*FilePath, *SourceFilePath, true, true)) {
+        return false;
+    }
+    IFileManager::Get().Delete(*BackupFilePath, false, false, true);
+    return true;
+#endif
+}
+
+FString FConfigFileWriter::GetBackupFilePath(const FString& FilePath) {
+    return FilePath + TEXT(".bak");
+}
+
+void FConfigFileWriter::RecoverInterruptedWrite(const FString& FilePath) {
+    //Backup is only left behind if we crashed after moving the original file away, but before moving the new one in place
+    const FString BackupFilePath = GetBackupFilePath(FilePath);
+    if (!IFileManager::Get().FileExists(*FilePath) && IFileManager::Get().FileExists(*BackupFilePath)) {
+        UE_LOG(LogConfigManager, Warning, TEXT("Restoring configuration file %s from the backup left by an interrupted save"), *FilePath);
+        IFileManager::Get().Move(*FilePath, *BackupFilePath, false, true);
+    }
+}
@@ -4,10 +4,17 @@
 #include "Util/SemVersion.h"
 #include "TimerManager.h"
 #include "Configuration/RootConfigValueHolder.h"
+#include "Configuration/Properties/ConfigPropertyArray.h"
+#include "Configuration/Properties/ConfigPropertySection.h"
 #include "Configuration/RawFileFormat/Json/JsonRawFormatConverter.h"
+#include "Configuration/RawFileFormat/RawFormatValueObject.h"
 #include "Engine/Engine.h"
 #include "ModLoading/ModLoadingLibrary.h"
 #include "Util/EngineUtil.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Hash/CityHash.h"
+#include "SatisfactoryModLoader.h"
 
 DEFINE_LOG_CATEGORY(LogConfigManager);
 
@@ -15,6 +22,13 @@ const TCHAR* SMLConfigModVersionField = TEXT("SML_ModVersion_DoNotChange");
 
 void UConfigManager::ReloadModConfigurations() {
     UE_LOG(LogConfigManager, Display, TEXT("Reloading mod configurations..."));
+    //Make sure we are not going to read files that are still being written, or use outdated prefetched state
+    ConfigFileWriter.Flush();
+    if (PrefetchedConfigurationsFuture.IsValid()) {
+        PrefetchedConfigurationsFuture.Wait();
+        PrefetchedConfigurationsFuture = TFuture<TMap<FString, FConfigurationFileContents>>();
+    }
+    PrefetchedConfigurations.Empty();
     
     for (const TPair<FConfigId, FRegisteredConfigurationData>& Pair : Configurations) {
         LoadConfigurationInternal(Pair.Key, Pair.Value.RootValue, true);
@@ -25,13 +39,13 @@ void UConfigManager::SaveConfigurationInternal(const FConfigId& ConfigId) {
     const FRegisteredConfigurationData& ConfigurationData = Configurations.FindChecked(ConfigId);
     
     const URootConfigValueHolder* RootValue = ConfigurationData.RootValue;
-    URawFormatValue* RawFormatValue = RootValue->GetWrappedValue()->Serialize(GetTransientPackage());
-    checkf(RawFormatValue, TEXT("Root RawFormatValue returned NULL for config %s"), *ConfigId.ModReference);
+    const TSharedPtr<FJsonValue> JsonValue = SerializePropertyToJson(RootValue->GetWrappedValue());
+    checkf(JsonValue.IsValid(), TEXT("Root value serialized to NULL for config %s"), *ConfigId.ModReference);
     
     //Root value should always be JsonObject, since root property is section property
-    const TSharedPtr<FJsonValue> JsonValue = FJsonRawFormatConverter::ConvertToJson(RawFormatValue);
+    //Copy it so the version field doesn't end up in the cached value
     check(JsonValue->Type == EJson::Object);
-    TSharedRef<FJsonObject> UnderlyingObject = JsonValue->AsObject().ToSharedRef();
+    TSharedRef<FJsonObject> UnderlyingObject = MakeShared<FJsonObject>(*JsonValue->AsObject());
     
     //Record mod version so we can keep file system file schema up to date
     FModInfo ModInfo;
@@ -42,26 +56,165 @@ void UConfigManager::SaveConfigurationInternal(const FConfigId& ConfigId) {
         UnderlyingObject->SetStringField(SMLConfigModVersionField, ModVersion);
     }
 
-    //Serialize resulting JSON to string
+    //Serialize resulting JSON to string. This snapshots configuration state, so it can be written on another thread
     FString JsonOutputString;
     const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&JsonOutputString);
     FJsonSerializer::Serialize(UnderlyingObject, JsonWriter);
 
-    //Write configuration into the file system now at the generated path
-    const FString ConfigurationFilePath = GetConfigurationFilePath(ConfigId);
-    //Make sure configuration directory exists
-    FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*FPaths::GetPath(ConfigurationFilePath));
+    //Queue configuration to be written into the file system at the generated path
+    ConfigFileWriter.EnqueueWrite(GetConfigurationFilePath(ConfigId), MoveTemp(JsonOutputString));
+}
+
+TSharedPtr<FJsonValue> UConfigManager::SerializePropertyToJson(const UConfigProperty* Property) {
+    if (Property->CachedJsonValue.IsValid()) {
+        return Property->CachedJsonValue;
+    }
+    TSharedPtr<FJsonValue> JsonValue;
     
-    if (!FFileHelper::SaveStringToFile(JsonOutputString, *ConfigurationFilePath)) {
-        UE_LOG(LogConfigManager, Error, TEXT("Failed to save configuration file to %s"), *ConfigurationFilePath);
-        return;
+    if (const UConfigPropertySection* Section = Cast<UConfigPropertySection>(Property)) {
+        //Mirrors UConfigPropertySection::Serialize, skipping NULL properties and values
+        const TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+        for (const TPair<FString, UConfigProperty*>& Pair : Section->SectionProperties) {
+            if (Pair.Value != NULL) {
+                const TSharedPtr<FJsonValue> ChildValue = SerializePropertyToJson(Pair.Value);
+                if (ChildValue.IsValid()) {
+                    JsonObject->SetField(Pair.Key, ChildValue);
+                }
+            }
+        }
+        JsonValue = MakeShared<FJsonValueObject>(JsonObject);
+        
+    } else if (const UConfigPropertyArray* Array = Cast<UConfigPropertyArray>(Property)) {
+        TArray<TSharedPtr<FJsonValue>> JsonArray;
+        JsonArray.Reserve(Array->Values.Num());
+        for (const UConfigProperty* Value : Array->Values) {
+            const TSharedPtr<FJsonValue> ElementValue = SerializePropertyToJson(Value);
+            checkf(ElementValue.IsValid(), TEXT("Array element %s serialized to NULL"), *Value->GetPathName());
+            JsonArray.Add(ElementValue);
+        }
+        JsonValue = MakeShared<FJsonValueArray>(JsonArray);
+        
+    } else {
+        //Leaf values go through the raw format, since they can be implemented in blueprints
+        const URawFormatValue* RawFormatValue = Property->Serialize(GetTransientPackage());
+        if (RawFormatValue == NULL) {
+            return NULL;
+        }
+        JsonValue = FJsonRawFormatConverter::ConvertToJson(RawFormatValue);
+    }
+    
+    Property->CachedJsonValue = JsonValue;
+    return JsonValue;
+}
+
+FConfigurationFileContents UConfigManager::ReadConfigurationFile(const FString& ConfigurationFilePath, bool bAllowBinaryCache) {
+    FConfigurationFileContents FileContents;
+    
+    //Load raw file contents, we need them to validate binary cache even if we end up not parsing them
+    TArray<uint8> FileData;
+    if (!FFileHelper::LoadFileToArray(FileData, *ConfigurationFilePath)) {
+        FileContents.ErrorMessage = FString::Printf(TEXT("Failed to load configuration file from %s"), *ConfigurationFilePath);
+        return FileContents;
+    }
+    FileContents.SourceFileInfo.SourceFileSize = FileData.Num();
+    FileContents.SourceFileInfo.SourceFileTimestamp = IFileManager::Get().GetTimeStamp(*ConfigurationFilePath);
+    FileContents.SourceFileInfo.SourceFileHash = CityHash64(reinterpret_cast<const char*>(FileData.GetData()), FileData.Num());
+
+    //Use binary cache if it has been generated from exactly the same file
+    if (bAllowBinaryCache) {
+        TArray<uint8> BinaryCacheData;
+        FBinaryConfigCacheHeader CacheHeader;
+        
+        if (FFileHelper::LoadFileToArray(BinaryCacheData, *GetBinaryCacheFilePath(ConfigurationFilePath), FILEREAD_Silent) &&
+            FBinaryRawFormatConverter::ReadHeader(BinaryCacheData, CacheHeader) &&
+            CacheHeader.MatchesSourceFile(FileContents.SourceFileInfo)) {
+            FileContents.BinaryCacheData = MoveTemp(BinaryCacheData);
+            FileContents.SourceFileInfo = CacheHeader;
+            return FileContents;
+        }
+    }
+
+    //Try to parse it as valid JSON now
+    FString JsonTextString;
+    FFileHelper::BufferToString(JsonTextString, FileData.GetData(), FileData.Num());
+    const TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(JsonTextString);
+    
+    if (!FJsonSerializer::Deserialize(JsonReader, FileContents.JsonObject)) {
+        FileContents.ErrorMessage = FString::Printf(TEXT("Failed to parse configuration file %s"), *ConfigurationFilePath);
+        FileContents.JsonObject = NULL;
+    }
+    return FileContents;
+}
+
+void UConfigManager::PrefetchConfigurationFiles() {
+    const FString ConfigurationFolderPath = GetConfigurationFolderPath();
+    const bool bAllowBinaryCache = FSatisfactoryModLoader::GetSMLConfiguration().bEnableConfigBinaryCache;
+
+    //Only loaded mods can register configurations, so files left behind by uninstalled mods are never read
+    TArray<FString> LoadedModReferences;
+    UModLoadingLibrary* ModLoadingLibrary = GEngine->GetEngineSubsystem<UModLoadingLibrary>();
+    for (const FModInfo& ModInfo : ModLoadingLibrary->GetLoadedMods()) {
+        LoadedModReferences.Add(ModInfo.Name);
+    }
+    
+    PrefetchedConfigurationsFuture = Async(EAsyncExecution::ThreadPool, [ConfigurationFolderPath, bAllowBinaryCache, LoadedModReferences]() {
+        //Mirrors GetConfigurationFilePath: mod has either a single file named after it, or a folder with a file per category
+        TArray<FString> ConfigurationFiles;
+        IFileManager& FileManager = IFileManager::Get();
+        for (const FString& ModReference : LoadedModReferences) {
+            const FString ModConfigurationFilePath = ConfigurationFolderPath + ModReference + TEXT(".cfg");
+            if (FileManager.FileExists(*ModConfigurationFilePath)) {
+                ConfigurationFiles.Add(ModConfigurationFilePath);
+            }
+            const FString ModConfigurationFolderPath = ConfigurationFolderPath + ModReference + TEXT("/");
+            TArray<FString> CategoryFileNames;
+            FileManager.FindFiles(CategoryFileNames, *(ModConfigurationFolderPath + TEXT("*.cfg")), true, false);
+            for (const FString& CategoryFileName : CategoryFileNames) {
+                ConfigurationFiles.Add(ModConfigurationFolderPath + CategoryFileName);
+            }
+        }
+
+        //Files are independent from each other, so read and parse them in parallel
+        TArray<FConfigurationFileContents> ParsedFiles;
+        ParsedFiles.SetNum(ConfigurationFiles.Num());
+        ParallelFor(ConfigurationFiles.Num(), [&](int32 Index) {
+            ParsedFiles[Index] = ReadConfigurationFile(ConfigurationFiles[Index], bAllowBinaryCache);
+        });
+
+        TMap<FString, FConfigurationFileContents> PrefetchedFiles;
+        for (int32 i = 0; i < ConfigurationFiles.Num(); i++) {
+            FPaths::NormalizeFilename(ConfigurationFiles[i]);
+            PrefetchedFiles.Add(ConfigurationFiles[i], MoveTemp(ParsedFiles[i]));
+        }
+        return PrefetchedFiles;
+    });
+}
+
+bool UConfigManager::TakePrefetchedConfigurationFile(const FString& ConfigurationFilePath, FConfigurationFileContents& OutContents) {
+    if (PrefetchedConfigurationsFuture.IsValid()) {
+        PrefetchedConfigurations = PrefetchedConfigurationsFuture.Get();
+        PrefetchedConfigurationsFuture = TFuture<TMap<FString, FConfigurationFileContents>>();
+    }
+    FString NormalizedFilePath = ConfigurationFilePath;
+    FPaths::NormalizeFilename(NormalizedFilePath);
+    return PrefetchedConfigurations.RemoveAndCopyValue(NormalizedFilePath, OutContents);
+}
+
+void UConfigManager::DiscardPrefetchedConfigurationFiles() {
+    if (PrefetchedConfigurationsFuture.IsValid()) {
+        PrefetchedConfigurations = PrefetchedConfigurationsFuture.Get();
+        PrefetchedConfigurationsFuture = TFuture<TMap<FString, FConfigurationFileContents>>();
+    }
+    if (PrefetchedConfigurations.Num() > 0) {
+        UE_LOG(LogConfigManager, Log, TEXT("Discarding %d prefetched configuration files which have not been registered by any mod"), PrefetchedConfigurations.Num());
+        PrefetchedConfigurations.Empty();
     }
-    UE_LOG(LogConfigManager, Display, TEXT("Saved configuration to %s"), *ConfigurationFilePath);
 }
 
 void UConfigManager::LoadConfigurationInternal(const FConfigId& ConfigId, URootConfigValueHolder* RootConfigValueHolder, bool bSaveOnSchemaChange) {
     //Determine configuration path and try to read it to string if it exists
     const FString ConfigurationFilePath = GetConfigurationFilePath(ConfigId);
+    FConfigFileWriter::RecoverInterruptedWrite(ConfigurationFilePath);
 
     //Check if configuration file exists, and if it doesn't, return early, optionally writing defaults
     if (!IFileManager::Get().FileExists(*ConfigurationFilePath)) {
@@ -71,39 +224,64 @@ void UConfigManager::LoadConfigurationInternal(const FConfigId& ConfigId, URootC
         return;
     }
 
-    //Load file contents into the string for parsing
-    FString JsonTextString;
-    if (!FFileHelper::LoadFileToString(JsonTextString, *ConfigurationFilePath)) {
-        UE_LOG(LogConfigManager, Error, TEXT("Failed to load configuration file from %s"), *ConfigurationFilePath);
-        return;
+    //Resolve version of the mod owning configuration, it is used to check both binary cache and file schema
+    FModInfo ModInfo;
+    UModLoadingLibrary* ModLoadingLibrary = GEngine->GetEngineSubsystem<UModLoadingLibrary>();
+    const bool bHasModInfo = ModLoadingLibrary->GetLoadedModInfo(ConfigId.ModReference, ModInfo);
+    const FString ModVersion = bHasModInfo ? ModInfo.Version.ToString() : TEXT("");
+    const bool bAllowBinaryCache = FSatisfactoryModLoader::GetSMLConfiguration().bEnableConfigBinaryCache;
+
+    //Use file read during prefetch if we have it, otherwise read it now
+    FConfigurationFileContents FileContents;
+    if (!TakePrefetchedConfigurationFile(ConfigurationFilePath, FileContents)) {
+        FileContents = ReadConfigurationFile(ConfigurationFilePath, bAllowBinaryCache);
     }
 
-    //Try to parse it as valid JSON now
-    const TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(JsonTextString);
-    TSharedPtr<FJsonObject> JsonObject;
-    if (!FJsonSerializer::Deserialize(JsonReader, JsonObject)) {
-        UE_LOG(LogConfigManager, Error, TEXT("Failed to parse configuration file %s"), *ConfigurationFilePath);
-        //TODO maybe rename it and write default values instead?
-        return;
+    //Decode binary cache if we have one. Cache written by another mod version is not trusted, since schema could have changed
+    URawFormatValue* RawFormatValue = NULL;
+    if (FileContents.BinaryCacheData.Num() > 0) {
+        if (FileContents.SourceFileInfo.ModVersion == ModVersion) {
+            RawFormatValue = FBinaryRawFormatConverter::ConvertToRawFormat(this, FileContents.BinaryCacheData);
+        }
+        if (RawFormatValue == NULL) {
+            UE_LOG(LogConfigManager, Display, TEXT("Binary cache of configuration file %s is outdated or damaged, reading the file directly"), *ConfigurationFilePath);
+            FileContents = ReadConfigurationFile(ConfigurationFilePath, false);
+        }
+    }
+
+    if (RawFormatValue == NULL) {
+        if (!FileContents.JsonObject.IsValid()) {
+            //Reading errors are only reported here, so files prefetched but never registered don't produce any
+            UE_LOG(LogConfigManager, Error, TEXT("%s"), *FileContents.ErrorMessage);
+            //TODO maybe rename it and write default values instead?
+            return;
+        }
+        //Convert JSON tree into the raw value tree
+        const TSharedRef<FJsonValue> RootValue = MakeShareable(new FJsonValueObject(FileContents.JsonObject));
+        RawFormatValue = FJsonRawFormatConverter::ConvertToRawFormat(this, RootValue);
+
+        //Remember parsed state so we can skip parsing next time if the file doesn't change
+        if (bAllowBinaryCache) {
+            FBinaryConfigCacheHeader CacheHeader = FileContents.SourceFileInfo;
+            CacheHeader.ModVersion = ModVersion;
+            TArray<uint8> BinaryCacheData;
+            FBinaryRawFormatConverter::ConvertToBinary(RawFormatValue, CacheHeader, BinaryCacheData);
+            ConfigFileWriter.EnqueueWrite(GetBinaryCacheFilePath(ConfigurationFilePath), MoveTemp(BinaryCacheData));
+        }
     }
 
-    //Convert JSON tree into the raw value tree and feed it to root section value
-    const TSharedRef<FJsonValue> RootValue = MakeShareable(new FJsonValueObject(JsonObject));
-    URawFormatValue* RawFormatValue = FJsonRawFormatConverter::ConvertToRawFormat(this, RootValue);
+    //Feed raw value tree to root section value
     RootConfigValueHolder->GetWrappedValue()->Deserialize(RawFormatValue);
+    //Deserialize doesn't mark properties dirty, so drop serialized state cached from the previous values
+    RootConfigValueHolder->GetWrappedValue()->InvalidateSerializationCache();
 
     UE_LOG(LogConfigManager, Display, TEXT("Successfully loaded configuration from %s"), *ConfigurationFilePath);
 
     //Check that mod version matches if we are allowed to overwrite files
-    FModInfo ModInfo;
-    UModLoadingLibrary* ModLoadingLibrary = GEngine->GetEngineSubsystem<UModLoadingLibrary>();
-
-    if (ModLoadingLibrary->GetLoadedModInfo(ConfigId.ModReference, ModInfo)) {
-        const FString ModVersion = ModInfo.Version.ToString();
-        FString FileVersion;
-        if (JsonObject->HasTypedField<EJson::String>(SMLConfigModVersionField)) {
-            FileVersion = JsonObject->GetStringField(SMLConfigModVersionField);
-        }
+    if (bHasModInfo) {
+        const URawFormatValueObject* RootObject = Cast<URawFormatValueObject>(RawFormatValue);
+        const FString FileVersion = RootObject ? RootObject->GetString(SMLConfigModVersionField) : TEXT("");
+        
         //Overwrite file if schema version doesn't match loaded mod version
         if (bSaveOnSchemaChange && FileVersion != ModVersion) {
             UE_LOG(LogConfigManager, Display, TEXT("Refreshing configuration file %s"), *ConfigurationFilePath);
@@ -119,6 +297,11 @@ void UConfigManager::FlushPendingSaves() {
     PendingSaveConfigurations.Empty();
 }
 
+void UConfigManager::FlushPendingSavesAndWait() {
+    FlushPendingSaves();
+    ConfigFileWriter.Flush();
+}
+
 void UConfigManager::OnTimerManagerAvailable(FTimerManager* TimerManager) {
     //Setup a timer which will force all changes into filesystem every 10 seconds
     FTimerHandle OutTimerHandle;
@@ -135,53 +318,45 @@ void UConfigManager::OnConfigMarkedDirty(FTimerManager* TimerManager) {
 }
 
 void UConfigManager::MarkConfigurationDirty(const FConfigId& ConfigId) {
+    FRegisteredConfigurationData* ConfigurationData = Configurations.Find(ConfigId);
+    if (ConfigurationData != NULL) {
+        //Caller could have changed any property value directly without marking it dirty, so none of the cached JSON can be trusted
+        ConfigurationData->RootValue->GetWrappedValue()->InvalidateSerializationCache();
+        QueueConfigurationSave(ConfigId);
+    }
+}
+
+void UConfigManager::QueueConfigurationSave(const FConfigId& ConfigId) {
     if (Configurations.Contains(ConfigId)) {
-        PendingSaveConfigurations.AddUnique(ConfigId);
-        //Make sure cached structs are synchronized with real configuration state
-        ReinitializeCachedStructs(ConfigId);
+        PendingSaveConfigurations.Add(ConfigId);
         // TODO: Replace me with something better
         FEngineUtil::DispatchWhenTimerManagerIsReady(TBaseDelegate<void, FTimerManager*>::CreateUObject(this, &UConfigManager::OnConfigMarkedDirty));
     }
 }
 
-void UConfigManager::ReinitializeCachedStructs(const FConfigId& ConfigId) {
-#if OPTIMIZE_FILL_CONFIGURATION_STRUCT
-    const FRegisteredConfigurationData& ConfigurationData = Configurations.FindChecked(ConfigId);
-    URootConfigValueHolder* RootConfigValue = ConfigurationData.RootValue;
-    
-    for (const TPair<UScriptStruct*, FReflectedObject>& Pair : ConfigurationData.CachedValues) {
-        RootConfigValue->GetWrappedValue()->FillConfigStructSelf(Pair.Value);
-    }
-#endif
-}
-
 void UConfigManager::FillConfigurationStruct(const FConfigId& ConfigId, const FDynamicStructInfo& StructInfo) {
     FRegisteredConfigurationData* ConfigurationData = Configurations.Find(ConfigId);
     if (ConfigurationData == NULL) {
         return;
     }
 
+    URootConfigValueHolder* RootConfigValue = ConfigurationData->RootValue;
+
 #if OPTIMIZE_FILL_CONFIGURATION_STRUCT
-    //If this struct type is cached, just copy it from the cache directly
-    //Cached value should be up to date with configuration state as long as MarkConfigurationDirty is called properly
-    const FReflectedObject* ExistingObject = ConfigurationData->CachedValues.Find(StructInfo.Struct);
-    if (ExistingObject != NULL) {
-        ExistingObject->CopyWrappedStruct(StructInfo.Struct, StructInfo.StructValue);
-        return;
+    //Compile fill plan the first time this struct type is filled, and then just execute it
+    //Plan reads current property values directly, so it doesn't need to be refreshed when configuration changes
+    FConfigStructFillPlan* FillPlan = ConfigurationData->CachedFillPlans.Find(StructInfo.Struct);
+    if (FillPlan == NULL) {
+        FillPlan = &ConfigurationData->CachedFillPlans.Add(StructInfo.Struct, FConfigStructFillPlan::Compile(StructInfo.Struct, RootConfigValue->GetWrappedValue()));
     }
-#endif
-
-    //We don't have this type of script struct in the cache, reflect it and populate
-    URootConfigValueHolder* RootConfigValue = ConfigurationData->RootValue;
+    FillPlan->Execute(StructInfo.StructValue);
+#else
+    //Reflect struct and populate it through the configuration property chain
     const FReflectedObject StructReflection = UBlueprintReflectionLibrary::ReflectStruct(StructInfo);
     RootConfigValue->GetWrappedValue()->FillConfigStructSelf(StructReflection);
 
     //Copy populated reflected struct state back into original state
     StructReflection.CopyWrappedStruct(StructInfo.Struct, StructInfo.StructValue);
-
-#if OPTIMIZE_FILL_CONFIGURATION_STRUCT
-    //Store cached struct reflection in the cache
-    ConfigurationData->CachedValues.Add(StructInfo.Struct, StructReflection);
 #endif
 }
 
@@ -208,9 +383,10 @@ void UConfigManager::ReplaceConfigurationClass(FRegisteredConfigurationData* Exi
 
     //Populate new configuration with data from previous one
     RootConfigValueHolder->GetWrappedValue()->Deserialize(TempDataObject);
+    RootConfigValueHolder->GetWrappedValue()->InvalidateSerializationCache();
     
-    //Refresh all cached struct values with new data
-    ReinitializeCachedStructs(ExistingData->ConfigId);
+    //Fill plans reference properties of the previous configuration class, so they need to be compiled again
+    ExistingData->CachedFillPlans.Empty();
 
     //Force configuration save into filesystem with new schema
     SaveConfigurationInternal(ExistingData->ConfigId);
@@ -278,16 +454,44 @@ UConfigPropertySection* UConfigManager::GetConfigurationRootSection(const FConfi
 }
 
 void UConfigManager::Initialize(FSubsystemCollectionBase& Collection) {
+    //Read configuration files in the background while mods are being loaded, so registration only needs to apply them
+    Collection.InitializeDependency<UModLoadingLibrary>();
+    PrefetchConfigurationFiles();
     //Subscribe to exit event so we make sure that pending saves are written to filesystem
-    FCoreDelegates::OnPreExit.AddUObject(this, &UConfigManager::FlushPendingSaves);
+    FCoreDelegates::OnPreExit.AddUObject(this, &UConfigManager::FlushPendingSavesAndWait);
     //Subscribe to timer manager availability delegate to be able to do periodic auto-saves
     FEngineUtil::DispatchWhenTimerManagerIsReady(TBaseDelegate<void, FTimerManager*>::CreateUObject(this, &UConfigManager::OnTimerManagerAvailable));
 }
 
+void UConfigManager::Deinitialize() {
+    FCoreDelegates::OnPreExit.RemoveAll(this);
+    //Make sure prefetch worker does not outlive the subsystem
+    if (PrefetchedConfigurationsFuture.IsValid()) {
+        PrefetchedConfigurationsFuture.Wait();
+    }
+    //Nothing should be lost if we are destroyed before the engine exits
+    FlushPendingSavesAndWait();
+}
+
 FString UConfigManager::GetConfigurationFolderPath() {
     return FPaths::ProjectDir() + TEXT("Configs/");
 }
 
+FString UConfigManager::GetBinaryCacheFilePath(const FString& ConfigurationFilePath) {
+    //Mirror configuration folder layout inside of the cache folder
+    FString RelativeFilePath = ConfigurationFilePath;
+    FString ConfigurationFolderPath = GetConfigurationFolderPath();
+    FPaths::NormalizeFilename(RelativeFilePath);
+    FPaths::NormalizeFilename(ConfigurationFolderPath);
+    FPaths::RemoveDuplicateSlashes(RelativeFilePath);
+    FPaths::RemoveDuplicateSlashes(ConfigurationFolderPath);
+    
+    if (!FPaths::MakePathRelativeTo(RelativeFilePath, *ConfigurationFolderPath)) {
+        RelativeFilePath = FPaths::GetCleanFilename(RelativeFilePath);
+    }
+    return FPaths::ProjectSavedDir() + TEXT("ConfigCache/") + RelativeFilePath + TEXT(".bin");
+}
+
 FString UConfigManager::GetConfigurationFilePath(const FConfigId& ConfigId) {
     const FString ConfigDirectory = GetConfigurationFolderPath();
     if (ConfigId.ConfigCategory == TEXT("")) {
@@ -297,3 +501,21 @@ FString UConfigManager::GetConfigurationFilePath(const FConfigId& ConfigId) {
     //We have a category, so mod reference is a folder and category is a file name
     return ConfigDirectory + FString::Printf(TEXT("%s/%s.cfg"), *ConfigId.ModReference, *ConfigId.ConfigCategory);
 }
+
+#if WITH_DEV_AUTOMATION_TESTS
+void UConfigManager::RegisterRootSectionForTesting(const FConfigId& ConfigId, UConfigPropertySection* RootSection) {
+    URootConfigValueHolder* RootValueHolder = NewObject<URootConfigValueHolder>(this);
+    RootValueHolder->SetupRootValue(this, ConfigId);
+    RootValueHolder->RootWrappedValue = RootSection;
+
+    FRegisteredConfigurationData ConfigurationData;
+    ConfigurationData.ConfigId = ConfigId;
+    ConfigurationData.RootValue = RootValueHolder;
+    Configurations.Add(ConfigId, ConfigurationData);
+}
+
+void UConfigManager::UnregisterConfigurationForTesting(const FConfigId& ConfigId) {
+    PendingSaveConfigurations.Remove(ConfigId);
+    Configurations.Remove(ConfigId);
+}
+#endif
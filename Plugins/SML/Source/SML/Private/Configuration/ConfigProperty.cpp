@@ -17,6 +17,8 @@ void UConfigProperty::Deserialize_Implementation(const URawFormatValue* Value) {
 }
 
 void UConfigProperty::MarkDirty() {
+    InvalidateSerializationCache();
+    
     //Let closest Outer object implementing IConfigValueDirtyHandlerInterface handle MarkDirty call
     for (UObject* NextOuter = GetOuter(); NextOuter != NULL; NextOuter = NextOuter->GetOuter()) {
         if (NextOuter->Implements<UConfigValueDirtyHandlerInterface>()) {
@@ -26,6 +28,26 @@ void UConfigProperty::MarkDirty() {
     }
 }
 
+void UConfigProperty::InvalidateSerializationCache(bool bIncludeNestedProperties) {
+    CachedJsonValue.Reset();
+    
+    //Nested properties are always outered to the property containing them
+    if (bIncludeNestedProperties) {
+        ForEachObjectWithOuter(this, [](UObject* NestedObject) {
+            if (UConfigProperty* NestedProperty = Cast<UConfigProperty>(NestedObject)) {
+                NestedProperty->CachedJsonValue.Reset();
+            }
+        }, true);
+    }
+    
+    //Containing properties need to be serialized again too, but their other nested properties can still be reused
+    for (UObject* NextOuter = GetOuter(); NextOuter != NULL; NextOuter = NextOuter->GetOuter()) {
+        if (UConfigProperty* OuterProperty = Cast<UConfigProperty>(NextOuter)) {
+            OuterProperty->CachedJsonValue.Reset();
+        }
+    }
+}
+
 void UConfigProperty::FillConfigStruct_Implementation(const FReflectedObject& ReflectedObject,
     const FString& VariableName) const {
     checkf(false, TEXT("FillConfigStruct not implemented"));
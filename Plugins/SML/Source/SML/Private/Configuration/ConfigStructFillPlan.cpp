@@ -0,0 +1,216 @@
+#include "Configuration/ConfigStructFillPlan.h"
+#include "Configuration/Properties/ConfigPropertyArray.h"
+#include "Configuration/Properties/ConfigPropertyBool.h"
+#include "Configuration/Properties/ConfigPropertyClass.h"
+#include "Configuration/Properties/ConfigPropertyFloat.h"
+#include "Configuration/Properties/ConfigPropertyInteger.h"
+#include "Configuration/Properties/ConfigPropertySection.h"
+#include "Configuration/Properties/ConfigPropertyString.h"
+#include "Reflection/BlueprintReflectedObject.h"
+
+/** Same check as FReflectedObject setters perform before writing the field */
+static bool IsWriteableField(const FProperty* Property) {
+    return Property->HasAnyPropertyFlags(CPF_BlueprintVisible) && !Property->HasAnyPropertyFlags(CPF_BlueprintReadOnly);
+}
+
+/** Returns true if property class is handled by the plan directly. Subclasses can override FillConfigStruct, so only exact classes are */
+static bool IsPlannablePropertyClass(const UClass* PropertyClass) {
+    return PropertyClass == UConfigPropertyBool::StaticClass() ||
+        PropertyClass == UConfigPropertyInteger::StaticClass() ||
+        PropertyClass == UConfigPropertyFloat::StaticClass() ||
+        PropertyClass == UConfigPropertyString::StaticClass() ||
+        PropertyClass == UConfigPropertyClass::StaticClass() ||
+        PropertyClass == UConfigPropertySection::StaticClass() ||
+        PropertyClass == UConfigPropertyArray::StaticClass();
+}
+
+static void CompileSectionFields(TArray<FConfigFillStep>& Steps, const UConfigPropertySection* Section, UScriptStruct* Struct, int32 StructOffset, const TArray<FString>& SourcePath, bool bIsElementScope);
+
+/** Adds steps writing value of the property into the field, with field being NULL if it doesn't exist or is not writeable */
+static void CompilePropertyValue(TArray<FConfigFillStep>& Steps, const UConfigProperty* SourceProperty, const TArray<FString>& SourcePath, bool bIsElementScope,
+                                 FProperty* Field, int32 FieldOffset, UScriptStruct* ContainerStruct, int32 ContainerOffset, const FString& VariableName) {
+    FConfigFillStep Step;
+    Step.DestinationProperty = Field;
+    Step.DestinationOffset = FieldOffset;
+    if (bIsElementScope) {
+        Step.SourcePath = SourcePath;
+    } else {
+        Step.SourceProperty = SourceProperty;
+    }
+
+    const UClass* PropertyClass = SourceProperty->GetClass();
+    if (!IsPlannablePropertyClass(PropertyClass)) {
+        //Let the property fill reflected containing struct itself, same as FillConfigStructSelf would
+        if (ContainerStruct != NULL) {
+            Step.StepType = EConfigFillStepType::Fallback;
+            Step.ContainerStruct = ContainerStruct;
+            Step.ContainerOffset = ContainerOffset;
+            Step.VariableName = VariableName;
+            Steps.Add(Step);
+        }
+        return;
+    }
+
+    if (PropertyClass == UConfigPropertySection::StaticClass()) {
+        //Nested structs are stored inline, so their fields are just written at the offset of the nested struct
+        if (FStructProperty* StructField = CastField<FStructProperty>(Field)) {
+            CompileSectionFields(Steps, CastChecked<UConfigPropertySection>(SourceProperty), StructField->Struct, FieldOffset, SourcePath, bIsElementScope);
+        }
+        return;
+    }
+
+    if (PropertyClass == UConfigPropertyArray::StaticClass()) {
+        FArrayProperty* ArrayField = CastField<FArrayProperty>(Field);
+        if (ArrayField == NULL) {
+            return;
+        }
+        const UConfigProperty* ElementTemplate = CastChecked<UConfigPropertyArray>(SourceProperty)->DefaultValue;
+
+        //Elements of custom types can only be filled through the reflection of the whole array
+        if (ElementTemplate != NULL && !IsPlannablePropertyClass(ElementTemplate->GetClass())) {
+            if (ContainerStruct != NULL) {
+                Step.StepType = EConfigFillStepType::Fallback;
+                Step.ContainerStruct = ContainerStruct;
+                Step.ContainerOffset = ContainerOffset;
+                Step.VariableName = VariableName;
+                Steps.Add(Step);
+            }
+            return;
+        }
+        Step.StepType = EConfigFillStepType::Array;
+        const int32 ArrayStepIndex = Steps.Add(Step);
+
+        //Element steps are compiled against the element template, and resolve their source from each element by path
+        if (ElementTemplate != NULL) {
+            CompilePropertyValue(Steps, ElementTemplate, TArray<FString>(), true, ArrayField->Inner, 0, NULL, 0, TEXT(""));
+        }
+        Steps[ArrayStepIndex].NumElementSteps = Steps.Num() - ArrayStepIndex - 1;
+        return;
+    }
+
+    //Leaf values are only written into the fields of the matching type, mirroring FReflectedObject setters
+    if (PropertyClass == UConfigPropertyBool::StaticClass() && CastField<FBoolProperty>(Field)) {
+        Step.StepType = EConfigFillStepType::Bool;
+    } else if (PropertyClass == UConfigPropertyInteger::StaticClass() && CastField<FIntProperty>(Field)) {
+        Step.StepType = EConfigFillStepType::Integer;
+    } else if (PropertyClass == UConfigPropertyFloat::StaticClass() && CastField<FFloatProperty>(Field)) {
+        Step.StepType = EConfigFillStepType::Float;
+    } else if (PropertyClass == UConfigPropertyString::StaticClass() && CastField<FStrProperty>(Field)) {
+        Step.StepType = EConfigFillStepType::String;
+    } else if (PropertyClass == UConfigPropertyClass::StaticClass() && CastField<FObjectProperty>(Field)) {
+        Step.StepType = EConfigFillStepType::Class;
+    } else {
+        return;
+    }
+    Steps.Add(Step);
+}
+
+static void CompileSectionFields(TArray<FConfigFillStep>& Steps, const UConfigPropertySection* Section, UScriptStruct* Struct, int32 StructOffset, const TArray<FString>& SourcePath, bool bIsElementScope) {
+    for (const TPair<FString, UConfigProperty*>& Pair : Section->SectionProperties) {
+        if (Pair.Value == NULL) {
+            continue;
+        }
+        FProperty* Field = Struct->FindPropertyByName(*Pair.Key);
+        if (Field != NULL && !IsWriteableField(Field)) {
+            Field = NULL;
+        }
+        const int32 FieldOffset = Field ? StructOffset + Field->GetOffset_ForInternal() : 0;
+
+        TArray<FString> FieldSourcePath;
+        if (bIsElementScope) {
+            FieldSourcePath = SourcePath;
+            FieldSourcePath.Add(Pair.Key);
+        }
+        CompilePropertyValue(Steps, Pair.Value, FieldSourcePath, bIsElementScope, Field, FieldOffset, Struct, StructOffset, Pair.Key);
+    }
+}
+
+FConfigStructFillPlan FConfigStructFillPlan::Compile(UScriptStruct* Struct, const UConfigPropertySection* RootSection) {
+    FConfigStructFillPlan FillPlan;
+    CompileSectionFields(FillPlan.Steps, RootSection, Struct, 0, TArray<FString>(), false);
+    return FillPlan;
+}
+
+/** Resolves source property of the step executed for array element */
+static const UConfigProperty* ResolveElementSource(const UConfigProperty* ElementRoot, const TArray<FString>& SourcePath) {
+    const UConfigProperty* CurrentProperty = ElementRoot;
+    for (const FString& SectionKey : SourcePath) {
+        const UConfigPropertySection* Section = Cast<UConfigPropertySection>(CurrentProperty);
+        if (Section == NULL) {
+            return NULL;
+        }
+        CurrentProperty = Section->SectionProperties.FindRef(SectionKey);
+    }
+    return CurrentProperty;
+}
+
+static void ExecuteSteps(const FConfigFillStep* Steps, int32 NumSteps, uint8* ContainerData, const UConfigProperty* ElementRoot) {
+    for (int32 i = 0; i < NumSteps; i++) {
+        const FConfigFillStep& Step = Steps[i];
+        const UConfigProperty* SourceProperty = ElementRoot ? ResolveElementSource(ElementRoot, Step.SourcePath) : Step.SourceProperty;
+        void* DestinationValue = ContainerData + Step.DestinationOffset;
+
+        switch (Step.StepType) {
+            case EConfigFillStepType::Bool:
+                if (const UConfigPropertyBool* BoolProperty = Cast<UConfigPropertyBool>(SourceProperty)) {
+                    static_cast<FBoolProperty*>(Step.DestinationProperty)->SetPropertyValue(DestinationValue, BoolProperty->Value);
+                }
+                break;
+            case EConfigFillStepType::Integer:
+                if (const UConfigPropertyInteger* IntegerProperty = Cast<UConfigPropertyInteger>(SourceProperty)) {
+                    *static_cast<int32*>(DestinationValue) = IntegerProperty->Value;
+                }
+                break;
+            case EConfigFillStepType::Float:
+                if (const UConfigPropertyFloat* FloatProperty = Cast<UConfigPropertyFloat>(SourceProperty)) {
+                    *static_cast<float*>(DestinationValue) = FloatProperty->Value;
+                }
+                break;
+            case EConfigFillStepType::String:
+                if (const UConfigPropertyString* StringProperty = Cast<UConfigPropertyString>(SourceProperty)) {
+                    *static_cast<FString*>(DestinationValue) = StringProperty->Value;
+                }
+                break;
+            case EConfigFillStepType::Class:
+                if (const UConfigPropertyClass* ClassProperty = Cast<UConfigPropertyClass>(SourceProperty)) {
+                    static_cast<FObjectProperty*>(Step.DestinationProperty)->SetObjectPropertyValue(DestinationValue, ClassProperty->Value);
+                }
+                break;
+            case EConfigFillStepType::Array: {
+                    const FConfigFillStep* ElementSteps = Steps + i + 1;
+                    //Element steps are executed below for each element, so skip them in this loop
+                    i += Step.NumElementSteps;
+
+                    const UConfigPropertyArray* ArrayProperty = Cast<UConfigPropertyArray>(SourceProperty);
+                    if (ArrayProperty == NULL) {
+                        break;
+                    }
+                    FScriptArrayHelper ArrayHelper(static_cast<FArrayProperty*>(Step.DestinationProperty), DestinationValue);
+                    ArrayHelper.EmptyAndAddValues(ArrayProperty->Values.Num());
+
+                    for (int32 ElementIndex = 0; ElementIndex < ArrayProperty->Values.Num(); ElementIndex++) {
+                        const UConfigProperty* ElementProperty = ArrayProperty->Values[ElementIndex];
+                        if (ElementProperty != NULL) {
+                            ExecuteSteps(ElementSteps, Step.NumElementSteps, ArrayHelper.GetRawPtr(ElementIndex), ElementProperty);
+                        }
+                    }
+                    break;
+                }
+            case EConfigFillStepType::Fallback:
+                if (SourceProperty != NULL) {
+                    uint8* ContainerValue = ContainerData + Step.ContainerOffset;
+                    FReflectedObject ReflectedContainer{};
+                    ReflectedContainer.SetupFromStruct(Step.ContainerStruct, ContainerValue);
+                    SourceProperty->FillConfigStruct(ReflectedContainer, Step.VariableName);
+                    ReflectedContainer.CopyWrappedStruct(Step.ContainerStruct, ContainerValue);
+                }
+                break;
+            default:
+                checkf(false, TEXT("Unreachable code"));
+        }
+    }
+}
+
+void FConfigStructFillPlan::Execute(void* StructValue) const {
+    ExecuteSteps(Steps.GetData(), Steps.Num(), static_cast<uint8*>(StructValue), NULL);
+}
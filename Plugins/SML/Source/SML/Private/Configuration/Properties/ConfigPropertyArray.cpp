@@ -9,17 +9,21 @@ UConfigProperty* UConfigPropertyArray::AddNewElement() {
     checkf(DefaultValue, TEXT("Cannot add new element without default value defined"));
     UConfigProperty* NewValueProperty = NewObject<UConfigProperty>(this, DefaultValue->GetClass(), NAME_None, RF_NoFlags, DefaultValue);
     Values.Add(NewValueProperty);
+    //Only the list of elements has changed, elements themselves are still the same
+    InvalidateSerializationCache(false);
     return NewValueProperty;
 }
 
 void UConfigPropertyArray::RemoveElementAtIndex(int32 Index) {
     if (Index >= 0 && Index < Values.Num()) {
         Values.RemoveAt(Index);
+        InvalidateSerializationCache(false);
     }
 }
 
 void UConfigPropertyArray::Clear() {
     Values.Empty();
+    InvalidateSerializationCache(false);
 }
 
 #if WITH_EDITOR
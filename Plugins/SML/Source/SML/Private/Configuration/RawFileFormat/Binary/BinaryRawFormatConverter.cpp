@@ -0,0 +1,235 @@
+#include "Configuration/RawFileFormat/Binary/BinaryRawFormatConverter.h"
+#include "Configuration/RawFileFormat/RawFormatValueObject.h"
+#include "Configuration/RawFileFormat/RawFormatValueArray.h"
+#include "Configuration/RawFileFormat/RawFormatValueNumber.h"
+#include "Configuration/RawFileFormat/RawFormatValueString.h"
+#include "Configuration/RawFileFormat/RawFormatValueBool.h"
+
+//Magic number identifying binary configuration cache files, 'SMLC'
+static constexpr uint32 BinaryConfigCacheMagic = 0x534D4C43;
+//Bumped every time binary layout changes, cache files with other versions are ignored
+static constexpr uint16 BinaryConfigCacheFormatVersion = 1;
+//Limit on the value nesting, so malformed data cannot exhaust the stack
+static constexpr int32 MaxBinaryValueDepth = 128;
+
+enum class EBinaryRawValueType : uint8 {
+    Number = 0,
+    String = 1,
+    Bool = 2,
+    Array = 3,
+    Object = 4
+};
+
+/** Appends primitive values to the binary buffer */
+class FBinaryConfigCacheWriter {
+public:
+    explicit FBinaryConfigCacheWriter(TArray<uint8>& OutData) : Data(OutData) {}
+
+    template<typename T>
+    void Write(const T& Value) {
+        const int32 Offset = Data.AddUninitialized(sizeof(T));
+        FMemory::Memcpy(Data.GetData() + Offset, &Value, sizeof(T));
+    }
+
+    /** Writes string length followed by the characters, padded so characters are aligned to TCHAR size */
+    void WriteString(const FString& String) {
+        const int32 Length = String.Len();
+        Write<int32>(Length);
+        const int32 Padding = Align(Data.Num(), alignof(TCHAR)) - Data.Num();
+        Data.AddZeroed(Padding);
+        const int32 Offset = Data.AddUninitialized(Length * sizeof(TCHAR));
+        FMemory::Memcpy(Data.GetData() + Offset, *String, Length * sizeof(TCHAR));
+    }
+private:
+    TArray<uint8>& Data;
+};
+
+/** Reads primitive values from the binary buffer, failing on any out of bounds access instead of reading past the end */
+class FBinaryConfigCacheReader {
+public:
+    explicit FBinaryConfigCacheReader(TArrayView<const uint8> InData) : Data(InData) {}
+
+    template<typename T>
+    bool Read(T& OutValue) {
+        if (Offset + (int64) sizeof(T) > Data.Num()) {
+            return false;
+        }
+        FMemory::Memcpy(&OutValue, Data.GetData() + Offset, sizeof(T));
+        Offset += sizeof(T);
+        return true;
+    }
+
+    /** Reads string from the buffer, copying its characters straight into the output string */
+    bool ReadString(FString& OutString) {
+        int32 Length;
+        if (!Read(Length) || Length < 0) {
+            return false;
+        }
+        Offset = Align(Offset, alignof(TCHAR));
+        if (Offset + (int64) Length * sizeof(TCHAR) > Data.Num()) {
+            return false;
+        }
+        const TCHAR* Characters = reinterpret_cast<const TCHAR*>(Data.GetData() + Offset);
+        OutString = FString(Length, Characters);
+        Offset += Length * sizeof(TCHAR);
+        return true;
+    }
+
+    FORCEINLINE bool IsAtEnd() const { return Offset == Data.Num(); }
+private:
+    TArrayView<const uint8> Data;
+    int64 Offset = 0;
+};
+
+static void WriteRawValue(FBinaryConfigCacheWriter& Writer, const URawFormatValue* RawFormatValue) {
+    if (const URawFormatValueNumber* Number = Cast<URawFormatValueNumber>(RawFormatValue)) {
+        Writer.Write(EBinaryRawValueType::Number);
+        Writer.Write<double>(Number->Value);
+        return;
+    }
+    if (const URawFormatValueString* String = Cast<URawFormatValueString>(RawFormatValue)) {
+        Writer.Write(EBinaryRawValueType::String);
+        Writer.WriteString(String->Value);
+        return;
+    }
+    if (const URawFormatValueBool* Boolean = Cast<URawFormatValueBool>(RawFormatValue)) {
+        Writer.Write(EBinaryRawValueType::Bool);
+        Writer.Write<uint8>(Boolean->Value ? 1 : 0);
+        return;
+    }
+    if (const URawFormatValueArray* Array = Cast<URawFormatValueArray>(RawFormatValue)) {
+        Writer.Write(EBinaryRawValueType::Array);
+        Writer.Write<int32>(Array->Num());
+        for (const URawFormatValue* ChildValue : Array->GetUnderlyingArrayRef()) {
+            WriteRawValue(Writer, ChildValue);
+        }
+        return;
+    }
+    if (const URawFormatValueObject* Object = Cast<URawFormatValueObject>(RawFormatValue)) {
+        Writer.Write(EBinaryRawValueType::Object);
+        Writer.Write<int32>(Object->Values.Num());
+        for (const TPair<FString, URawFormatValue*>& Pair : Object->Values) {
+            Writer.WriteString(Pair.Key);
+            WriteRawValue(Writer, Pair.Value);
+        }
+        return;
+    }
+    checkf(false, TEXT("Unreachable code"));
+}
+
+static URawFormatValue* ReadRawValue(FBinaryConfigCacheReader& Reader, UObject* Outer, int32 Depth) {
+    EBinaryRawValueType ValueType;
+    if (Depth > MaxBinaryValueDepth || !Reader.Read(ValueType)) {
+        return NULL;
+    }
+    switch (ValueType) {
+        case EBinaryRawValueType::Number: {
+                double Value;
+                if (!Reader.Read(Value)) {
+                    return NULL;
+                }
+                URawFormatValueNumber* Number = NewObject<URawFormatValueNumber>(Outer);
+                Number->Value = Value;
+                return Number;
+            }
+        case EBinaryRawValueType::String: {
+                URawFormatValueString* String = NewObject<URawFormatValueString>(Outer);
+                return Reader.ReadString(String->Value) ? String : NULL;
+            }
+        case EBinaryRawValueType::Bool: {
+                uint8 Value;
+                if (!Reader.Read(Value) || Value > 1) {
+                    return NULL;
+                }
+                URawFormatValueBool* Boolean = NewObject<URawFormatValueBool>(Outer);
+                Boolean->Value = Value != 0;
+                return Boolean;
+            }
+        case EBinaryRawValueType::Array: {
+                int32 NumValues;
+                if (!Reader.Read(NumValues) || NumValues < 0) {
+                    return NULL;
+                }
+                URawFormatValueArray* Array = NewObject<URawFormatValueArray>(Outer);
+                for (int32 i = 0; i < NumValues; i++) {
+                    URawFormatValue* ChildValue = ReadRawValue(Reader, Array, Depth + 1);
+                    if (ChildValue == NULL) {
+                        return NULL;
+                    }
+                    Array->AddValue(ChildValue);
+                }
+                return Array;
+            }
+        case EBinaryRawValueType::Object: {
+                int32 NumValues;
+                if (!Reader.Read(NumValues) || NumValues < 0) {
+                    return NULL;
+                }
+                URawFormatValueObject* Object = NewObject<URawFormatValueObject>(Outer);
+                for (int32 i = 0; i < NumValues; i++) {
+                    FString Key;
+                    if (!Reader.ReadString(Key)) {
+                        return NULL;
+                    }
+                    URawFormatValue* ChildValue = ReadRawValue(Reader, Object, Depth + 1);
+                    if (ChildValue == NULL) {
+                        return NULL;
+                    }
+                    //Child value is always created inside of the object, so the key can be moved into the map instead of copying it again
+                    Object->Values.Add(MoveTemp(Key), ChildValue);
+                }
+                return Object;
+            }
+        default:
+            return NULL;
+    }
+}
+
+static bool ReadHeaderInternal(FBinaryConfigCacheReader& Reader, FBinaryConfigCacheHeader& OutHeader) {
+    uint32 Magic;
+    uint16 FormatVersion;
+    uint8 CharacterSize;
+    int64 TimestampTicks;
+    if (!Reader.Read(Magic) || Magic != BinaryConfigCacheMagic ||
+        !Reader.Read(FormatVersion) || FormatVersion != BinaryConfigCacheFormatVersion ||
+        !Reader.Read(CharacterSize) || CharacterSize != sizeof(TCHAR)) {
+        return false;
+    }
+    if (!Reader.Read(OutHeader.SourceFileSize) || !Reader.Read(TimestampTicks) ||
+        !Reader.Read(OutHeader.SourceFileHash) || !Reader.ReadString(OutHeader.ModVersion)) {
+        return false;
+    }
+    OutHeader.SourceFileTimestamp = FDateTime(TimestampTicks);
+    return true;
+}
+
+void FBinaryRawFormatConverter::ConvertToBinary(const URawFormatValue* RawFormatValue, const FBinaryConfigCacheHeader& Header, TArray<uint8>& OutData) {
+    FBinaryConfigCacheWriter Writer(OutData);
+    Writer.Write<uint32>(BinaryConfigCacheMagic);
+    Writer.Write<uint16>(BinaryConfigCacheFormatVersion);
+    Writer.Write<uint8>(sizeof(TCHAR));
+    Writer.Write<int64>(Header.SourceFileSize);
+    Writer.Write<int64>(Header.SourceFileTimestamp.GetTicks());
+    Writer.Write<uint64>(Header.SourceFileHash);
+    Writer.WriteString(Header.ModVersion);
+    WriteRawValue(Writer, RawFormatValue);
+}
+
+bool FBinaryRawFormatConverter::ReadHeader(TArrayView<const uint8> Data, FBinaryConfigCacheHeader& OutHeader) {
+    FBinaryConfigCacheReader Reader(Data);
+    return ReadHeaderInternal(Reader, OutHeader);
+}
+
+URawFormatValue* FBinaryRawFormatConverter::ConvertToRawFormat(UObject* Outer, TArrayView<const uint8> Data) {
+    FBinaryConfigCacheReader Reader(Data);
+    FBinaryConfigCacheHeader Header;
+    if (!ReadHeaderInternal(Reader, Header)) {
+        return NULL;
+    }
+    URawFormatValue* RawFormatValue = ReadRawValue(Reader, Outer, 0);
+    //Trailing data means the file has been damaged or written by something else
+    if (RawFormatValue == NULL || !Reader.IsAtEnd()) {
+        return NULL;
+    }
+    return RawFormatValue;
+}
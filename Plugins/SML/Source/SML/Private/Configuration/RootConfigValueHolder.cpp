@@ -2,7 +2,8 @@
 
 void URootConfigValueHolder::MarkDirty_Implementation() {
     if (ConfigManager != NULL) {
-        ConfigManager->MarkConfigurationDirty(ConfigId);
+        //Property marking itself dirty has already invalidated its cached JSON, so the rest of the configuration can be reused
+        ConfigManager->QueueConfigurationSave(ConfigId);
     }
 }
 
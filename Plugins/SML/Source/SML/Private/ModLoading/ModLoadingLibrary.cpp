@@ -3,6 +3,7 @@
 #include "SatisfactoryModLoader.h"
 #include "Interfaces/IPluginManager.h"
 #include "Util/ImageLoadingUtil.h"
+#include "Util/PluginOwnershipIndex.h"
 #include "Json.h"
 
 //We only want to enforce plugin dependency versions outside of the editor
@@ -122,6 +123,8 @@ void UModLoadingLibrary::Initialize(FSubsystemCollectionBase& Collection) {
 	//Add some callbacks to handle plugins being mounted later in the lifecycle gracefully
     IPluginManager::Get().OnNewPluginCreated().AddUObject(this, &UModLoadingLibrary::OnNewPluginCreated);
     IPluginManager::Get().OnNewPluginMounted().AddUObject(this, &UModLoadingLibrary::OnNewPluginCreated);
+    //Ownership index could have been built before we started tracking plugins, so make sure it includes all of them
+    FPluginOwnershipIndex::Get().Invalidate();
 
     //Initialize metadata and check dependencies for plugins that have already been loaded
     ReloadPluginMetadata();
@@ -250,6 +253,9 @@ void UModLoadingLibrary::PopulatePluginModInfo(IPlugin& Plugin, FModInfo& OutMod
 }
 
 void UModLoadingLibrary::OnNewPluginCreated(IPlugin& Plugin) {
+    //Plugin being created or mounted can change the set of enabled plugins, so ownership index has to be rebuilt
+    FPluginOwnershipIndex::Get().Invalidate();
+    
     if (Plugin.IsEnabled() && IsPluginAMod(Plugin)) {
         //Only perform metadata loading and dependencies verification if plugin hasn't been checked before
         if (!PluginMetadata.Contains(Plugin.GetName())) {
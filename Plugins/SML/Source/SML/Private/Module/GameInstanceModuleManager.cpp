@@ -3,6 +3,8 @@
 #include "ModLoading/PluginModuleLoader.h"
 #include "Registry/RemoteCallObjectRegistry.h"
 #include "Tooltip/ItemTooltipSubsystem.h"
+#include "Configuration/ConfigManager.h"
+#include "Engine/Engine.h"
 
 UGameInstanceModuleManager::UGameInstanceModuleManager() {
     this->bIsInitializingCurrently = false;
@@ -49,6 +51,9 @@ void UGameInstanceModuleManager::Initialize(FSubsystemCollectionBase& Collection
     DispatchLifecycleEvent(ELifecyclePhase::CONSTRUCTION);
     DispatchLifecycleEvent(ELifecyclePhase::INITIALIZATION);
     DispatchLifecycleEvent(ELifecyclePhase::POST_INITIALIZATION);
+
+    //Mod configurations are registered during initialization, so configuration files nobody has taken won't be needed anymore
+    GEngine->GetEngineSubsystem<UConfigManager>()->DiscardPrefetchedConfigurationFiles();
     
     this->bIsInitializingCurrently = false;
     this->CurrentSubsystemCollection = NULL;
@@ -33,15 +33,8 @@ void UGameWorldModule::RegisterDefaultContent() {
     AChatCommandSubsystem* ChatCommandSubsystem = AChatCommandSubsystem::Get(WorldObject);
 	check(ModContentRegistry);
 
-    //Register schematics
-    for (const TSubclassOf<UFGSchematic>& Schematic : mSchematics) {
-        ModContentRegistry->RegisterSchematic(GetOwnerModReference(), Schematic);
-    }
-
-    //Register research trees
-    for (const TSubclassOf<UFGResearchTree>& ResearchTree : mResearchTrees) {
-        ModContentRegistry->RegisterResearchTree(GetOwnerModReference(), ResearchTree);
-    }
+    //Register schematics and research trees in one batch
+    ModContentRegistry->RegisterContentBatch(GetOwnerModReference(), mSchematics, mResearchTrees);
 
     //Register resource sink table points
     UDataTable* ModResourceSinkPointsTable = mResourceSinkItemPointsTable.LoadSynchronous();
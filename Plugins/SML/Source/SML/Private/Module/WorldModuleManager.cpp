@@ -2,6 +2,7 @@
 #include "FGGameMode.h"
 #include "FGGameState.h"
 #include "GameFramework/GameStateBase.h"
+#include "GameFramework/WorldSettings.h"
 #include "Engine/Engine.h"
 #include "Engine/World.h"
 #include "SatisfactoryModLoader.h"
@@ -23,6 +24,13 @@ void UWorldModuleManager::WaitForGameState(FLatentActionInfo& LatentInfo) {
 	
 }
 
+bool UWorldModuleManager::IsMainMenuWorldSettings(UWorld* World) {
+	AWorldSettings* WorldSettings = World->GetWorldSettings();
+	const TSubclassOf<AGameModeBase> GameModeClass = WorldSettings ? WorldSettings->DefaultGameMode : NULL;
+	const AFGGameMode* GameMode = Cast<AFGGameMode>(GameModeClass.GetDefaultObject());
+	return GameMode != NULL && GameMode->IsMainMenuGameMode();
+}
+
 bool UWorldModuleManager::ShouldCreateSubsystem(UObject* Outer) const {
 	UWorld* WorldOuter = CastChecked<UWorld>(Outer);
 	return FPluginModuleLoader::ShouldLoadModulesForWorld(WorldOuter);
@@ -34,6 +42,12 @@ void UWorldModuleManager::Initialize(FSubsystemCollectionBase& Collection) {
 	Collection.InitializeDependency(USubsystemActorManager::StaticClass());
 	
 	UWorld* OuterWorld = GetWorld();
+	
+	//Start streaming vanilla content in right away, so it loads together with the world instead of
+	//being waited for when modules are constructed. Game mode is not spawned yet, so check the one world settings specify
+	if (!IsMainMenuWorldSettings(OuterWorld)) {
+		VanillaContentStreamHandle = AModContentRegistry::StreamVanillaContentInAdvance();
+	}
 	OuterWorld->OnActorsInitialized.AddUObject(this, &UWorldModuleManager::InitializeModules);
 	OuterWorld->OnWorldBeginPlay.AddUObject(this, &UWorldModuleManager::PostInitializeModules);
 }
@@ -56,6 +70,16 @@ void UWorldModuleManager::PostInitializeModules() {
 	DispatchLifecycleEvent(ELifecyclePhase::POST_INITIALIZATION);
 }
 
+void UWorldModuleManager::WaitForVanillaContent() {
+	AModContentRegistry* ContentRegistry = AModContentRegistry::Get(this);
+
+	if (ContentRegistry != NULL) {
+		ContentRegistry->WaitForVanillaContentDiscovery();
+	}
+	//Registry holds its own handle to the streamed content from now on
+	VanillaContentStreamHandle.Reset();
+}
+
 void UWorldModuleManager::NotifyContentRegistry() {
 	AModContentRegistry* ContentRegistry = AModContentRegistry::Get(this);
 
@@ -97,6 +121,9 @@ void UWorldModuleManager::ConstructModules() {
     
     UE_LOG(LogSatisfactoryModLoader, Log, TEXT("Discovered %d world modules of class %s"), AlreadyLoadedMods.Num(), *ModuleTypeClass->GetName());
     
+    //Vanilla content has been streaming in since the world was created, and it has to be registered before any module can register its content
+    WaitForVanillaContent();
+
     //Dispatch construction lifecycle event
     DispatchLifecycleEvent(ELifecyclePhase::CONSTRUCTION);
 }
@@ -0,0 +1,11 @@
+#include "Network/ModConnectionStatistics.h"
+
+const FString UModConnectionStatistics::MetadataSubobjectName = TEXT("ModNetworkStatistics");
+
+FMessageTypeStats& UModConnectionStatistics::GetMessageTypeStats(int32 ChannelId) {
+    check(ChannelId >= 0);
+    if (ChannelId >= MessageTypeStats.Num()) {
+        MessageTypeStats.SetNum(ChannelId + 1);
+    }
+    return MessageTypeStats[ChannelId];
+}
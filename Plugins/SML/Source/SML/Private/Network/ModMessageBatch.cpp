@@ -0,0 +1,112 @@
+#include "Network/ModMessageBatch.h"
+#include "Misc/Compression.h"
+
+//Messages larger than this are split into multiple fragments, each of them sent as a separate batch entry
+static constexpr int32 MaxMessageFragmentSize = 16 * 1024;
+//Messages smaller than this are never compressed, since compression is unlikely to make them smaller
+static constexpr int32 MinCompressedMessageSize = 1024;
+
+void FModMessageBatchFormat::EncodeMessage(const uint8* Data, int32 DataSize, bool bAllowCompression, TArray<uint8>& CompressedDataBuffer,
+    TFunctionRef<void(uint8 EntryFlags, const uint8* EntryData, int32 EntryDataSize)> EntryWriter) {
+    //Compress large messages if that makes them smaller. Compressed data is prefixed by the uncompressed size
+    const uint8* SentData = Data;
+    int32 SentDataSize = DataSize;
+    uint8 MessageFlags = 0;
+
+    if (bAllowCompression && SentDataSize >= MinCompressedMessageSize) {
+        int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, SentDataSize);
+        CompressedDataBuffer.SetNumUninitialized(sizeof(int32) + CompressedSize, false);
+        FMemory::Memcpy(CompressedDataBuffer.GetData(), &SentDataSize, sizeof(int32));
+
+        if (FCompression::CompressMemory(NAME_Zlib, CompressedDataBuffer.GetData() + sizeof(int32), CompressedSize, SentData, SentDataSize) &&
+            (int32) sizeof(int32) + CompressedSize < SentDataSize) {
+            SentData = CompressedDataBuffer.GetData();
+            SentDataSize = sizeof(int32) + CompressedSize;
+            MessageFlags |= EMessageEntryFlags::Compressed;
+        }
+    }
+
+    //Messages that don't fit into a single fragment are split, and remote side puts them back together
+    if (SentDataSize <= MaxMessageFragmentSize) {
+        EntryWriter(MessageFlags, SentData, SentDataSize);
+        return;
+    }
+    for (int32 FragmentOffset = 0; FragmentOffset < SentDataSize; FragmentOffset += MaxMessageFragmentSize) {
+        const int32 FragmentSize = FMath::Min(MaxMessageFragmentSize, SentDataSize - FragmentOffset);
+        const bool bIsLastFragment = FragmentOffset + FragmentSize == SentDataSize;
+        const uint8 FragmentFlags = MessageFlags | EMessageEntryFlags::Fragment | (bIsLastFragment ? EMessageEntryFlags::LastFragment : 0);
+        EntryWriter(FragmentFlags, SentData + FragmentOffset, FragmentSize);
+    }
+}
+
+void FModMessageBatchFormat::WriteEntry(FArchive& Writer, const FMessageType& MessageType, int32 RemoteChannelId, uint8 EntryFlags, const uint8* Data, int32 DataSize) {
+    if (RemoteChannelId != INDEX_NONE) {
+        EntryFlags |= EMessageEntryFlags::ChannelId;
+        uint32 PackedChannelId = RemoteChannelId;
+        Writer << EntryFlags;
+        Writer.SerializeIntPacked(PackedChannelId);
+    } else {
+        FString ModReference = MessageType.ModReference;
+        int32 MessageId = MessageType.MessageId;
+        Writer << EntryFlags;
+        Writer << ModReference;
+        Writer << MessageId;
+    }
+    Writer << DataSize;
+    Writer.Serialize(const_cast<uint8*>(Data), DataSize);
+}
+
+//Reads string saved by FString serialization, checking its length against the remaining data first,
+//since FString serialization allocates the whole saved length before reading any characters
+static bool ReadEntryString(FArchive& Reader, FString& OutString) {
+    const int64 StringOffset = Reader.Tell();
+    int32 SavedLength = 0;
+    Reader << SavedLength;
+
+    //Negative length means the string has been saved as UCS2 instead of ANSI characters
+    const int64 NumChars = FMath::Abs((int64) SavedLength);
+    const int64 CharSize = SavedLength < 0 ? sizeof(UCS2CHAR) : sizeof(ANSICHAR);
+    if (Reader.IsError() || NumChars * CharSize > Reader.TotalSize() - Reader.Tell()) {
+        return false;
+    }
+    Reader.Seek(StringOffset);
+    Reader << OutString;
+    return !Reader.IsError();
+}
+
+bool FModMessageBatchFormat::ReadEntry(FArchive& Reader, FMessageBatchEntry& OutEntry) {
+    Reader << OutEntry.EntryFlags;
+
+    if (OutEntry.EntryFlags & EMessageEntryFlags::ChannelId) {
+        Reader.SerializeIntPacked(OutEntry.ChannelId);
+    } else {
+        if (!ReadEntryString(Reader, OutEntry.ModReference)) {
+            return false;
+        }
+        Reader << OutEntry.MessageId;
+    }
+    int32 DataSize = 0;
+    Reader << DataSize;
+
+    //Validate size before allocating anything, batch comes from the remote side and can be malformed
+    if (Reader.IsError() || DataSize < 0 || DataSize > Reader.TotalSize() - Reader.Tell()) {
+        return false;
+    }
+    OutEntry.Data.SetNumUninitialized(DataSize, false);
+    Reader.Serialize(OutEntry.Data.GetData(), DataSize);
+    return !Reader.IsError();
+}
+
+int32 FModMessageBatchFormat::GetUncompressedSize(const TArray<uint8>& Data) {
+    if (Data.Num() < (int32) sizeof(int32)) {
+        return INDEX_NONE;
+    }
+    int32 UncompressedSize = 0;
+    FMemory::Memcpy(&UncompressedSize, Data.GetData(), sizeof(int32));
+    return UncompressedSize;
+}
+
+bool FModMessageBatchFormat::DecompressMessage(const TArray<uint8>& Data, int32 UncompressedSize, TArray<uint8>& OutData) {
+    OutData.SetNumUninitialized(UncompressedSize);
+    return FCompression::UncompressMemory(NAME_Zlib, OutData.GetData(), UncompressedSize, Data.GetData() + sizeof(int32), Data.Num() - (int32) sizeof(int32));
+}
@@ -6,19 +6,112 @@
 #include "Engine/Engine.h"
 #include "Engine/NetConnection.h"
 #include "Util/ObjectMetadata.h"
+#include "Containers/Ticker.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "HAL/IConsoleManager.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Network/ModConnectionStatistics.h"
+#include "Network/ModMessageBatch.h"
+#include "SatisfactoryModLoader.h"
 
 DEFINE_LOG_CATEGORY(LogModNetworkHandler);
 DEFINE_CONTROL_CHANNEL_MESSAGE_THREEPARAM(ModMessage, 40, FString, int32, FString);
 IMPLEMENT_CONTROL_CHANNEL_MESSAGE(ModMessage);
+DEFINE_CONTROL_CHANNEL_MESSAGE_ONEPARAM(ModMessageBatch, 41, TArray<uint8>);
+IMPLEMENT_CONTROL_CHANNEL_MESSAGE(ModMessageBatch);
+
+static FAutoConsoleCommand DumpNetworkStatsCommand(
+    TEXT("SML.Network.DumpStats"),
+    TEXT("Logs mod message traffic of all open connections as JSON, broken down by mod and message type"),
+    FConsoleCommandDelegate::CreateLambda([]() {
+        if (GEngine != nullptr) {
+            GEngine->GetEngineSubsystem<UModNetworkHandler>()->LogNetworkStatistics();
+        }
+    }));
+
+//Batches growing past this size are sent right away instead of waiting for the next tick,
+//so they stay well below the limit on the size of the reliable bunch
+static constexpr int32 MaxMessageBatchSize = 32 * 1024;
+//Hard limit on the size of the received message, applied even to message types without quotas
+static constexpr int32 MaxReassembledMessageSize = 16 * 1024 * 1024;
+
+//Returns size of the string as it is serialized into the legacy mod message, e.g. length followed by either ANSI or UCS2 characters
+//including the terminator. String messages sent through the channels serialize as UTF-8 instead, so they record the encoded size
+static int32 GetSerializedStringSize(const FString& String) {
+    if (String.IsEmpty()) {
+        return sizeof(int32);
+    }
+    const int32 CharSize = FCString::IsPureAnsi(*String) ? sizeof(ANSICHAR) : sizeof(UCS2CHAR);
+    return sizeof(int32) + (String.Len() + 1) * CharSize;
+}
+
+void UModNetworkHandler::Initialize(FSubsystemCollectionBase& Collection) {
+    const FSMLConfiguration Configuration = FSatisfactoryModLoader::GetSMLConfiguration();
+    MaxReceivedMessagesPerSecond = FMath::Max(Configuration.MaxModMessagesPerSecond, 0);
+    MaxReceivedBytesPerSecond = FMath::Max(Configuration.MaxModMessageBytesPerSecond, 0);
+    StatisticsLogInterval = FMath::Max(Configuration.NetworkStatisticsLogInterval, 0.0f);
+    TimeSinceStatisticsLogged = 0.0f;
+    
+    TickerDelegateHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UModNetworkHandler::TickMessageBatches));
+}
+
+void UModNetworkHandler::Deinitialize() {
+    FTicker::GetCoreTicker().RemoveTicker(TickerDelegateHandle);
+    PendingMessageBatches.Empty();
+    PartialBinaryMessages.Empty();
+    NegotiatedChannels.Empty();
+}
 
 FMessageEntry& UModNetworkHandler::RegisterMessageType(const FMessageType& MessageType) {
     UE_LOG(LogModNetworkHandler, Display, TEXT("Registering message type %s:%d"), *MessageType.ModReference, MessageType.MessageId);
-    TMap<int32, FMessageEntry>& ModEntries = MessageHandlers.FindOrAdd(MessageType.ModReference);
-    if (ModEntries.Contains(MessageType.MessageId)) {
+    TMap<int32, int32>& ModChannelIds = MessageChannelIds.FindOrAdd(MessageType.ModReference);
+    if (ModChannelIds.Contains(MessageType.MessageId)) {
         UE_LOG(LogModNetworkHandler, Fatal, TEXT("Tried to register mod message with duplicate identifier %d for mod %s"), MessageType.MessageId, *MessageType.ModReference);
         check(0);
     }
-    return ModEntries.Add(MessageType.MessageId, FMessageEntry{});
+    //Message types are never unregistered, so the index in the array can be used as a channel ID
+    const int32 ChannelId = MessageTypes.Add(new FRegisteredMessageType{MessageType, FMessageEntry{}});
+    ModChannelIds.Add(MessageType.MessageId, ChannelId);
+    return MessageTypes[ChannelId].Entry;
+}
+
+TArray<FString> UModNetworkHandler::GetLocalMessageChannels() const {
+    TArray<FString> MessageChannels;
+    MessageChannels.Reserve(MessageTypes.Num());
+    for (int32 ChannelId = 0; ChannelId < MessageTypes.Num(); ChannelId++) {
+        MessageChannels.Add(DescribeMessageChannel(ChannelId));
+    }
+    return MessageChannels;
+}
+
+void UModNetworkHandler::SetRemoteMessageChannels(UNetConnection* Connection, const TArray<FString>& RemoteMessageChannels) {
+    FNegotiatedMessageChannels& Channels = NegotiatedChannels.FindOrAdd(Connection);
+    Channels.RemoteChannelIds.Init(INDEX_NONE, MessageTypes.Num());
+
+    for (int32 RemoteChannelId = 0; RemoteChannelId < RemoteMessageChannels.Num(); RemoteChannelId++) {
+        FString ModReference;
+        FString MessageIdString;
+        if (!RemoteMessageChannels[RemoteChannelId].Split(TEXT(":"), &ModReference, &MessageIdString, ESearchCase::CaseSensitive, ESearchDir::FromEnd)) {
+            continue;
+        }
+        //Message types remote side knows about but we don't are just never sent
+        const int32 LocalChannelId = FindMessageChannelId(ModReference, FCString::Atoi(*MessageIdString));
+        if (LocalChannelId != INDEX_NONE) {
+            Channels.RemoteChannelIds[LocalChannelId] = RemoteChannelId;
+        }
+    }
+}
+
+FString UModNetworkHandler::DescribeMessageChannel(int32 ChannelId) const {
+    if (!MessageTypes.IsValidIndex(ChannelId)) {
+        return FString::Printf(TEXT("<unknown channel %d>"), ChannelId);
+    }
+    const FMessageType& MessageType = MessageTypes[ChannelId].MessageType;
+    return FString::Printf(TEXT("%s:%d"), *MessageType.ModReference, MessageType.MessageId);
 }
 
 void UModNetworkHandler::CloseWithFailureMessage(UNetConnection* Connection, const FString& Message) {
@@ -28,22 +121,425 @@ void UModNetworkHandler::CloseWithFailureMessage(UNetConnection* Connection, con
 }
 
 void UModNetworkHandler::SendMessage(UNetConnection* Connection, FMessageType MessageType, FString Data) {
+    //Send queued binary messages first, so messages arrive in the order they have been sent
+    UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
+    FPendingMessageBatch* MessageBatch = NetworkHandler->PendingMessageBatches.Find(Connection);
+    if (MessageBatch != nullptr) {
+        NetworkHandler->FlushMessageBatch(Connection, *MessageBatch);
+    }
+    if (NetworkHandler->SendStringMessageByChannelId(Connection, MessageType, Data)) {
+        return;
+    }
+    const int32 ChannelId = NetworkHandler->FindMessageChannelId(MessageType.ModReference, MessageType.MessageId);
+    NetworkHandler->RecordSentMessage(Connection, ChannelId, GetSerializedStringSize(Data));
     FNetControlMessage<NMT_ModMessage>::Send(Connection, MessageType.ModReference, MessageType.MessageId, Data);
     Connection->FlushNet(true);
 }
 
-void UModNetworkHandler::ReceiveMessage(UNetConnection* Connection, const FString& ModId, int32 MessageId, const FString& Content) const {
-    const TMap<int32, FMessageEntry>* Result = MessageHandlers.Find(ModId);
-    if (Result != nullptr) {
-        const FMessageEntry* MessageEntry = Result->Find(MessageId);
-        if (MessageEntry != nullptr) {
-            const bool bIsClientSide = Connection->ClientLoginState == EClientLoginState::Invalid;
-            const bool bCanBeHandled = (bIsClientSide && MessageEntry->bClientHandled) || (!bIsClientSide && MessageEntry->bServerHandled);
-            if (bCanBeHandled) {
-                MessageEntry->MessageReceived.ExecuteIfBound(Connection, Content);
+bool UModNetworkHandler::SendStringMessageByChannelId(UNetConnection* Connection, const FMessageType& MessageType, const FString& Data) {
+    const int32 LocalChannelId = FindMessageChannelId(MessageType.ModReference, MessageType.MessageId);
+    const FNegotiatedMessageChannels* Channels = NegotiatedChannels.Find(Connection);
+    if (Channels == nullptr || LocalChannelId == INDEX_NONE || !Channels->RemoteChannelIds.IsValidIndex(LocalChannelId) ||
+        Channels->RemoteChannelIds[LocalChannelId] == INDEX_NONE) {
+        return false;
+    }
+    const int32 RemoteChannelId = Channels->RemoteChannelIds[LocalChannelId];
+    const FTCHARToUTF8 EncodedData(*Data, Data.Len());
+    RecordSentMessage(Connection, LocalChannelId, EncodedData.Length());
+    
+    const bool bAllowCompression = MessageTypes[LocalChannelId].Entry.bAllowCompression;
+    FModMessageBatchFormat::EncodeMessage(reinterpret_cast<const uint8*>(EncodedData.Get()), EncodedData.Length(), bAllowCompression, CompressedDataBuffer,
+        [&](uint8 EntryFlags, const uint8* EntryData, int32 EntryDataSize) {
+            AppendMessageBatchEntry(Connection, MessageType, RemoteChannelId, EntryFlags | EMessageEntryFlags::StringMessage, EntryData, EntryDataSize);
+        });
+    
+    //String messages are sent immediately, same as the ones sent by name
+    FlushMessageBatch(Connection, PendingMessageBatches.FindChecked(Connection));
+    return true;
+}
+
+void UModNetworkHandler::SendBinaryMessage(UNetConnection* Connection, const FMessageType& MessageType, const TArray<uint8>& Data) {
+    SendBinaryMessage(Connection, MessageType, [&Data](FArchive& Ar) {
+        Ar.Serialize(const_cast<uint8*>(Data.GetData()), Data.Num());
+    });
+}
+
+void UModNetworkHandler::SendBinaryMessage(UNetConnection* Connection, const FMessageType& MessageType, TFunctionRef<void(FArchive&)> DataWriter) {
+    UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
+    NetworkHandler->EnqueueBinaryMessage(Connection, MessageType, DataWriter);
+}
+
+void UModNetworkHandler::EnqueueBinaryMessage(UNetConnection* Connection, const FMessageType& MessageType, TFunctionRef<void(FArchive&)> DataWriter) {
+    MessageDataBuffer.Reset();
+    FMemoryWriter Writer(MessageDataBuffer);
+    DataWriter(Writer);
+
+    const int32 LocalChannelId = FindMessageChannelId(MessageType.ModReference, MessageType.MessageId);
+    FMessageEntry* MessageEntry = LocalChannelId != INDEX_NONE ? &MessageTypes[LocalChannelId].Entry : nullptr;
+    if (MessageEntry != nullptr) {
+        if (MessageEntry->MaxMessageSize > 0 && MessageDataBuffer.Num() > MessageEntry->MaxMessageSize) {
+            UE_LOG(LogModNetworkHandler, Warning, TEXT("Dropping message %s:%d of %d bytes, exceeding the quota of %d bytes"),
+                *MessageType.ModReference, MessageType.MessageId, MessageDataBuffer.Num(), MessageEntry->MaxMessageSize);
+            RecordDroppedMessage(Connection, LocalChannelId);
+            return;
+        }
+    }
+    RecordSentMessage(Connection, LocalChannelId, MessageDataBuffer.Num());
+
+    //Address message by the channel ID if remote side has told us which one it uses for this message type
+    int32 RemoteChannelId = INDEX_NONE;
+    const FNegotiatedMessageChannels* Channels = NegotiatedChannels.Find(Connection);
+    if (Channels != nullptr && LocalChannelId != INDEX_NONE && Channels->RemoteChannelIds.IsValidIndex(LocalChannelId)) {
+        RemoteChannelId = Channels->RemoteChannelIds[LocalChannelId];
+    }
+
+    const bool bAllowCompression = MessageEntry == nullptr || MessageEntry->bAllowCompression;
+    FModMessageBatchFormat::EncodeMessage(MessageDataBuffer.GetData(), MessageDataBuffer.Num(), bAllowCompression, CompressedDataBuffer,
+        [&](uint8 EntryFlags, const uint8* EntryData, int32 EntryDataSize) {
+            AppendMessageBatchEntry(Connection, MessageType, RemoteChannelId, EntryFlags, EntryData, EntryDataSize);
+        });
+}
+
+void UModNetworkHandler::AppendMessageBatchEntry(UNetConnection* Connection, const FMessageType& MessageType, int32 RemoteChannelId, uint8 EntryFlags, const uint8* Data, int32 DataSize) {
+    FPendingMessageBatch& MessageBatch = PendingMessageBatches.FindOrAdd(Connection);
+    FMemoryWriter Writer(MessageBatch.Payload, false, true);
+
+    FModMessageBatchFormat::WriteEntry(Writer, MessageType, RemoteChannelId, EntryFlags, Data, DataSize);
+    MessageBatch.NumMessages++;
+
+    if (MessageBatch.Payload.Num() >= MaxMessageBatchSize) {
+        FlushMessageBatch(Connection, MessageBatch);
+    }
+}
+
+void UModNetworkHandler::FlushMessageBatch(UNetConnection* Connection, FPendingMessageBatch& MessageBatch) {
+    if (MessageBatch.NumMessages == 0) {
+        return;
+    }
+    UModConnectionStatistics* Statistics = GetConnectionStatistics(Connection);
+    Statistics->BatchesSent++;
+    Statistics->BatchBytesSent += MessageBatch.Payload.Num();
+    
+    FNetControlMessage<NMT_ModMessageBatch>::Send(Connection, MessageBatch.Payload);
+    Connection->FlushNet();
+    MessageBatch.Payload.Reset();
+    MessageBatch.NumMessages = 0;
+}
+
+bool UModNetworkHandler::TickMessageBatches(float DeltaTime) {
+    for (auto It = PendingMessageBatches.CreateIterator(); It; ++It) {
+        UNetConnection* Connection = It.Key().Get();
+        //Messages queued for the connections that have been closed are dropped
+        if (Connection == nullptr || Connection->State == USOCK_Closed) {
+            It.RemoveCurrent();
+            continue;
+        }
+        FlushMessageBatch(Connection, It.Value());
+    }
+
+    if (StatisticsLogInterval > 0.0f) {
+        TimeSinceStatisticsLogged += DeltaTime;
+        if (TimeSinceStatisticsLogged >= StatisticsLogInterval) {
+            TimeSinceStatisticsLogged = 0.0f;
+            //Nothing to report when there are no connections, so don't spam the log with empty lines
+            if (Metadata.Num() > 0) {
+                LogNetworkStatistics();
+            }
+        }
+    }
+    return true;
+}
+
+UModConnectionStatistics* UModNetworkHandler::GetConnectionStatistics(UNetConnection* Connection) {
+    return GetMetadataForConnection(Connection)->GetOrCreateSubObject<UModConnectionStatistics>(UModConnectionStatistics::MetadataSubobjectName);
+}
+
+void UModNetworkHandler::RecordSentMessage(UNetConnection* Connection, int32 ChannelId, int32 DataSize) {
+    UModConnectionStatistics* Statistics = GetConnectionStatistics(Connection);
+    Statistics->TotalStats.RecordSent(DataSize);
+    if (ChannelId != INDEX_NONE) {
+        Statistics->GetMessageTypeStats(ChannelId).RecordSent(DataSize);
+        MessageTypes[ChannelId].Entry.Stats.RecordSent(DataSize);
+    }
+}
+
+void UModNetworkHandler::RecordDroppedMessage(UNetConnection* Connection, int32 ChannelId) {
+    UModConnectionStatistics* Statistics = GetConnectionStatistics(Connection);
+    Statistics->TotalStats.MessagesDropped++;
+    if (ChannelId != INDEX_NONE) {
+        Statistics->GetMessageTypeStats(ChannelId).MessagesDropped++;
+        MessageTypes[ChannelId].Entry.Stats.MessagesDropped++;
+    }
+}
+
+bool UModNetworkHandler::AdmitReceivedMessage(UNetConnection* Connection, int32 ChannelId, int32 DataSize) {
+    UModConnectionStatistics* Statistics = GetConnectionStatistics(Connection);
+    const FIsExemptFromRateLimits& IsExemptFromRateLimits = MessageTypes[ChannelId].Entry.IsExemptFromRateLimits;
+    const bool bExemptFromRateLimits = IsExemptFromRateLimits.IsBound() && IsExemptFromRateLimits.Execute(Connection);
+    
+    if (!bExemptFromRateLimits && (MaxReceivedMessagesPerSecond > 0 || MaxReceivedBytesPerSecond > 0)) {
+        const double CurrentTime = FPlatformTime::Seconds();
+        if (CurrentTime - Statistics->RateLimitWindowStart >= 1.0) {
+            Statistics->RateLimitWindowStart = CurrentTime;
+            Statistics->MessagesReceivedInWindow = 0;
+            Statistics->BytesReceivedInWindow = 0;
+            Statistics->bRateLimitExceededInWindow = false;
+        }
+        const bool bExceedsMessageLimit = MaxReceivedMessagesPerSecond > 0 && Statistics->MessagesReceivedInWindow >= MaxReceivedMessagesPerSecond;
+        const bool bExceedsByteLimit = MaxReceivedBytesPerSecond > 0 && Statistics->BytesReceivedInWindow + DataSize > MaxReceivedBytesPerSecond;
+        
+        if (bExceedsMessageLimit || bExceedsByteLimit) {
+            RecordDroppedMessage(Connection, ChannelId);
+            //Only report the first dropped message in the window, flooding connection would spam the log otherwise
+            if (!Statistics->bRateLimitExceededInWindow) {
+                Statistics->bRateLimitExceededInWindow = true;
+                UE_LOG(LogModNetworkHandler, Warning, TEXT("Connection %s exceeded mod message rate limit, dropping message %s"),
+                    *Connection->LowLevelGetRemoteAddress(), *DescribeMessageChannel(ChannelId));
+                RateLimitExceededDelegate.Broadcast(Connection, MessageTypes[ChannelId].MessageType);
+            }
+            return false;
+        }
+        Statistics->MessagesReceivedInWindow++;
+        Statistics->BytesReceivedInWindow += DataSize;
+    }
+    Statistics->TotalStats.RecordReceived(DataSize);
+    Statistics->GetMessageTypeStats(ChannelId).RecordReceived(DataSize);
+    MessageTypes[ChannelId].Entry.Stats.RecordReceived(DataSize);
+    return true;
+}
+
+static TSharedRef<FJsonObject> SerializeMessageTypeStats(const FMessageTypeStats& Stats) {
+    const TSharedRef<FJsonObject> StatsObject = MakeShareable(new FJsonObject());
+    StatsObject->SetNumberField(TEXT("messagesSent"), Stats.MessagesSent);
+    StatsObject->SetNumberField(TEXT("bytesSent"), Stats.BytesSent);
+    StatsObject->SetNumberField(TEXT("messagesReceived"), Stats.MessagesReceived);
+    StatsObject->SetNumberField(TEXT("bytesReceived"), Stats.BytesReceived);
+    StatsObject->SetNumberField(TEXT("messagesDropped"), Stats.MessagesDropped);
+    return StatsObject;
+}
+
+static void AccumulateMessageTypeStats(FMessageTypeStats& OutStats, const FMessageTypeStats& Stats) {
+    OutStats.MessagesSent += Stats.MessagesSent;
+    OutStats.BytesSent += Stats.BytesSent;
+    OutStats.MessagesReceived += Stats.MessagesReceived;
+    OutStats.BytesReceived += Stats.BytesReceived;
+    OutStats.MessagesDropped += Stats.MessagesDropped;
+}
+
+TSharedRef<FJsonObject> UModNetworkHandler::SerializeConnectionStatistics(UNetConnection* Connection, const UModConnectionStatistics* Statistics) const {
+    const TSharedRef<FJsonObject> ConnectionObject = MakeShareable(new FJsonObject());
+    ConnectionObject->SetStringField(TEXT("address"), Connection->LowLevelGetRemoteAddress());
+    
+    APlayerController* PlayerController = Connection->PlayerController;
+    if (PlayerController != nullptr && PlayerController->PlayerState != nullptr) {
+        ConnectionObject->SetStringField(TEXT("player"), PlayerController->PlayerState->GetPlayerName());
+    }
+    ConnectionObject->SetObjectField(TEXT("total"), SerializeMessageTypeStats(Statistics->TotalStats));
+    ConnectionObject->SetNumberField(TEXT("batchesSent"), Statistics->BatchesSent);
+    ConnectionObject->SetNumberField(TEXT("batchBytesSent"), Statistics->BatchBytesSent);
+    ConnectionObject->SetNumberField(TEXT("batchesReceived"), Statistics->BatchesReceived);
+    ConnectionObject->SetNumberField(TEXT("batchBytesReceived"), Statistics->BatchBytesReceived);
+
+    TMap<FString, FMessageTypeStats> ModStats;
+    const TSharedRef<FJsonObject> MessageTypesObject = MakeShareable(new FJsonObject());
+    for (int32 ChannelId = 0; ChannelId < Statistics->MessageTypeStats.Num(); ChannelId++) {
+        const FMessageTypeStats& Stats = Statistics->MessageTypeStats[ChannelId];
+        if (Stats.MessagesSent == 0 && Stats.MessagesReceived == 0 && Stats.MessagesDropped == 0) {
+            continue;
+        }
+        AccumulateMessageTypeStats(ModStats.FindOrAdd(MessageTypes[ChannelId].MessageType.ModReference), Stats);
+        MessageTypesObject->SetObjectField(DescribeMessageChannel(ChannelId), SerializeMessageTypeStats(Stats));
+    }
+    const TSharedRef<FJsonObject> ModsObject = MakeShareable(new FJsonObject());
+    for (const TPair<FString, FMessageTypeStats>& Pair : ModStats) {
+        ModsObject->SetObjectField(Pair.Key, SerializeMessageTypeStats(Pair.Value));
+    }
+    ConnectionObject->SetObjectField(TEXT("mods"), ModsObject);
+    ConnectionObject->SetObjectField(TEXT("messageTypes"), MessageTypesObject);
+    return ConnectionObject;
+}
+
+TSharedRef<FJsonObject> UModNetworkHandler::SerializeNetworkStatistics() const {
+    TArray<TSharedPtr<FJsonValue>> ConnectionsArray;
+    for (const TPair<TWeakObjectPtr<UNetConnection>, UObjectMetadata*>& Pair : Metadata) {
+        UNetConnection* Connection = Pair.Key.Get();
+        const UModConnectionStatistics* Statistics = Pair.Value->FindSubObject<UModConnectionStatistics>(UModConnectionStatistics::MetadataSubobjectName);
+        if (Connection != nullptr && Statistics != nullptr) {
+            ConnectionsArray.Add(MakeShareable(new FJsonValueObject(SerializeConnectionStatistics(Connection, Statistics))));
+        }
+    }
+    
+    const TSharedRef<FJsonObject> MessageTypesObject = MakeShareable(new FJsonObject());
+    for (int32 ChannelId = 0; ChannelId < MessageTypes.Num(); ChannelId++) {
+        MessageTypesObject->SetObjectField(DescribeMessageChannel(ChannelId), SerializeMessageTypeStats(MessageTypes[ChannelId].Entry.Stats));
+    }
+    
+    const TSharedRef<FJsonObject> RootObject = MakeShareable(new FJsonObject());
+    RootObject->SetArrayField(TEXT("connections"), ConnectionsArray);
+    RootObject->SetObjectField(TEXT("messageTypes"), MessageTypesObject);
+    return RootObject;
+}
+
+void UModNetworkHandler::LogNetworkStatistics() const {
+    FString OutSerializedStats;
+    const TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> JsonWriter = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&OutSerializedStats);
+    FJsonSerializer::Serialize(SerializeNetworkStatistics(), JsonWriter);
+    UE_LOG(LogModNetworkHandler, Display, TEXT("Network statistics: %s"), *OutSerializedStats);
+}
+
+int32 UModNetworkHandler::FindMessageChannelId(const FString& ModId, int32 MessageId) const {
+    const TMap<int32, int32>* ModChannelIds = MessageChannelIds.Find(ModId);
+    const int32* ChannelId = ModChannelIds != nullptr ? ModChannelIds->Find(MessageId) : nullptr;
+    return ChannelId != nullptr ? *ChannelId : INDEX_NONE;
+}
+
+FMessageEntry* UModNetworkHandler::FindMessageEntry(const FString& ModId, int32 MessageId) {
+    const int32 ChannelId = FindMessageChannelId(ModId, MessageId);
+    return ChannelId != INDEX_NONE ? &MessageTypes[ChannelId].Entry : nullptr;
+}
+
+bool UModNetworkHandler::CanHandleMessage(UNetConnection* Connection, const FMessageEntry& MessageEntry) {
+    const bool bIsClientSide = Connection->ClientLoginState == EClientLoginState::Invalid;
+    return (bIsClientSide && MessageEntry.bClientHandled) || (!bIsClientSide && MessageEntry.bServerHandled);
+}
+
+const FMessageTypeStats* UModNetworkHandler::GetMessageTypeStats(const FMessageType& MessageType) const {
+    const int32 ChannelId = FindMessageChannelId(MessageType.ModReference, MessageType.MessageId);
+    return ChannelId != INDEX_NONE ? &MessageTypes[ChannelId].Entry.Stats : nullptr;
+}
+
+void UModNetworkHandler::ReceiveMessage(UNetConnection* Connection, const FString& ModId, int32 MessageId, const FString& Content) {
+    const int32 ChannelId = FindMessageChannelId(ModId, MessageId);
+    FMessageEntry* MessageEntry = ChannelId != INDEX_NONE ? &MessageTypes[ChannelId].Entry : nullptr;
+    if (MessageEntry != nullptr && CanHandleMessage(Connection, *MessageEntry)) {
+        const int32 ContentSize = GetSerializedStringSize(Content);
+        if (MessageEntry->MaxMessageSize > 0 && ContentSize > MessageEntry->MaxMessageSize) {
+            RecordDroppedMessage(Connection, ChannelId);
+            return;
+        }
+        if (AdmitReceivedMessage(Connection, ChannelId, ContentSize)) {
+            MessageEntry->MessageReceived.ExecuteIfBound(Connection, Content);
+        }
+    }
+}
+
+void UModNetworkHandler::ReceiveMessageBatch(UNetConnection* Connection, const TArray<uint8>& Payload) {
+    UModConnectionStatistics* Statistics = GetConnectionStatistics(Connection);
+    Statistics->BatchesReceived++;
+    Statistics->BatchBytesReceived += Payload.Num();
+    
+    FMemoryReader Reader(Payload);
+    FMessageBatchEntry Entry;
+    
+    while (!Reader.AtEnd()) {
+        if (!FModMessageBatchFormat::ReadEntry(Reader, Entry)) {
+            UE_LOG(LogModNetworkHandler, Warning, TEXT("Received malformed mod message batch from %s"), *Connection->LowLevelGetRemoteAddress());
+            PartialBinaryMessages.Remove(Connection);
+            return;
+        }
+        const uint8 EntryFlags = Entry.EntryFlags;
+        const TArray<uint8>& EntryData = Entry.Data;
+        const int32 DataSize = EntryData.Num();
+        
+        //Negotiated channel ID is our own channel ID, so it is an index into the message types directly
+        int32 ChannelId;
+        if (EntryFlags & EMessageEntryFlags::ChannelId) {
+            ChannelId = MessageTypes.IsValidIndex((int32) Entry.ChannelId) ? (int32) Entry.ChannelId : INDEX_NONE;
+        } else {
+            ChannelId = FindMessageChannelId(Entry.ModReference, Entry.MessageId);
+        }
+
+        if ((EntryFlags & EMessageEntryFlags::Fragment) == 0) {
+            ReceiveBinaryMessage(Connection, ChannelId, EntryFlags, EntryData);
+            continue;
+        }
+
+        //Fragments of the messages we are never going to dispatch are skipped right away instead of being buffered,
+        //so remote side can't make us accumulate data for the message types which are unknown or not handled on this side
+        FMessageEntry* MessageEntry = ChannelId != INDEX_NONE ? &MessageTypes[ChannelId].Entry : nullptr;
+        if (MessageEntry == nullptr || !CanHandleMessage(Connection, *MessageEntry)) {
+            if (EntryFlags & EMessageEntryFlags::LastFragment) {
+                RecordDroppedMessage(Connection, ChannelId);
             }
+            continue;
+        }
+
+        //Fragments of the message are always sent one after another, so only one message can be partially received at a time
+        FPartialBinaryMessage& PartialMessage = PartialBinaryMessages.FindOrAdd(Connection);
+        if (PartialMessage.Data.Num() == 0) {
+            PartialMessage.ChannelId = ChannelId;
+            PartialMessage.MessageFlags = EntryFlags & ~(EMessageEntryFlags::Fragment | EMessageEntryFlags::LastFragment);
+        }
+        
+        //Enforce quotas while receiving, so oversized messages are dropped before they are fully buffered
+        const int32 MaxReceivedSize = MessageEntry->MaxMessageSize > 0 ? FMath::Min(MessageEntry->MaxMessageSize, MaxReassembledMessageSize) : MaxReassembledMessageSize;
+        
+        //Rest of the fragments is still going to arrive, so there is no way to recover other than closing the connection
+        if (PartialMessage.ChannelId != ChannelId || PartialMessage.Data.Num() + DataSize > MaxReceivedSize) {
+            UE_LOG(LogModNetworkHandler, Warning, TEXT("Closing connection %s: fragmented message %s is malformed or exceeds the size quota"),
+                *Connection->LowLevelGetRemoteAddress(), *DescribeMessageChannel(ChannelId));
+            RecordDroppedMessage(Connection, ChannelId);
+            PartialBinaryMessages.Remove(Connection);
+            Connection->Close();
+            return;
+        }
+        PartialMessage.Data.Append(EntryData);
+
+        if (EntryFlags & EMessageEntryFlags::LastFragment) {
+            const FPartialBinaryMessage CompleteMessage = PartialBinaryMessages.FindAndRemoveChecked(Connection);
+            ReceiveBinaryMessage(Connection, CompleteMessage.ChannelId, CompleteMessage.MessageFlags, CompleteMessage.Data);
+        }
+    }
+}
+
+void UModNetworkHandler::ReceiveBinaryMessage(UNetConnection* Connection, int32 ChannelId, uint8 MessageFlags, const TArray<uint8>& Data) {
+    if (ChannelId == INDEX_NONE) {
+        return;
+    }
+    FMessageEntry* MessageEntry = &MessageTypes[ChannelId].Entry;
+    if (!CanHandleMessage(Connection, *MessageEntry)) {
+        return;
+    }
+    const int32 MaxReceivedSize = MessageEntry->MaxMessageSize > 0 ? FMath::Min(MessageEntry->MaxMessageSize, MaxReassembledMessageSize) : MaxReassembledMessageSize;
+    
+    if ((MessageFlags & EMessageEntryFlags::Compressed) == 0) {
+        if (Data.Num() > MaxReceivedSize) {
+            RecordDroppedMessage(Connection, ChannelId);
+            return;
+        }
+        if (AdmitReceivedMessage(Connection, ChannelId, Data.Num())) {
+            DispatchBatchedMessage(Connection, *MessageEntry, MessageFlags, Data);
         }
+        return;
+    }
+
+    //Check uncompressed size against the quota before decompressing anything
+    const int32 UncompressedSize = FModMessageBatchFormat::GetUncompressedSize(Data);
+    if (UncompressedSize <= 0 || UncompressedSize > MaxReceivedSize) {
+        UE_LOG(LogModNetworkHandler, Warning, TEXT("Dropping compressed message %s of %d bytes, exceeding the quota of %d bytes"), *DescribeMessageChannel(ChannelId), UncompressedSize, MaxReceivedSize);
+        RecordDroppedMessage(Connection, ChannelId);
+        return;
     }
+    //Rate limits are applied before decompressing, so flooding connection doesn't make us spend time on decompression
+    if (!AdmitReceivedMessage(Connection, ChannelId, UncompressedSize)) {
+        return;
+    }
+    TArray<uint8> UncompressedData;
+    if (!FModMessageBatchFormat::DecompressMessage(Data, UncompressedSize, UncompressedData)) {
+        UE_LOG(LogModNetworkHandler, Warning, TEXT("Failed to decompress message %s"), *DescribeMessageChannel(ChannelId));
+        RecordDroppedMessage(Connection, ChannelId);
+        return;
+    }
+    DispatchBatchedMessage(Connection, *MessageEntry, MessageFlags, UncompressedData);
+}
+
+void UModNetworkHandler::DispatchBatchedMessage(UNetConnection* Connection, const FMessageEntry& MessageEntry, uint8 MessageFlags, const TArray<uint8>& Data) {
+    if (MessageFlags & EMessageEntryFlags::StringMessage) {
+        const FUTF8ToTCHAR DecodedData(reinterpret_cast<const ANSICHAR*>(Data.GetData()), Data.Num());
+        MessageEntry.MessageReceived.ExecuteIfBound(Connection, FString(DecodedData.Length(), DecodedData.Get()));
+        return;
+    }
+    MessageEntry.BinaryMessageReceived.ExecuteIfBound(Connection, Data);
 }
 
 UObjectMetadata* UModNetworkHandler::GetMetadataForConnection(UNetConnection* Connection) {
@@ -66,6 +562,9 @@ void UModNetworkHandler::InitializePatches() {
         if (GEngine != NULL) {
         	UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
         	NetworkHandler->Metadata.Remove(Connection);
+        	NetworkHandler->PendingMessageBatches.Remove(Connection);
+        	NetworkHandler->PartialBinaryMessages.Remove(Connection);
+        	NetworkHandler->NegotiatedChannels.Remove(Connection);
         }
     });
 	
@@ -93,6 +592,13 @@ void UModNetworkHandler::InitializePatches() {
                 NetworkHandler->ReceiveMessage(Connection, ModId, MessageId, Content);
                 Call.Cancel();
             }
+        } else if (MessageType == NMT_ModMessageBatch) {
+            TArray<uint8> Payload;
+            if (FNetControlMessage<NMT_ModMessageBatch>::Receive(Bunch, Payload)) {
+                UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
+                NetworkHandler->ReceiveMessageBatch(Connection, Payload);
+                Call.Cancel();
+            }
         }
     };
 
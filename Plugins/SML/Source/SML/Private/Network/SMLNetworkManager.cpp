@@ -6,8 +6,57 @@
 #include "Player/SMLRemoteCallObject.h"
 #include "GameFramework/GameModeBase.h"
 #include "ModLoading/ModLoadingLibrary.h"
+#include "Interfaces/IPluginManager.h"
+#include "Hash/CityHash.h"
 
 TSharedPtr<FMessageType> FSMLNetworkManager::MessageTypeModInit = NULL;
+TSharedPtr<FMessageType> FSMLNetworkManager::MessageTypeMessageChannels = NULL;
+
+/** Local mod which requires the client to have a matching version installed */
+struct FSMLRemoteModRequirement {
+    FString ModName;
+    /** Name of the mod shown to the client when it is missing */
+    FString DisplayName;
+    FVersionRange RemoteVersionRange;
+};
+
+//Handshake data depending only on the local mods and message types, built once and reused for every join.
+//Message channel count is recorded to detect message types registered after the data has been built
+static FString CachedLocalModList;
+static FString CachedMessageChannelsReply;
+static int32 CachedMessageChannelCount = INDEX_NONE;
+static TArray<FSMLRemoteModRequirement> CachedRemoteModRequirements;
+static bool bRemoteModRequirementsCached = false;
+
+//Mod lists received from the clients, keyed by the hash of the mod list message.
+//Clients joining after the server restart usually have identical mod lists, so they are only parsed and validated once
+static TMap<uint64, TSharedRef<FSMLClientModList>> ClientModListCache;
+//Cache is just emptied when it grows past this size, since different mod lists are rare and cheap to parse again
+static constexpr int32 MaxCachedClientModLists = 64;
+
+//Quota of the handshake messages. Mod list and message channels of even very large modpacks are far smaller than that,
+//while the remote side can't make us parse arbitrarily large JSON documents
+static constexpr int32 MaxHandshakeMessageSize = 256 * 1024;
+
+/** Serializes list of the message channels into the JSON array */
+static TArray<TSharedPtr<FJsonValue>> SerializeMessageChannels(const TArray<FString>& MessageChannels) {
+    TArray<TSharedPtr<FJsonValue>> MessageChannelsArray;
+    for (const FString& MessageChannel : MessageChannels) {
+        MessageChannelsArray.Add(MakeShareable(new FJsonValueString(MessageChannel)));
+    }
+    return MessageChannelsArray;
+}
+
+/** Reads list of the message channels from the JSON object, if it has one */
+static bool ParseMessageChannels(const TSharedPtr<FJsonObject>& Object, TArray<FString>& OutMessageChannels) {
+    if (!Object->HasTypedField<EJson::Array>(TEXT("MessageChannels"))) {
+        return false;
+    }
+    for (const TSharedPtr<FJsonValue>& Value : Object->GetArrayField(TEXT("MessageChannels"))) {
+        OutMessageChannels.Add(Value->AsString());
+    }
+    return true;
+}
 
 void FSMLNetworkManager::RegisterMessageTypeAndHandlers() {
     UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
@@ -15,8 +64,23 @@ void FSMLNetworkManager::RegisterMessageTypeAndHandlers() {
     
     FMessageEntry& MessageEntry = NetworkHandler->RegisterMessageType(*MessageTypeModInit);
     MessageEntry.bServerHandled = true;
+    MessageEntry.MaxMessageSize = MaxHandshakeMessageSize;
+    //Handshake must never be dropped, client connection would be stuck waiting for the server to accept it otherwise.
+    //Only the first mod list of the connection is exempt, repeated ones are rate limited and close the connection
+    MessageEntry.IsExemptFromRateLimits.BindStatic(FSMLNetworkManager::IsAwaitingModList);
     
     MessageEntry.MessageReceived.BindStatic(FSMLNetworkManager::HandleMessageReceived);
+
+    //Sent by the server in response to the mod list, so client can address binary messages by the channel ID too
+    MessageTypeMessageChannels = MakeShareable(new FMessageType{TEXT("SML"), 2});
+    FMessageEntry& ChannelsMessageEntry = NetworkHandler->RegisterMessageType(*MessageTypeMessageChannels);
+    ChannelsMessageEntry.bClientHandled = true;
+    ChannelsMessageEntry.MaxMessageSize = MaxHandshakeMessageSize;
+    ChannelsMessageEntry.IsExemptFromRateLimits.BindStatic(FSMLNetworkManager::IsAwaitingMessageChannels);
+    ChannelsMessageEntry.MessageReceived.BindStatic(FSMLNetworkManager::HandleMessageChannelsReceived);
+    
+    IPluginManager::Get().OnNewPluginMounted().AddLambda([](IPlugin&) { FSMLNetworkManager::InvalidateHandshakeCache(); });
+    
     NetworkHandler->OnClientInitialJoin().AddStatic(FSMLNetworkManager::HandleInitialClientJoin);
     NetworkHandler->OnWelcomePlayer().AddStatic(FSMLNetworkManager::HandleWelcomePlayer);
     FGameModeEvents::GameModePostLoginEvent.AddStatic(FSMLNetworkManager::HandleGameModePostLogin);
@@ -26,9 +90,100 @@ void FSMLNetworkManager::HandleMessageReceived(UNetConnection* Connection, FStri
     UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
     UObjectMetadata* Metadata = NetworkHandler->GetMetadataForConnection(Connection);
     USMLConnectionMetadata* SMLMetadata = Metadata->GetOrCreateSubObject<USMLConnectionMetadata>(TEXT("SML"));
+    
+    //Client sends the mod list only once, so repeated ones are never legitimate and would only make us parse and reply again
+    if (SMLMetadata->bIsInitialized) {
+        UE_LOG(LogModNetworkHandler, Warning, TEXT("Closing connection %s: mod list has been sent more than once"), *Connection->LowLevelGetRemoteAddress());
+        Connection->Close();
+        return;
+    }
     SMLMetadata->bIsInitialized = true;
-    if (!HandleModListObject(SMLMetadata, Data)) {
+    
+    const TSharedRef<FSMLClientModList> ClientModList = FindOrParseClientModList(Data);
+    if (!ClientModList->bIsValid) {
         Connection->Close();
+        return;
+    }
+    SMLMetadata->InstalledClientMods = ClientModList->InstalledMods;
+    SMLMetadata->ClientModList = ClientModList;
+    
+    //Older clients don't send message channels, and keep receiving messages addressed by name
+    if (ClientModList->MessageChannels.Num() > 0) {
+        NetworkHandler->SetRemoteMessageChannels(Connection, ClientModList->MessageChannels);
+    }
+
+    if (CachedMessageChannelCount != NetworkHandler->GetNumLocalMessageChannels()) {
+        InvalidateHandshakeCache();
+        CachedMessageChannelCount = NetworkHandler->GetNumLocalMessageChannels();
+    }
+    if (CachedMessageChannelsReply.IsEmpty()) {
+        TSharedRef<FJsonObject> MessageChannelsObject = MakeShareable(new FJsonObject());
+        MessageChannelsObject->SetArrayField(TEXT("MessageChannels"), SerializeMessageChannels(NetworkHandler->GetLocalMessageChannels()));
+        
+        const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&CachedMessageChannelsReply);
+        FJsonSerializer::Serialize(MessageChannelsObject, Writer);
+    }
+    NetworkHandler->SendMessage(Connection, *MessageTypeMessageChannels, CachedMessageChannelsReply);
+}
+
+TSharedRef<FSMLClientModList> FSMLNetworkManager::FindOrParseClientModList(const FString& ModListString) {
+    const uint64 ModListHash = CityHash64(reinterpret_cast<const char*>(*ModListString), ModListString.Len() * sizeof(TCHAR));
+    const TSharedRef<FSMLClientModList>* CachedModList = ClientModListCache.Find(ModListHash);
+    
+    //Compare the whole message on hit, so colliding hashes can never make us accept different mod list
+    if (CachedModList != NULL && (*CachedModList)->ModListString.Equals(ModListString, ESearchCase::CaseSensitive)) {
+        return *CachedModList;
+    }
+    
+    const TSharedRef<FSMLClientModList> ClientModList = MakeShared<FSMLClientModList>();
+    ClientModList->ModListString = ModListString;
+    ClientModList->bIsValid = HandleModListObject(ModListString, ClientModList->InstalledMods, ClientModList->MessageChannels);
+
+    if (ClientModListCache.Num() >= MaxCachedClientModLists) {
+        ClientModListCache.Empty();
+    }
+    ClientModListCache.Add(ModListHash, ClientModList);
+    return ClientModList;
+}
+
+void FSMLNetworkManager::InvalidateHandshakeCache() {
+    CachedLocalModList.Empty();
+    CachedMessageChannelsReply.Empty();
+    CachedMessageChannelCount = INDEX_NONE;
+    CachedRemoteModRequirements.Empty();
+    bRemoteModRequirementsCached = false;
+    //Validation results of the cached mod lists depend on the local mods too
+    ClientModListCache.Empty();
+}
+
+bool FSMLNetworkManager::IsAwaitingModList(UNetConnection* Connection) {
+    UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
+    const USMLConnectionMetadata* SMLMetadata = NetworkHandler->GetMetadataForConnection(Connection)->FindSubObject<USMLConnectionMetadata>(TEXT("SML"));
+    return SMLMetadata == NULL || !SMLMetadata->bIsInitialized;
+}
+
+bool FSMLNetworkManager::IsAwaitingMessageChannels(UNetConnection* Connection) {
+    UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
+    const USMLConnectionMetadata* SMLMetadata = NetworkHandler->GetMetadataForConnection(Connection)->FindSubObject<USMLConnectionMetadata>(TEXT("SML"));
+    return SMLMetadata == NULL || !SMLMetadata->bReceivedMessageChannels;
+}
+
+void FSMLNetworkManager::HandleMessageChannelsReceived(UNetConnection* Connection, FString Data) {
+    UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
+    USMLConnectionMetadata* SMLMetadata = NetworkHandler->GetMetadataForConnection(Connection)->GetOrCreateSubObject<USMLConnectionMetadata>(TEXT("SML"));
+    
+    //Server only replies once per mod list, repeated message channels are dropped instead of being parsed again
+    if (SMLMetadata->bReceivedMessageChannels) {
+        return;
+    }
+    SMLMetadata->bReceivedMessageChannels = true;
+    
+    const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Data);
+    TSharedPtr<FJsonObject> MessageChannelsObject;
+    TArray<FString> ServerMessageChannels;
+    
+    if (FJsonSerializer::Deserialize(Reader, MessageChannelsObject) && ParseMessageChannels(MessageChannelsObject, ServerMessageChannels)) {
+        NetworkHandler->SetRemoteMessageChannels(Connection, ServerMessageChannels);
     }
 }
 
@@ -67,6 +222,15 @@ void FSMLNetworkManager::HandleGameModePostLogin(AGameModeBase* GameMode, APlaye
 }
 
 FString FSMLNetworkManager::SerializeLocalModList() {
+    UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
+    if (CachedMessageChannelCount != NetworkHandler->GetNumLocalMessageChannels()) {
+        InvalidateHandshakeCache();
+        CachedMessageChannelCount = NetworkHandler->GetNumLocalMessageChannels();
+    }
+    if (!CachedLocalModList.IsEmpty()) {
+        return CachedLocalModList;
+    }
+    
     TSharedRef<FJsonObject> ModListObject = MakeShareable(new FJsonObject());
 
     UModLoadingLibrary* ModLoadingLibrary = GEngine->GetEngineSubsystem<UModLoadingLibrary>();
@@ -78,15 +242,17 @@ FString FSMLNetworkManager::SerializeLocalModList() {
 
     TSharedRef<FJsonObject> MetadataObject = MakeShareable(new FJsonObject());
     MetadataObject->SetObjectField(TEXT("ModList"), ModListObject);
+
+    //Channel IDs server should use when sending us binary messages
+    MetadataObject->SetArrayField(TEXT("MessageChannels"), SerializeMessageChannels(NetworkHandler->GetLocalMessageChannels()));
     
-    FString ResultString;
-    const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ResultString);
+    const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&CachedLocalModList);
     FJsonSerializer::Serialize(MetadataObject, Writer);
     
-    return ResultString;
+    return CachedLocalModList;
 }
 
-bool FSMLNetworkManager::HandleModListObject(USMLConnectionMetadata* Metadata, const FString& ModListString) {
+bool FSMLNetworkManager::HandleModListObject(const FString& ModListString, TMap<FString, FVersion>& OutInstalledMods, TArray<FString>& OutMessageChannels) {
     const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ModListString);
     TSharedPtr<FJsonObject> MetadataObject;
     
@@ -105,12 +271,13 @@ bool FSMLNetworkManager::HandleModListObject(USMLConnectionMetadata* Metadata, c
         FString ErrorMessage;
         const bool bParseSuccess = ModVersion.ParseVersion(Pair.Value->AsString(), ErrorMessage);
         if (bParseSuccess) {
-            Metadata->InstalledClientMods.Add(Pair.Key, ModVersion);
+            OutInstalledMods.Add(Pair.Key, ModVersion);
         } else {
             return false;
         }
     }
-    
+
+    ParseMessageChannels(MetadataObject, OutMessageChannels);
     return true;
 }
 
@@ -118,35 +285,45 @@ void FSMLNetworkManager::ValidateSMLConnectionData(UNetConnection* Connection) {
     UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
     UObjectMetadata* Metadata = NetworkHandler->GetMetadataForConnection(Connection);
     USMLConnectionMetadata* SMLMetadata = Metadata->GetOrCreateSubObject<USMLConnectionMetadata>(TEXT("SML"));
-    TArray<FString> ClientMissingMods;
     
-    if (!SMLMetadata->bIsInitialized) {
+    if (!SMLMetadata->bIsInitialized || !SMLMetadata->ClientModList.IsValid()) {
         UModNetworkHandler::CloseWithFailureMessage(Connection, TEXT("This server is running Satisfactory Mod Loader, and your client doesn't have it installed."));
         return;
     }
 
-    UModLoadingLibrary* ModLoadingLibrary = GEngine->GetEngineSubsystem<UModLoadingLibrary>();
-    const TArray<FModInfo> Mods = ModLoadingLibrary->GetLoadedMods();
-    
-    for (const FModInfo& ModInfo : Mods) {
-        if (ModInfo.bAcceptsAnyRemoteVersion) {
-            continue; //Server-side only mod
-        }
-        FVersion* ClientVersion = SMLMetadata->InstalledClientMods.Find(ModInfo.Name);
-        const FString ModName = FString::Printf(TEXT("%s (%s)"), *ModInfo.FriendlyName, *ModInfo.Name);
-        if (ClientVersion == nullptr) {
-            ClientMissingMods.Add(ModName);
-            continue;
+    //Local mods don't change after startup, so their requirements are gathered once instead of on every join
+    if (!bRemoteModRequirementsCached) {
+        UModLoadingLibrary* ModLoadingLibrary = GEngine->GetEngineSubsystem<UModLoadingLibrary>();
+        for (const FModInfo& ModInfo : ModLoadingLibrary->GetLoadedMods()) {
+            if (ModInfo.bAcceptsAnyRemoteVersion) {
+                continue; //Server-side only mod
+            }
+            const FString DisplayName = FString::Printf(TEXT("%s (%s)"), *ModInfo.FriendlyName, *ModInfo.Name);
+            CachedRemoteModRequirements.Add(FSMLRemoteModRequirement{ModInfo.Name, DisplayName, ModInfo.RemoteVersionRange});
         }
-        const FVersionRange& RemoteVersion = ModInfo.RemoteVersionRange;
-        if (!RemoteVersion.Matches(*ClientVersion)) {
-            const FString VersionText = FString::Printf(TEXT("required: %s, client: %s"), *RemoteVersion.ToString(), *ClientVersion->ToString());
-            ClientMissingMods.Add(FString::Printf(TEXT("%s: %s"), *ModName, *VersionText));
+        bRemoteModRequirementsCached = true;
+    }
+
+    //Clients with identical mod lists share the result, so only the first of them is actually checked
+    FSMLClientModList& ClientModList = *SMLMetadata->ClientModList;
+    if (!ClientModList.bIsValidated) {
+        for (const FSMLRemoteModRequirement& Requirement : CachedRemoteModRequirements) {
+            const FVersion* ClientVersion = ClientModList.InstalledMods.Find(Requirement.ModName);
+            if (ClientVersion == nullptr) {
+                ClientModList.MissingMods.Add(Requirement.DisplayName);
+                continue;
+            }
+            const FVersionRange& RemoteVersion = Requirement.RemoteVersionRange;
+            if (!RemoteVersion.Matches(*ClientVersion)) {
+                const FString VersionText = FString::Printf(TEXT("required: %s, client: %s"), *RemoteVersion.ToString(), *ClientVersion->ToString());
+                ClientModList.MissingMods.Add(FString::Printf(TEXT("%s: %s"), *Requirement.DisplayName, *VersionText));
+            }
         }
+        ClientModList.bIsValidated = true;
     }
     
-    if (ClientMissingMods.Num() > 0) {
-        const FString JoinedModList = FString::Join(ClientMissingMods, TEXT("\n"));
+    if (ClientModList.MissingMods.Num() > 0) {
+        const FString JoinedModList = FString::Join(ClientModList.MissingMods, TEXT("\n"));
         const FString Reason = FString::Printf(TEXT("Client missing mods: %s"), *JoinedModList);
         UModNetworkHandler::CloseWithFailureMessage(Connection, Reason);
     }
@@ -14,10 +14,7 @@ DEFINE_LOG_CATEGORY(LogBlueprintHookManager);
 	Arr.AddUninitialized(sizeof(Type)); \
 	FPlatformMemory::WriteUnaligned<Type>(&AppendedCode[Arr.Num() - sizeof(Type)], (Type) Value);
 
-void UBlueprintHookManager::HandleHookedFunctionCall(FFrame& Stack, int32 HookOffset) {
-	FFunctionHookInfo& FunctionHookInfo = HookedFunctions.FindChecked(Stack.Node);
-	FunctionHookInfo.InvokeBlueprintHook(Stack, HookOffset);
-}
+TIndirectArray<FBlueprintHookSite> UBlueprintHookManager::HookSites;
 
 #if DEBUG_BLUEPRINT_HOOKING
 void DebugDumpFunctionScriptCode(UFunction* Function, int32 HookOffset, const FString& Postfix) {
@@ -35,7 +32,7 @@ void DebugDumpFunctionScriptCode(UFunction* Function, int32 HookOffset, const FS
 }
 #endif
 
-void UBlueprintHookManager::InstallBlueprintHook(UFunction* Function, int32 HookOffset) {
+void UBlueprintHookManager::InstallBlueprintHook(UFunction* Function, int32 HookOffset, int32 HookSiteIndex, FSMLKismetStatementIndex& StatementIndex) {
 	TArray<uint8>& OriginalCode = Function->Script;
 	checkf(OriginalCode.Num() > HookOffset, TEXT("Invalid hook: HookOffset > Script.Num()"));
 
@@ -46,7 +43,6 @@ void UBlueprintHookManager::InstallBlueprintHook(UFunction* Function, int32 Hook
 	//Minimum amount of bytes required to insert unconditional jump with code offset
 	const int32 MinBytesRequired = 1 + sizeof(CodeSkipSizeType);
 
-	FSMLKismetBytecodeDisassembler Disassembler;
 	int32 BytesAvailable = 0;
 	
 	//Walk over statements until we collect enough bytes for a replacement
@@ -55,7 +51,7 @@ void UBlueprintHookManager::InstallBlueprintHook(UFunction* Function, int32 Hook
 		const int32 CurrentStatementIndex = HookOffset + BytesAvailable;
 		int32 OutStatementLength;
 		
-		const bool bValid = Disassembler.GetStatementLength(Function, CurrentStatementIndex, OutStatementLength);
+		const bool bValid = StatementIndex.GetStatementLength(CurrentStatementIndex, OutStatementLength);
 		checkf(bValid, TEXT("Provided hook offset is not a valid statement index: %d"), HookOffset);
 		BytesAvailable += OutStatementLength;
 	}
@@ -84,9 +80,9 @@ void UBlueprintHookManager::InstallBlueprintHook(UFunction* Function, int32 Hook
 	AppendedCode.Add(EX_CallMath);
 	WRITE_UNALIGNED(AppendedCode, ScriptPointerType, HookCallFunction);
 	
-	//Begin writing function parameters - we have just hook offset constant
+	//Begin writing function parameters - we have just hook site index constant
 	AppendedCode.Add(EX_IntConst);
-	WRITE_UNALIGNED(AppendedCode, int32, HookOffset);
+	WRITE_UNALIGNED(AppendedCode, int32, HookSiteIndex);
 	AppendedCode.Add(EX_EndFunctionParms);
 
 
@@ -114,38 +110,51 @@ void UBlueprintHookManager::InstallBlueprintHook(UFunction* Function, int32 Hook
 	OriginalCode[HookOffset] = EX_Jump;
 	FPlatformMemory::WriteUnaligned<CodeSkipSizeType>(&OriginalCode[HookOffset + 1], StartOfAppendedCode);
 
+	//Update statement index with the patched code and appended code instead of re-parsing the whole function
+	StatementIndex.NotifyScriptPatched(Function, HookOffset, BytesAvailable, StartOfAppendedCode);
+
 #if DEBUG_BLUEPRINT_HOOKING
 	DebugDumpFunctionScriptCode(Function, HookOffset, TEXT("AfterHook"));
 #endif
 }
 
-int32 UBlueprintHookManager::PreProcessHookOffset(UFunction* Function, int32 HookOffset) {
+int32 UBlueprintHookManager::PreProcessHookOffset(UFunction* Function, int32 HookOffset, const FSMLKismetStatementIndex& StatementIndex) {
 	if (HookOffset == EPredefinedHookOffset::Return) {
 		//For now Kismet Compiler will always generate only one Return node, so all
 		//execution paths will end up either with executing it directly or jumping to it
 		//So we need to hook only in one place to handle all possible execution paths
-		FSMLKismetBytecodeDisassembler Disassembler;
 		int32 ReturnOffset;
-		const bool bIsValid = Disassembler.FindFirstStatementOfType(Function, 0, EX_Return, ReturnOffset);
+		const bool bIsValid = StatementIndex.FindFirstStatementOfType(0, EX_Return, ReturnOffset);
 		checkf(bIsValid, TEXT("EX_Return not found for function %s"), *Function->GetPathName());
 		return ReturnOffset;
 	}
 	return HookOffset;
 }
 
-void FFunctionHookInfo::InvokeBlueprintHook(FFrame& Frame, int32 HookOffset) {
+void FBlueprintHookSite::InvokeBlueprintHook(FFrame& Frame) const {
 	FBlueprintHookHelper HookHelper{Frame, ReturnStatementOffset};
-	const TArray<TFunction<HookFunctionSignature>>& Hooks = this->CodeOffsetByHookList.FindChecked(HookOffset);
-	for (const TFunction<HookFunctionSignature>& Hook : Hooks) {
+	//Hooks can register more hooks at this site while being invoked, which publishes a new snapshot,
+	//so hold a reference to the current one to keep it alive until we are done iterating it
+	const TSharedRef<const TArray<TFunction<HookFunctionSignature>>> HooksSnapshot = Hooks;
+	for (const TFunction<HookFunctionSignature>& Hook : *HooksSnapshot) {
 		Hook(HookHelper);
 	}
 }
 
-void FFunctionHookInfo::RecalculateReturnStatementOffset(UFunction* Function) {
-	FSMLKismetBytecodeDisassembler Disassembler;
+void FBlueprintHookSite::AddHook(const TFunction<HookFunctionSignature>& Hook) {
+	TArray<TFunction<HookFunctionSignature>> NewHooks;
+	NewHooks.Reserve(Hooks->Num() + 1);
+	NewHooks.Append(*Hooks);
+	NewHooks.Add(Hook);
+	Hooks = MakeShared<TArray<TFunction<HookFunctionSignature>>>(MoveTemp(NewHooks));
+}
+
+void FFunctionHookInfo::RecalculateReturnStatementOffset() {
 	int32 ReturnInstructionOffset;
-	Disassembler.FindFirstStatementOfType(Function, 0, EX_Return, ReturnInstructionOffset);
-	this->ReturnStatementOffset = ReturnInstructionOffset;
+	StatementIndex.FindFirstStatementOfType(0, EX_Return, ReturnInstructionOffset);
+	for (const TPair<int32, int32>& Pair : HookSiteIndexByCodeOffset) {
+		UBlueprintHookManager::HookSites[Pair.Value].ReturnStatementOffset = ReturnInstructionOffset;
+	}
 }
 
 void UBlueprintHookManager::HookBlueprintFunction(UFunction* Function, const TFunction<HookFunctionSignature>& Hook, int32 HookOffset) {
@@ -158,7 +167,12 @@ void UBlueprintHookManager::HookBlueprintFunction(UFunction* Function, const TFu
 	check(OuterUClass);
 	HookedClasses.AddUnique(OuterUClass);
 	
-	HookOffset = PreProcessHookOffset(Function, HookOffset);
+	FFunctionHookInfo& FunctionHookInfo = HookedFunctions.FindOrAdd(Function);
+	if (!FunctionHookInfo.StatementIndex.IsBuilt()) {
+		//First time this function is hooked, index its statements once
+		FunctionHookInfo.StatementIndex.Build(Function);
+	}
+	HookOffset = PreProcessHookOffset(Function, HookOffset, FunctionHookInfo.StatementIndex);
 	
 #if UE_BLUEPRINT_EVENTGRAPH_FASTCALLS
 	if (Function->EventGraphFunction != nullptr) {
@@ -169,16 +183,19 @@ void UBlueprintHookManager::HookBlueprintFunction(UFunction* Function, const TFu
 	}
 #endif
 
-	FFunctionHookInfo& FunctionHookInfo = HookedFunctions.FindOrAdd(Function);
-	TArray<TFunction<HookFunctionSignature>>& InstalledHooks = FunctionHookInfo.CodeOffsetByHookList.FindOrAdd(HookOffset);
+	const int32* ExistingHookSiteIndex = FunctionHookInfo.HookSiteIndexByCodeOffset.Find(HookOffset);
 
-	if (InstalledHooks.Num() == 0) {
-		//First time function is hooked at this offset, call InstallBlueprintHook
-		InstallBlueprintHook(Function, HookOffset);
+	if (ExistingHookSiteIndex == NULL) {
+		//First time function is hooked at this offset, allocate hook site and call InstallBlueprintHook
+		const int32 HookSiteIndex = HookSites.Add(new FBlueprintHookSite());
+		FunctionHookInfo.HookSiteIndexByCodeOffset.Add(HookOffset, HookSiteIndex);
+		InstallBlueprintHook(Function, HookOffset, HookSiteIndex, FunctionHookInfo.StatementIndex);
 		//Update cached return instruction offset
-		FunctionHookInfo.RecalculateReturnStatementOffset(Function);
+		FunctionHookInfo.RecalculateReturnStatementOffset();
+		HookSites[HookSiteIndex].AddHook(Hook);
+	} else {
+		//Add provided hook into the existing hook site
+		HookSites[*ExistingHookSiteIndex].AddHook(Hook);
 	}
-	//Add provided hook into the array
-	InstalledHooks.Add(Hook);
 #endif
 }
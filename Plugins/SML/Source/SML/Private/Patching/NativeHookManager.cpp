@@ -2,52 +2,509 @@
 #include "CoreMinimal.h"
 #include "funchook.h"
 #include "AssemblyAnalyzer.h"
+#include "HAL/IConsoleManager.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/CoreDelegates.h"
+#include "ModLoading/ModLoadingLibrary.h"
+#include "Util/PluginOwnershipIndex.h"
 
 DEFINE_LOG_CATEGORY(LogNativeHookManager);
 
+bool FNativeHookManagerInternal::bProfilingEnabled = false;
+
+//Profiling data of all installed hooks, keyed by the resolved function address, same as RegisteredListenerMap
+static TMap<void*, TUniquePtr<FNativeHookStats>> HookStatsMap;
+
+static FAutoConsoleVariableRef CVarHookProfilingEnabled(
+	TEXT("SML.Hooks.EnableProfiling"),
+	FNativeHookManagerInternal::bProfilingEnabled,
+	TEXT("Enables recording of call counts and timings for all native hooks and their handlers"));
+
+static FAutoConsoleCommand DumpHookStatsCommand(
+	TEXT("SML.Hooks.DumpStats"),
+	TEXT("Logs collected native hook profiling data, most expensive hooks first"),
+	FConsoleCommandDelegate::CreateStatic(&FNativeHookManagerInternal::DumpHookStats));
+
+static FAutoConsoleCommand DumpHookStatsJsonCommand(
+	TEXT("SML.Hooks.DumpStatsJson"),
+	TEXT("Writes collected native hook profiling data as JSON. Optional argument is the output file path"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		const FString FilePath = Args.Num() > 0 ? Args[0] : FPaths::ProjectLogDir() / TEXT("NativeHookStats.json");
+		FNativeHookManagerInternal::DumpHookStatsToJson(FilePath);
+	}));
+
+static FAutoConsoleCommand ResetHookStatsCommand(
+	TEXT("SML.Hooks.ResetStats"),
+	TEXT("Resets collected native hook profiling data"),
+	FConsoleCommandDelegate::CreateStatic(&FNativeHookManagerInternal::ResetHookStats));
+
+//All of the maps below are guarded by the registration lock. Hook invocation never accesses them
 //since templates are actually compiled for each module separately,
 //we need to have a global handler map which will be shared by all hook invoker templates available in all modules
 //to keep single hook instance for each method
 static TMap<void*, void*> RegisteredListenerMap;
 
-//Map of the function implementation pointer to the trampoline function pointer. Used to ensure one hook per function installed
-static TMap<void*, void*> InstalledHookMap;
+/** Describes installation of the single hook, either queued or already installed */
+struct FHookInstallation {
+	FString DebugSymbolName;
+	void* HookFunctionPointer;
+	//Trampoline pointers of all hook invokers registered for this function, written once the hook is installed
+	TArray<void**> TrampolineOutputs;
+	void* TrampolineFunction;
+	//Funchook handle the hook has been installed with. Shared by all hooks installed in the same batch
+	funchook* FunchookHandle;
+	//Whenever the hook is the only one installed with its funchook handle, so it can be uninstalled without touching any other hooks
+	bool bOwnsFunchookHandle;
+};
+
+//Map of the function implementation pointer to the installed hook. Used to ensure one hook per function installed
+static TMap<void*, FHookInstallation> InstalledHookMap;
+
+//Hooks queued while the hook transaction is open, keyed by the function implementation pointer
+static TMap<void*, FHookInstallation> PendingHookInstallations;
+static bool bHookTransactionActive = false;
+
+/** Memory that might still be used by the hook calls in progress, waiting to be freed */
+struct FRetiredHookAllocation {
+	//Global epoch at the moment of retirement. Hook calls entered with the later epoch can only observe the replacement
+	uint64 RetireEpoch;
+	TFunction<void()> Reclaim;
+};
+
+//Guarded by the registration lock, reclaimed by ReclaimRetiredAllocations on the game thread
+static TArray<FRetiredHookAllocation> RetiredAllocations;
+
+//States of all threads that have ever called a hook. States of the exited threads are reused by the new ones
+static FCriticalSection ThreadStatesLock;
+static TArray<FNativeHookThreadState*> ThreadStates;
+static TArray<FNativeHookThreadState*> FreeThreadStates;
+
+static FDelegateHandle ReclaimRetiredAllocationsHandle;
+
+//Cost of the hooks installed one by one outside of the transaction, measured for comparison in the transaction timing report
+static int32 NumIndividuallyInstalledHooks = 0;
+static double IndividualHookInstallSeconds = 0.0;
+
+std::atomic<uint64> FNativeHookManagerInternal::GlobalEpoch(1);
+
+FCriticalSection& FNativeHookManagerInternal::GetRegistrationLock() {
+	static FCriticalSection RegistrationLock;
+	return RegistrationLock;
+}
+
+/** Owns the hook call state of the thread, returning it to the free list once the thread exits */
+struct FNativeHookThreadStateHolder {
+	FNativeHookThreadState* State;
+
+	FNativeHookThreadStateHolder() {
+		FScopeLock Lock(&ThreadStatesLock);
+		if (FreeThreadStates.Num() > 0) {
+			State = FreeThreadStates.Pop(false);
+		} else {
+			//Allocated with explicit alignment, so states of different threads never share the cache line
+			State = new (FMemory::Malloc(sizeof(FNativeHookThreadState), alignof(FNativeHookThreadState))) FNativeHookThreadState();
+			ThreadStates.Add(State);
+		}
+	}
+
+	~FNativeHookThreadStateHolder() {
+		FScopeLock Lock(&ThreadStatesLock);
+		FreeThreadStates.Add(State);
+	}
+};
+
+FNativeHookThreadState* FNativeHookManagerInternal::GetCurrentThreadState() {
+	static thread_local FNativeHookThreadStateHolder ThreadStateHolder;
+	return ThreadStateHolder.State;
+}
+
+void FNativeHookManagerInternal::RetireAllocation(TFunction<void()>&& Reclaim) {
+	FScopeLock Lock(&GetRegistrationLock());
+	//Replacement has already been published, so calls observing the advanced epoch can only load it
+	const uint64 RetireEpoch = GlobalEpoch.fetch_add(1, std::memory_order_seq_cst);
+	RetiredAllocations.Add(FRetiredHookAllocation{RetireEpoch, MoveTemp(Reclaim)});
+}
+
+static void ReclaimRetiredAllocations() {
+	TArray<FRetiredHookAllocation> ReclaimableAllocations;
+	{
+		FScopeLock Lock(&FNativeHookManagerInternal::GetRegistrationLock());
+		if (RetiredAllocations.Num() == 0) {
+			return;
+		}
+		//Pairs with the fence in FNativeHookCallGuard: thread that has not published its epoch by the time we observe it outside of any hook
+		//will load its snapshots and trampoline after they have been replaced, so it can never see the retired ones
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		uint64 OldestActiveEpoch = MAX_uint64;
+		{
+			FScopeLock ThreadStatesScopeLock(&ThreadStatesLock);
+			for (const FNativeHookThreadState* ThreadState : ThreadStates) {
+				const uint64 ActiveEpoch = ThreadState->ActiveEpoch.load(std::memory_order_acquire);
+				if (ActiveEpoch != 0) {
+					OldestActiveEpoch = FMath::Min(OldestActiveEpoch, ActiveEpoch);
+				}
+			}
+		}
+		for (int32 i = RetiredAllocations.Num() - 1; i >= 0; i--) {
+			if (RetiredAllocations[i].RetireEpoch < OldestActiveEpoch) {
+				ReclaimableAllocations.Add(MoveTemp(RetiredAllocations[i]));
+				RetiredAllocations.RemoveAtSwap(i, 1, false);
+			}
+		}
+	}
+	for (FRetiredHookAllocation& Allocation : ReclaimableAllocations) {
+		Allocation.Reclaim();
+	}
+}
+
+//Retired allocations are only freed once hook calls which could be using them are finished, which is checked once per frame.
+//Thread staying inside of a hook, like one hooking a function running the main loop, delays reclamation until it leaves it, but never reads freed memory
+void FNativeHookManagerInternal::Initialize() {
+	ReclaimRetiredAllocationsHandle = FCoreDelegates::OnEndFrame.AddStatic(&ReclaimRetiredAllocations);
+}
+
+void FNativeHookManagerInternal::Shutdown() {
+	FCoreDelegates::OnEndFrame.Remove(ReclaimRetiredAllocationsHandle);
+	ReclaimRetiredAllocationsHandle.Reset();
+}
 
 void* FNativeHookManagerInternal::GetHandlerListInternal(void* RealFunctionAddress) {
+	FScopeLock Lock(&GetRegistrationLock());
 	void** ExistingMapEntry = RegisteredListenerMap.Find(RealFunctionAddress);
 	return ExistingMapEntry ? *ExistingMapEntry : nullptr;
 }
 
 void FNativeHookManagerInternal::SetHandlerListInstanceInternal(void* RealFunctionAddress, void* HandlerList) {
+	FScopeLock Lock(&GetRegistrationLock());
 	RegisteredListenerMap.Add(RealFunctionAddress, HandlerList);
 }
 
-#define CHECK_FUNCHOOK_ERR(arg) \
-	if (arg != FUNCHOOK_ERROR_SUCCESS) UE_LOG(LogNativeHookManager, Fatal, TEXT("Hooking function %s failed: funchook failed: %hs"), *DebugSymbolName, funchook_error_message(funchook));
+FNativeHookHandlerStats::FNativeHookHandlerStats(const FString& OwnerModuleName, bool bIsAfterHandler) :
+	OwnerModuleName(OwnerModuleName), bIsAfterHandler(bIsAfterHandler), CallCount(0), TotalCycles(0) {
+}
+
+void FNativeHookHandlerStats::Reset() {
+	CallCount = 0;
+	TotalCycles = 0;
+}
+
+FNativeHookStats::FNativeHookStats(const FString& DebugSymbolName, void* FunctionAddress) :
+	DebugSymbolName(DebugSymbolName), FunctionAddress(FunctionAddress), InvocationCount(0), OriginalCallCycles(0) {
+	for (std::atomic<uint64>& Bucket : OriginalCallHistogram) {
+		Bucket = 0;
+	}
+}
+
+uint64 FNativeHookStats::GetOriginalCallPercentileCycles(float Percentile) const {
+	uint64 TotalCalls = 0;
+	for (const std::atomic<uint64>& Bucket : OriginalCallHistogram) {
+		TotalCalls += Bucket.load(std::memory_order_relaxed);
+	}
+	if (TotalCalls == 0) {
+		return 0;
+	}
+	const uint64 TargetCalls = FMath::Max<uint64>((uint64) FMath::CeilToDouble(TotalCalls * (double) Percentile), 1);
+	uint64 AccumulatedCalls = 0;
+	for (int32 i = 0; i < NumHistogramBuckets; i++) {
+		AccumulatedCalls += OriginalCallHistogram[i].load(std::memory_order_relaxed);
+		if (AccumulatedCalls >= TargetCalls) {
+			//Upper bound of the bucket, so we never under-report
+			return i + 1 < NumHistogramBuckets ? (1ull << (i + 1)) : MAX_uint64;
+		}
+	}
+	return MAX_uint64;
+}
+
+void FNativeHookStats::Reset() {
+	InvocationCount = 0;
+	OriginalCallCycles = 0;
+	for (std::atomic<uint64>& Bucket : OriginalCallHistogram) {
+		Bucket = 0;
+	}
+	for (FNativeHookHandlerStats* Handler : HandlerStats) {
+		Handler->Reset();
+	}
+}
+
+FNativeHookStats* FNativeHookManagerInternal::GetHookStats(void* RealFunctionAddress, const FString& DebugSymbolName) {
+	FScopeLock Lock(&GetRegistrationLock());
+	TUniquePtr<FNativeHookStats>* ExistingStats = HookStatsMap.Find(RealFunctionAddress);
+	if (ExistingStats != NULL) {
+		return ExistingStats->Get();
+	}
+	return HookStatsMap.Add(RealFunctionAddress, MakeUnique<FNativeHookStats>(DebugSymbolName, RealFunctionAddress)).Get();
+}
+
+FNativeHookHandlerStats* FNativeHookManagerInternal::RegisterHandlerStats(FNativeHookStats* HookStats, const TCHAR* OwnerModuleName, bool bIsAfterHandler) {
+	FScopeLock Lock(&GetRegistrationLock());
+	FNativeHookHandlerStats* NewStats = new FNativeHookHandlerStats(OwnerModuleName, bIsAfterHandler);
+	HookStats->HandlerStats.Add(NewStats);
+	return NewStats;
+}
+
+void FNativeHookManagerInternal::UnregisterHandlerStats(FNativeHookHandlerListsBase* HandlerLists, FNativeHookHandlerStats* HandlerStats) {
+	FScopeLock Lock(&GetRegistrationLock());
+	HandlerLists->Stats.load(std::memory_order_relaxed)->HandlerStats.Remove(HandlerStats);
+	//Calls in progress might still be recording into the stats, so they are only freed once they are finished
+	FNativeHookManagerInternal::RetireAllocation([HandlerStats]() { delete HandlerStats; });
+}
+
+static double CyclesToMilliseconds(uint64 Cycles) {
+	return Cycles * FPlatformTime::GetSecondsPerCycle64() * 1000.0;
+}
+
+static uint64 GetTotalHookCycles(const FNativeHookStats* Stats) {
+	uint64 TotalCycles = Stats->OriginalCallCycles.load(std::memory_order_relaxed);
+	for (const FNativeHookHandlerStats* Handler : Stats->HandlerStats) {
+		TotalCycles += Handler->TotalCycles.load(std::memory_order_relaxed);
+	}
+	return TotalCycles;
+}
+
+//Handlers are attributed to the modules registering them, which are resolved to the mods owning them only when the stats are dumped
+//Modules not owned by any mod belong to the game itself
+static FString FindHandlerOwnerModName(const FString& OwnerModuleName) {
+	FPluginOwnerEntry OwnerEntry;
+	if (FPluginOwnershipIndex::Get().FindOwnerForModule(*OwnerModuleName, true, OwnerEntry)) {
+		return OwnerEntry.PluginName;
+	}
+	return FACTORYGAME_MOD_NAME;
+}
+
+static TArray<FNativeHookStats*> GetSortedHookStats() {
+	TArray<FNativeHookStats*> SortedStats;
+	for (const TPair<void*, TUniquePtr<FNativeHookStats>>& Pair : HookStatsMap) {
+		SortedStats.Add(Pair.Value.Get());
+	}
+	SortedStats.Sort([](const FNativeHookStats& A, const FNativeHookStats& B) {
+		return GetTotalHookCycles(&A) > GetTotalHookCycles(&B);
+	});
+	return SortedStats;
+}
+
+void FNativeHookManagerInternal::DumpHookStats() {
+	FScopeLock Lock(&GetRegistrationLock());
+	if (!bProfilingEnabled) {
+		UE_LOG(LogNativeHookManager, Warning, TEXT("Hook profiling is disabled, set SML.Hooks.EnableProfiling to 1 to collect data"));
+	}
+	UE_LOG(LogNativeHookManager, Display, TEXT("Native hook statistics for %d hooked functions:"), HookStatsMap.Num());
+
+	for (const FNativeHookStats* Stats : GetSortedHookStats()) {
+		const uint64 InvocationCount = Stats->InvocationCount.load(std::memory_order_relaxed);
+		UE_LOG(LogNativeHookManager, Display, TEXT("%s: %llu calls, total %.3fms, original %.3fms (p50 < %.2fus, p90 < %.2fus, p99 < %.2fus)"),
+			*Stats->DebugSymbolName, InvocationCount,
+			CyclesToMilliseconds(GetTotalHookCycles(Stats)),
+			CyclesToMilliseconds(Stats->OriginalCallCycles.load(std::memory_order_relaxed)),
+			CyclesToMilliseconds(Stats->GetOriginalCallPercentileCycles(0.5f)) * 1000.0,
+			CyclesToMilliseconds(Stats->GetOriginalCallPercentileCycles(0.9f)) * 1000.0,
+			CyclesToMilliseconds(Stats->GetOriginalCallPercentileCycles(0.99f)) * 1000.0);
+
+		for (const FNativeHookHandlerStats* Handler : Stats->HandlerStats) {
+			UE_LOG(LogNativeHookManager, Display, TEXT("    %s handler from %s (module %s): %llu calls, total %.3fms"),
+				Handler->bIsAfterHandler ? TEXT("After") : TEXT("Before"), *FindHandlerOwnerModName(Handler->OwnerModuleName), *Handler->OwnerModuleName,
+				Handler->CallCount.load(std::memory_order_relaxed),
+				CyclesToMilliseconds(Handler->TotalCycles.load(std::memory_order_relaxed)));
+		}
+	}
+}
+
+bool FNativeHookManagerInternal::DumpHookStatsToJson(const FString& FilePath) {
+	FScopeLock Lock(&GetRegistrationLock());
+	TArray<TSharedPtr<FJsonValue>> HooksArray;
+	for (const FNativeHookStats* Stats : GetSortedHookStats()) {
+		const TSharedRef<FJsonObject> HookObject = MakeShareable(new FJsonObject());
+		HookObject->SetStringField(TEXT("function"), Stats->DebugSymbolName);
+		HookObject->SetStringField(TEXT("address"), FString::Printf(TEXT("%p"), Stats->FunctionAddress));
+		HookObject->SetNumberField(TEXT("calls"), Stats->InvocationCount.load(std::memory_order_relaxed));
+		HookObject->SetNumberField(TEXT("totalMs"), CyclesToMilliseconds(GetTotalHookCycles(Stats)));
+		HookObject->SetNumberField(TEXT("originalMs"), CyclesToMilliseconds(Stats->OriginalCallCycles.load(std::memory_order_relaxed)));
+		HookObject->SetNumberField(TEXT("originalP50Us"), CyclesToMilliseconds(Stats->GetOriginalCallPercentileCycles(0.5f)) * 1000.0);
+		HookObject->SetNumberField(TEXT("originalP90Us"), CyclesToMilliseconds(Stats->GetOriginalCallPercentileCycles(0.9f)) * 1000.0);
+		HookObject->SetNumberField(TEXT("originalP99Us"), CyclesToMilliseconds(Stats->GetOriginalCallPercentileCycles(0.99f)) * 1000.0);
+
+		TArray<TSharedPtr<FJsonValue>> HandlersArray;
+		for (const FNativeHookHandlerStats* Handler : Stats->HandlerStats) {
+			const TSharedRef<FJsonObject> HandlerObject = MakeShareable(new FJsonObject());
+			HandlerObject->SetStringField(TEXT("mod"), FindHandlerOwnerModName(Handler->OwnerModuleName));
+			HandlerObject->SetStringField(TEXT("module"), Handler->OwnerModuleName);
+			HandlerObject->SetStringField(TEXT("type"), Handler->bIsAfterHandler ? TEXT("after") : TEXT("before"));
+			HandlerObject->SetNumberField(TEXT("calls"), Handler->CallCount.load(std::memory_order_relaxed));
+			HandlerObject->SetNumberField(TEXT("totalMs"), CyclesToMilliseconds(Handler->TotalCycles.load(std::memory_order_relaxed)));
+			HandlersArray.Add(MakeShareable(new FJsonValueObject(HandlerObject)));
+		}
+		HookObject->SetArrayField(TEXT("handlers"), HandlersArray);
+		HooksArray.Add(MakeShareable(new FJsonValueObject(HookObject)));
+	}
+
+	const TSharedRef<FJsonObject> RootObject = MakeShareable(new FJsonObject());
+	RootObject->SetBoolField(TEXT("profilingEnabled"), bProfilingEnabled);
+	RootObject->SetArrayField(TEXT("hooks"), HooksArray);
+
+	FString OutSerializedStats;
+	const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&OutSerializedStats);
+	FJsonSerializer::Serialize(RootObject, JsonWriter);
+
+	if (!FFileHelper::SaveStringToFile(OutSerializedStats, *FilePath)) {
+		UE_LOG(LogNativeHookManager, Error, TEXT("Failed to write native hook statistics to %s"), *FilePath);
+		return false;
+	}
+	UE_LOG(LogNativeHookManager, Display, TEXT("Native hook statistics written to %s"), *FilePath);
+	return true;
+}
+
+void FNativeHookManagerInternal::ResetHookStats() {
+	FScopeLock Lock(&GetRegistrationLock());
+	for (const TPair<void*, TUniquePtr<FNativeHookStats>>& Pair : HookStatsMap) {
+		Pair.Value->Reset();
+	}
+	UE_LOG(LogNativeHookManager, Display, TEXT("Native hook statistics have been reset"));
+}
 
 void LogDebugAssemblyAnalyzer(const ANSICHAR* Message) {
 	UE_LOG(LogNativeHookManager, Display, TEXT("AssemblyAnalyzer Debug: %hs"), Message);
 }
 
+/**
+ * Prepares all of the provided hooks on a single funchook handle, then installs them all with one funchook_install call
+ * Then writes resulting trampolines
+ */
+static void InstallHookBatch(TMap<void*, FHookInstallation>& Hooks) {
+	funchook* funchook = funchook_create();
+	if (funchook == nullptr) {
+		UE_LOG(LogNativeHookManager, Fatal, TEXT("Hooking %d functions failed: funchook_create() returned NULL"), Hooks.Num());
+		return;
+	}
+	for (TPair<void*, FHookInstallation>& Pair : Hooks) {
+		Pair.Value.TrampolineFunction = Pair.Key;
+		Pair.Value.FunchookHandle = funchook;
+		Pair.Value.bOwnsFunchookHandle = Hooks.Num() == 1;
+		if (funchook_prepare(funchook, &Pair.Value.TrampolineFunction, Pair.Value.HookFunctionPointer) != FUNCHOOK_ERROR_SUCCESS) {
+			UE_LOG(LogNativeHookManager, Fatal, TEXT("Hooking function %s failed: funchook failed: %hs"), *Pair.Value.DebugSymbolName, funchook_error_message(funchook));
+		}
+	}
+	if (funchook_install(funchook, 0) != FUNCHOOK_ERROR_SUCCESS) {
+		UE_LOG(LogNativeHookManager, Fatal, TEXT("Hooking %d functions failed: funchook failed: %hs"), Hooks.Num(), funchook_error_message(funchook));
+	}
+	
+	for (TPair<void*, FHookInstallation>& Pair : Hooks) {
+		for (void** TrampolineOutput : Pair.Value.TrampolineOutputs) {
+			*TrampolineOutput = Pair.Value.TrampolineFunction;
+		}
+	}
+}
+
 bool HookStandardFunction(const FString& DebugSymbolName, void* OriginalFunctionPointer, void* HookFunctionPointer, void** OutTrampolineFunction) {
-	if (InstalledHookMap.Contains(OriginalFunctionPointer)) {
+	FHookInstallation* ExistingInstallation = InstalledHookMap.Find(OriginalFunctionPointer);
+	if (ExistingInstallation != nullptr) {
 		//Hook already installed, set trampoline function and return
-		*OutTrampolineFunction = InstalledHookMap.FindChecked(OriginalFunctionPointer);
+		*OutTrampolineFunction = ExistingInstallation->TrampolineFunction;
+		ExistingInstallation->TrampolineOutputs.Add(OutTrampolineFunction);
 		return false;
 	}
-	funchook* funchook = funchook_create();
-	if (funchook == nullptr) {
-		UE_LOG(LogNativeHookManager, Fatal, TEXT("Hooking function %s failed: funchook_create() returned NULL"), *DebugSymbolName);
-		return false;
+	FHookInstallation* PendingInstallation = PendingHookInstallations.Find(OriginalFunctionPointer);
+	if (PendingInstallation == nullptr) {
+		PendingInstallation = &PendingHookInstallations.Add(OriginalFunctionPointer, FHookInstallation{DebugSymbolName, HookFunctionPointer});
+	}
+	PendingInstallation->TrampolineOutputs.Add(OutTrampolineFunction);
+
+	//Defer installation until the transaction is committed, trampoline will be written then
+	if (bHookTransactionActive) {
+		return true;
 	}
-	*OutTrampolineFunction = OriginalFunctionPointer;
-	CHECK_FUNCHOOK_ERR(funchook_prepare(funchook, OutTrampolineFunction, HookFunctionPointer));
-	CHECK_FUNCHOOK_ERR(funchook_install(funchook, 0));
-	InstalledHookMap.Add(OriginalFunctionPointer, *OutTrampolineFunction);
+	const double StartTime = FPlatformTime::Seconds();
+	InstallHookBatch(PendingHookInstallations);
+	InstalledHookMap.Append(MoveTemp(PendingHookInstallations));
+	PendingHookInstallations.Reset();
+	
+	NumIndividuallyInstalledHooks++;
+	IndividualHookInstallSeconds += FPlatformTime::Seconds() - StartTime;
 	return true;
 }
 
-SML_API void* FNativeHookManagerInternal::RegisterHookFunction(const FString& DebugSymbolName, void* OriginalFunctionPointer, void* SampleObjectInstance, int ThisAdjustment, void* HookFunctionPointer, void** OutTrampolineFunction) {
+void FNativeHookManagerInternal::BeginHookTransaction() {
+	FScopeLock Lock(&GetRegistrationLock());
+	checkf(!bHookTransactionActive, TEXT("Hook transaction is already active"));
+	bHookTransactionActive = true;
+	UE_LOG(LogNativeHookManager, Display, TEXT("Began hook transaction, hook installation will be deferred until it is committed"));
+}
+
+void FNativeHookManagerInternal::CommitHookTransaction() {
+	FScopeLock Lock(&GetRegistrationLock());
+	checkf(bHookTransactionActive, TEXT("Attempt to commit hook transaction when there is no active transaction"));
+	bHookTransactionActive = false;
+	
+	if (PendingHookInstallations.Num() == 0) {
+		UE_LOG(LogNativeHookManager, Display, TEXT("Committed empty hook transaction"));
+		return;
+	}
+	const double StartTime = FPlatformTime::Seconds();
+	InstallHookBatch(PendingHookInstallations);
+	const int32 NumInstalledHooks = PendingHookInstallations.Num();
+	InstalledHookMap.Append(MoveTemp(PendingHookInstallations));
+	PendingHookInstallations.Reset();
+
+	const double ElapsedMilliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	UE_LOG(LogNativeHookManager, Display, TEXT("Committed hook transaction: installed %d hooks with a single funchook_install in %.3fms (%.3fms per hook)"),
+		NumInstalledHooks, ElapsedMilliseconds, ElapsedMilliseconds / NumInstalledHooks);
+	if (NumIndividuallyInstalledHooks > 0) {
+		const double IndividualMilliseconds = IndividualHookInstallSeconds * 1000.0;
+		UE_LOG(LogNativeHookManager, Display, TEXT("For comparison, %d hooks installed individually so far took %.3fms (%.3fms per hook)"),
+			NumIndividuallyInstalledHooks, IndividualMilliseconds, IndividualMilliseconds / NumIndividuallyInstalledHooks);
+	}
+}
+
+void FNativeHookManagerInternal::UnregisterHookFunction(FNativeHookHandlerListsBase* HandlerLists) {
+	FScopeLock Lock(&GetRegistrationLock());
+	void* FunctionAddress = HandlerLists->FunctionAddress;
+
+	FHookInstallation PendingInstallation;
+	if (PendingHookInstallations.RemoveAndCopyValue(FunctionAddress, PendingInstallation)) {
+		HandlerLists->bHookInstalled = false;
+		UE_LOG(LogNativeHookManager, Display, TEXT("Removed queued hook for function %s, it has no handlers left"), *PendingInstallation.DebugSymbolName);
+		return;
+	}
+	FHookInstallation* Installation = InstalledHookMap.Find(FunctionAddress);
+	if (Installation == nullptr) {
+		return;
+	}
+	//Funchook can only uninstall all of the hooks of the handle at once, which would leave the rest of the batch unhooked for a while.
+	//Hook stays installed instead, and with no handlers left its invoker just calls the original function.
+	//It keeps being installed if handlers are added again later
+	if (!Installation->bOwnsFunchookHandle) {
+		UE_LOG(LogNativeHookManager, Display, TEXT("Hook for function %s at %p has no handlers left, it is left installed as pass-through because it shares funchook handle with other hooks"),
+			*Installation->DebugSymbolName, FunctionAddress);
+		return;
+	}
+	HandlerLists->bHookInstalled = false;
+	
+	funchook* FunchookHandle = Installation->FunchookHandle;
+	if (funchook_uninstall(FunchookHandle, 0) != FUNCHOOK_ERROR_SUCCESS) {
+		UE_LOG(LogNativeHookManager, Fatal, TEXT("Uninstalling hook for function %s failed: funchook failed: %hs"), *Installation->DebugSymbolName, funchook_error_message(FunchookHandle));
+	}
+	//Original code is restored now, so hooks still in progress can call it directly instead of the trampoline that is about to go away
+	for (void** TrampolineOutput : Installation->TrampolineOutputs) {
+		*TrampolineOutput = FunctionAddress;
+	}
+	UE_LOG(LogNativeHookManager, Display, TEXT("Uninstalled hook for function %s at %p, it has no handlers left"), *Installation->DebugSymbolName, FunctionAddress);
+	InstalledHookMap.Remove(FunctionAddress);
+	
+	//Trampoline and profiling data might still be used on other threads, so they are only freed once these calls are finished
+	TUniquePtr<FNativeHookStats> HookStats;
+	HookStatsMap.RemoveAndCopyValue(FunctionAddress, HookStats);
+	RetireAllocation([FunchookHandle, RetiredStats = HookStats.Release()]() {
+		funchook_destroy(FunchookHandle);
+		delete RetiredStats;
+	});
+}
+
+SML_API void* FNativeHookManagerInternal::RegisterHookFunction(const FString& DebugSymbolName, void* OriginalFunctionPointer, void* SampleObjectInstance, int ThisAdjustment,
+	void* HookFunctionPointer, void** OutTrampolineFunction, FNativeHookHandlerListsBase* (*CreateHandlerLists)(void* FunctionAddress, FNativeHookStats* Stats), void** OutHandlerLists) {
+	FScopeLock Lock(&GetRegistrationLock());
 	SetDebugLoggingHook(&LogDebugAssemblyAnalyzer);
 	FunctionInfo FunctionInfo = DiscoverFunction((uint8*) OriginalFunctionPointer);
 	checkf(FunctionInfo.bIsValid, TEXT("Attempt to hook invalid function %s: Provided code pointer %p is not valid"), *DebugSymbolName, OriginalFunctionPointer);
@@ -75,8 +532,24 @@ SML_API void* FNativeHookManagerInternal::RegisterHookFunction(const FString& De
 	void* ResolvedHookingFunctionPointer = FunctionInfo.RealFunctionAddress;
 	UE_LOG(LogNativeHookManager, Display, TEXT("Hooking function %s: Provided address: %p, resolved address: %p"), *DebugSymbolName, OriginalFunctionPointer, ResolvedHookingFunctionPointer);
 	
+	//Handler lists should be visible to the hook before it is installed, because it can be called from other threads right away
+	FNativeHookHandlerListsBase* HandlerLists = static_cast<FNativeHookHandlerListsBase*>(GetHandlerListInternal(ResolvedHookingFunctionPointer));
+	if (HandlerLists == nullptr) {
+		HandlerLists = CreateHandlerLists(ResolvedHookingFunctionPointer, GetHookStats(ResolvedHookingFunctionPointer, DebugSymbolName));
+		SetHandlerListInstanceInternal(ResolvedHookingFunctionPointer, HandlerLists);
+	} else {
+		//Profiling data has been freed when the hook was uninstalled, so hook installed again starts with a new one
+		HandlerLists->Stats.store(GetHookStats(ResolvedHookingFunctionPointer, DebugSymbolName), std::memory_order_relaxed);
+	}
+	HandlerLists->bHookInstalled = true;
+	*OutHandlerLists = HandlerLists;
+	
 	HookStandardFunction(DebugSymbolName, ResolvedHookingFunctionPointer, HookFunctionPointer, OutTrampolineFunction);
-	UE_LOG(LogNativeHookManager, Display, TEXT("Successfully hooked function %s at %p"), *DebugSymbolName, ResolvedHookingFunctionPointer);
+	if (bHookTransactionActive) {
+		UE_LOG(LogNativeHookManager, Display, TEXT("Queued hook for function %s at %p, it will be installed once hook transaction is committed"), *DebugSymbolName, ResolvedHookingFunctionPointer);
+	} else {
+		UE_LOG(LogNativeHookManager, Display, TEXT("Successfully hooked function %s at %p"), *DebugSymbolName, ResolvedHookingFunctionPointer);
+	}
 	return ResolvedHookingFunctionPointer;
 }
 
@@ -5,6 +5,7 @@
 #include "FGGameState.h"
 #include "FGRecipeManager.h"
 #include "FGResearchManager.h"
+#include "AvailabilityDependencies/FGAvailabilityDependency.h"
 #include "FGResourceSinkSettings.h"
 #include "FGResourceSinkSubsystem.h"
 #include "FGSchematicManager.h"
@@ -15,14 +16,26 @@
 #include "Patching/NativeHookManager.h"
 #include "Reflection/ReflectionHelper.h"
 #include "Engine/AssetManager.h"
+#include "Async/ParallelFor.h"
+#include "UObject/UObjectHash.h"
+#include "HAL/IConsoleManager.h"
 #include "ModLoading/ModLoadingLibrary.h"
 #include "Subsystem/SubsystemActorManager.h"
 #include "Util/BlueprintAssetHelperLibrary.h"
+#include "Util/PluginOwnershipIndex.h"
 
 DEFINE_LOG_CATEGORY(LogContentRegistry);
 
 static bool GIsRegisteringVanillaContent = false;
 
+//When enabled, incremental flushes into schematic and research managers are checked against a full rebuild
+static bool GVerifyIncrementalManagerFlush = false;
+
+static FAutoConsoleVariableRef CVarVerifyIncrementalManagerFlush(
+    TEXT("SML.ContentRegistry.VerifyIncrementalFlush"),
+    GVerifyIncrementalManagerFlush,
+    TEXT("Verifies incremental schematic and research manager flushes against a full rebuild, and falls back to it on mismatch"));
+
 /** Makes sure provided object instance is valid, crashes with both script call stack and native stack trace if it's not */
 #define CHECK_PROVIDED_OBJECT_VALID(Object, Message, ...) \
 	if (!IsValid(Object)) { \
@@ -35,8 +48,8 @@ static bool GIsRegisteringVanillaContent = false;
 	}
 
 
-void ExtractRecipesFromSchematic(TSubclassOf<UFGSchematic> Schematic, TArray<TSubclassOf<UFGRecipe>>& OutRecipes) {
-    const TArray<UFGUnlock*> Unlocks = UFGSchematic::GetUnlocks(Schematic);
+/** Collects recipes unlocked by the provided unlocks. Only reads the unlock objects, so it is safe to call from the worker threads */
+void ExtractRecipesFromUnlocks(const TArray<UFGUnlock*>& Unlocks, TArray<TSubclassOf<UFGRecipe>>& OutRecipes) {
     for (UFGUnlock* Unlock : Unlocks) {
         if (UFGUnlockRecipe* UnlockRecipe = Cast<UFGUnlockRecipe>(Unlock)) {
             OutRecipes.Append(UnlockRecipe->GetRecipesToUnlock());
@@ -44,26 +57,36 @@ void ExtractRecipesFromSchematic(TSubclassOf<UFGSchematic> Schematic, TArray<TSu
     }
 }
 
-void ExtractSchematicsFromResearchTree(TSubclassOf<UFGResearchTree> ResearchTree, TArray<TSubclassOf<UFGSchematic>>& OutSchematics) {
-    
-    static FStructProperty* NodeDataStructProperty = NULL;
-    static FClassProperty* SchematicStructProperty = NULL;
-    static UClass* ResearchTreeNodeClass = NULL;
-    
-    //Lazily initialize research tree node reflection properties for faster access
+void ExtractRecipesFromSchematic(TSubclassOf<UFGSchematic> Schematic, TArray<TSubclassOf<UFGRecipe>>& OutRecipes) {
+    ExtractRecipesFromUnlocks(UFGSchematic::GetUnlocks(Schematic), OutRecipes);
+}
+
+static FStructProperty* NodeDataStructProperty = NULL;
+static FClassProperty* SchematicStructProperty = NULL;
+static UClass* ResearchTreeNodeClass = NULL;
+
+/** Lazily initializes research tree node reflection properties for faster access. Has to be called on the game thread */
+void InitializeResearchTreeNodeReflection() {
     if (ResearchTreeNodeClass == NULL) {
-        ResearchTreeNodeClass = LoadClass<UFGResearchTreeNode>(NULL, TEXT("/Game/FactoryGame/Schematics/Research/BPD_ResearchTreeNode.BPD_ResearchTreeNode_C"));
-        check(ResearchTreeNodeClass);
+        UClass* NodeClass = LoadClass<UFGResearchTreeNode>(NULL, TEXT("/Game/FactoryGame/Schematics/Research/BPD_ResearchTreeNode.BPD_ResearchTreeNode_C"));
+        check(NodeClass);
         //Make sure class is not garbage collected
-        ResearchTreeNodeClass->AddToRoot();
+        NodeClass->AddToRoot();
         
-        NodeDataStructProperty = FReflectionHelper::FindPropertyChecked<FStructProperty>(ResearchTreeNodeClass, TEXT("mNodeDataStruct"));
+        NodeDataStructProperty = FReflectionHelper::FindPropertyChecked<FStructProperty>(NodeClass, TEXT("mNodeDataStruct"));
         SchematicStructProperty = FReflectionHelper::FindPropertyByShortNameChecked<FClassProperty>(NodeDataStructProperty->Struct, TEXT("Schematic"));
         
         check(SchematicStructProperty->MetaClass->IsChildOf(UFGSchematic::StaticClass()));
+        ResearchTreeNodeClass = NodeClass;
     }
+}
 
-    const TArray<UFGResearchTreeNode*> Nodes = UFGResearchTree::GetNodes(ResearchTree);
+/**
+ * Collects schematics referenced by the provided research tree nodes. Only reads the node objects, so it is safe to call
+ * from the worker threads, as long as InitializeResearchTreeNodeReflection has been called on the game thread beforehand
+ */
+void ExtractSchematicsFromResearchTreeNodes(UClass* ResearchTree, const TArray<UFGResearchTreeNode*>& Nodes, TArray<TSubclassOf<UFGSchematic>>& OutSchematics) {
+    check(ResearchTreeNodeClass);
     for (UFGResearchTreeNode* Node : Nodes) {
         if (!Node->IsA(ResearchTreeNodeClass)) {
             UE_LOG(LogContentRegistry, Warning,
@@ -83,28 +106,39 @@ void ExtractSchematicsFromResearchTree(TSubclassOf<UFGResearchTree> ResearchTree
     }
 }
 
+void ExtractSchematicsFromResearchTree(TSubclassOf<UFGResearchTree> ResearchTree, TArray<TSubclassOf<UFGSchematic>>& OutSchematics) {
+    InitializeResearchTreeNodeReflection();
+    ExtractSchematicsFromResearchTreeNodes(ResearchTree, UFGResearchTree::GetNodes(ResearchTree), OutSchematics);
+}
+
+/**
+ * Finds vanilla primary assets of the provided type. Classes that are already in memory are returned directly,
+ * paths of the rest are appended to OutPendingContent so they can be streamed in asynchronously
+ */
 template<typename T>
-TArray<TSubclassOf<T>> DiscoverVanillaContentOfType() {
+void DiscoverVanillaContentOfType(TArray<TSubclassOf<T>>& OutLoadedContent, TArray<FSoftObjectPath>& OutPendingContent) {
     UClass* PrimaryAssetClass = T::StaticClass();
     UAssetManager& AssetManager = UAssetManager::Get();
     
     const FPrimaryAssetType AssetType = PrimaryAssetClass->GetFName();
     TArray<FAssetData> FoundVanillaAssets;
     AssetManager.GetPrimaryAssetDataList(AssetType, FoundVanillaAssets);
-    TArray<TSubclassOf<T>> OutVanillaContent;
+    const int32 InitialPendingContentNum = OutPendingContent.Num();
 
     for (const FAssetData& AssetData : FoundVanillaAssets) {
         FAssetDataTagMapSharedView::FFindTagResult GeneratedClassTextPath = AssetData.TagsAndValues.FindTag(FBlueprintTags::GeneratedClassPath);
         if (GeneratedClassTextPath.IsSet()) {
-            const FString BlueprintClassPath = FPackageName::ExportTextPathToObjectPath(GeneratedClassTextPath.GetValue());
-            UClass* LoadedClass = LoadClass<T>(NULL, *BlueprintClassPath);
-            if (LoadedClass != NULL) {
-                OutVanillaContent.Add(LoadedClass);
+            const FSoftObjectPath BlueprintClassPath = FPackageName::ExportTextPathToObjectPath(GeneratedClassTextPath.GetValue());
+            UClass* LoadedClass = Cast<UClass>(BlueprintClassPath.ResolveObject());
+            if (LoadedClass == NULL) {
+                OutPendingContent.Add(BlueprintClassPath);
+            } else if (LoadedClass->IsChildOf(PrimaryAssetClass)) {
+                OutLoadedContent.Add(LoadedClass);
             }
         }
     }
-    UE_LOG(LogContentRegistry, Display, TEXT("Discovered %d vanilla assets of type %s"), OutVanillaContent.Num(), *PrimaryAssetClass->GetName());
-    return OutVanillaContent;
+    UE_LOG(LogContentRegistry, Display, TEXT("Discovered %d vanilla assets of type %s, %d of them need to be streamed in"),
+        OutLoadedContent.Num() + OutPendingContent.Num() - InitialPendingContentNum, *PrimaryAssetClass->GetName(), OutPendingContent.Num() - InitialPendingContentNum);
 }
 
 void AModContentRegistry::DisableVanillaContentRegistration() {
@@ -128,6 +162,10 @@ FName AModContentRegistry::FindContentOwnerFast(UClass* ContentClass) {
     
     //Use GetName on package instead of GetPathName() because it's faster and avoids string concat
     const FString ContentOwnerName = UBlueprintAssetHelperLibrary::FindPluginNameByObjectPath(ContentClass->GetOuterUPackage()->GetName());
+    return ValidateContentOwner(ContentClass, ContentOwnerName);
+}
+
+FName AModContentRegistry::ValidateContentOwner(UClass* ContentClass, const FString& ContentOwnerName) {
     if (ContentOwnerName.IsEmpty()) {
         UE_LOG(LogContentRegistry, Error, TEXT("Failed to determine content owner for object %s. This is an error, report to mod author!"), *ContentClass->GetPathName());
         return FACTORYGAME_MOD_NAME;
@@ -135,43 +173,314 @@ FName AModContentRegistry::FindContentOwnerFast(UClass* ContentClass) {
     return *ContentOwnerName;
 }
 
+FName AModContentRegistry::FindContentOwner(UClass* ContentClass) const {
+    const FContentDependencyInfo* Dependencies = PrefetchedDependencies.Find(ContentClass);
+    return Dependencies ? Dependencies->OwnerModReference : FindContentOwnerFast(ContentClass);
+}
+
+template<typename T>
+void CopyPrefetchedReferences(const FContentDependencyInfo& Dependencies, TArray<TSubclassOf<T>>& OutReferences) {
+    OutReferences.Reserve(Dependencies.ReferencedContent.Num());
+    for (UClass* ContentClass : Dependencies.ReferencedContent) {
+        OutReferences.Add(ContentClass);
+    }
+}
+
+void AModContentRegistry::PrefetchContentDependencies(const TArray<UClass*>& Schematics, const TArray<UClass*>& ResearchTrees) {
+    //Content already registered or prefetched is skipped, as well as invalid content, which is reported during registration
+    TSet<UClass*> VisitedContent;
+    auto AddPendingContent = [&](TArray<UClass*>& PendingContent, UClass* ContentClass, const auto& RegistryState) {
+        if (IsValid(ContentClass) && !RegistryState.ContainsObject(ContentClass) && !VisitedContent.Contains(ContentClass)) {
+            VisitedContent.Add(ContentClass);
+            PendingContent.Add(ContentClass);
+        }
+    };
+
+    //Extracts dependencies of a single level of content on the worker threads. Default objects are resolved on the game thread first,
+    //since resolving one can construct it, so workers only read fields of the fully constructed default objects and their subobjects.
+    //Game thread is blocked until the workers finish, so neither garbage collection nor anything else can modify them in the meantime
+    const int32 MinParallelExtractions = 64;
+    auto PrefetchContentLevel = [&](const TArray<UClass*>& PendingContent, auto ExtractReferences) {
+        TArray<UObject*> DefaultObjects;
+        DefaultObjects.Reserve(PendingContent.Num());
+        for (UClass* ContentClass : PendingContent) {
+            DefaultObjects.Add(ContentClass->GetDefaultObject());
+        }
+        TArray<FContentDependencyInfo> LevelDependencies;
+        LevelDependencies.SetNum(PendingContent.Num());
+        ParallelFor(PendingContent.Num(), [&](const int32 Index) {
+            ExtractReferences(PendingContent[Index], DefaultObjects[Index], LevelDependencies[Index]);
+        }, PendingContent.Num() < MinParallelExtractions);
+
+        PrefetchedDependencies.Reserve(PrefetchedDependencies.Num() + PendingContent.Num());
+        for (int32 i = 0; i < PendingContent.Num(); i++) {
+            PrefetchedDependencies.Add(PendingContent[i], MoveTemp(LevelDependencies[i]));
+        }
+    };
+    //Research tree node class is loaded on the first use, which can only happen on the game thread
+    InitializeResearchTreeNodeReflection();
+
+    TArray<UClass*> PendingResearchTrees;
+    for (UClass* ResearchTree : ResearchTrees) {
+        AddPendingContent(PendingResearchTrees, ResearchTree, ResearchTreeRegistryState);
+    }
+    PrefetchContentLevel(PendingResearchTrees, [](UClass* ResearchTree, UObject* DefaultObject, FContentDependencyInfo& OutDependencies) {
+        TArray<TSubclassOf<UFGSchematic>> ReferencedSchematics;
+        ExtractSchematicsFromResearchTreeNodes(ResearchTree, CastChecked<UFGResearchTree>(DefaultObject)->mNodes, ReferencedSchematics);
+        for (const TSubclassOf<UFGSchematic>& Schematic : ReferencedSchematics) {
+            OutDependencies.ReferencedContent.Add(Schematic);
+        }
+    });
+
+    TArray<UClass*> PendingSchematics;
+    for (UClass* Schematic : Schematics) {
+        AddPendingContent(PendingSchematics, Schematic, SchematicRegistryState);
+    }
+    for (UClass* ResearchTree : PendingResearchTrees) {
+        for (UClass* Schematic : PrefetchedDependencies.FindChecked(ResearchTree).ReferencedContent) {
+            AddPendingContent(PendingSchematics, Schematic, SchematicRegistryState);
+        }
+    }
+    PrefetchContentLevel(PendingSchematics, [](UClass*, UObject* DefaultObject, FContentDependencyInfo& OutDependencies) {
+        TArray<TSubclassOf<UFGRecipe>> ReferencedRecipes;
+        ExtractRecipesFromUnlocks(CastChecked<UFGSchematic>(DefaultObject)->mUnlocks, ReferencedRecipes);
+        for (const TSubclassOf<UFGRecipe>& Recipe : ReferencedRecipes) {
+            OutDependencies.ReferencedContent.Add(Recipe);
+        }
+    });
+
+    TArray<UClass*> PendingRecipes;
+    for (UClass* Schematic : PendingSchematics) {
+        for (UClass* Recipe : PrefetchedDependencies.FindChecked(Schematic).ReferencedContent) {
+            AddPendingContent(PendingRecipes, Recipe, RecipeRegistryState);
+        }
+    }
+    
+    //Recipes can reference customization recipes, so keep going until we run out of them
+    TArray<UClass*> PendingItemDescriptors;
+    while (PendingRecipes.Num()) {
+        PrefetchContentLevel(PendingRecipes, [](UClass*, UObject* DefaultObject, FContentDependencyInfo& OutDependencies) {
+            const UFGRecipe* RecipeDefaultObject = CastChecked<UFGRecipe>(DefaultObject);
+            //NULL item descriptors are kept intact so registration can report them
+            for (const FItemAmount& ItemAmount : RecipeDefaultObject->GetIngredients()) {
+                OutDependencies.ReferencedContent.Add(ItemAmount.ItemClass);
+            }
+            OutDependencies.NumIngredients = OutDependencies.ReferencedContent.Num();
+            for (const FItemAmount& ItemAmount : RecipeDefaultObject->GetProducts()) {
+                OutDependencies.ReferencedContent.Add(ItemAmount.ItemClass);
+            }
+            OutDependencies.CustomizationRecipe = RecipeDefaultObject->mMaterialCustomizationRecipe;
+        });
+        
+        TArray<UClass*> PendingCustomizationRecipes;
+        for (UClass* Recipe : PendingRecipes) {
+            const FContentDependencyInfo& Dependencies = PrefetchedDependencies.FindChecked(Recipe);
+            for (UClass* ItemDescriptor : Dependencies.ReferencedContent) {
+                AddPendingContent(PendingItemDescriptors, ItemDescriptor, ItemRegistryState);
+            }
+            if (Dependencies.CustomizationRecipe != NULL) {
+                AddPendingContent(PendingCustomizationRecipes, Dependencies.CustomizationRecipe, RecipeRegistryState);
+            }
+        }
+        PendingRecipes = MoveTemp(PendingCustomizationRecipes);
+    }
+    
+    //Item descriptors do not reference anything, but their owners are still resolved together with the rest of the content
+    PrefetchContentLevel(PendingItemDescriptors, [](UClass*, UObject*, FContentDependencyInfo&) {});
+    ResolvePrefetchedContentOwners();
+}
+
+void AModContentRegistry::ResolvePrefetchedContentOwners() {
+    if (GIsRegisteringVanillaContent) {
+        for (TPair<UClass*, FContentDependencyInfo>& Pair : PrefetchedDependencies) {
+            Pair.Value.OwnerModReference = FACTORYGAME_MOD_NAME;
+        }
+        return;
+    }
+    //Package names are gathered on the game thread. Owners of native classes are resolved here too, since they go through the module manager
+    TArray<UClass*> ContentClasses;
+    TArray<FString> PackageNames;
+    ContentClasses.Reserve(PrefetchedDependencies.Num());
+    PackageNames.Reserve(PrefetchedDependencies.Num());
+    for (TPair<UClass*, FContentDependencyInfo>& Pair : PrefetchedDependencies) {
+        if (Pair.Key->HasAnyClassFlags(CLASS_Native)) {
+            Pair.Value.OwnerModReference = FindContentOwnerFast(Pair.Key);
+            continue;
+        }
+        ContentClasses.Add(Pair.Key);
+        PackageNames.Add(Pair.Key->GetOuterUPackage()->GetName());
+    }
+
+    //Owners of the asset classes only depend on their package names and the ownership index, so they are resolved on the worker threads.
+    //Index is brought up to date beforehand, so workers only ever read it
+    FPluginOwnershipIndex::Get().EnsureIndexUpToDate();
+    TArray<FString> OwnerNames;
+    OwnerNames.SetNum(PackageNames.Num());
+    const int32 MinParallelOwnerLookups = 64;
+    ParallelFor(PackageNames.Num(), [&](const int32 Index) {
+        OwnerNames[Index] = UBlueprintAssetHelperLibrary::FindPluginNameByObjectPath(PackageNames[Index]);
+    }, PackageNames.Num() < MinParallelOwnerLookups);
+    
+    for (int32 i = 0; i < ContentClasses.Num(); i++) {
+        PrefetchedDependencies.FindChecked(ContentClasses[i]).OwnerModReference = ValidateContentOwner(ContentClasses[i], OwnerNames[i]);
+    }
+}
+
+void AModContentRegistry::RegisterContentBatch(const FName ModReference, const TArray<TSubclassOf<UFGSchematic>>& Schematics, const TArray<TSubclassOf<UFGResearchTree>>& ResearchTrees) {
+    const double StartTime = FPlatformTime::Seconds();
+    const int32 InitialSchematicCount = SchematicRegistryState.GetAllObjects().Num();
+    const int32 InitialResearchTreeCount = ResearchTreeRegistryState.GetAllObjects().Num();
+    const int32 InitialRecipeCount = RecipeRegistryState.GetAllObjects().Num();
+    const int32 InitialItemCount = ItemRegistryState.GetAllObjects().Num();
+
+    //Phase one: extract dependencies of the whole batch from CDOs and resolve owners of the extracted content
+    TArray<UClass*> SchematicClasses;
+    SchematicClasses.Reserve(Schematics.Num());
+    for (const TSubclassOf<UFGSchematic>& Schematic : Schematics) {
+        SchematicClasses.Add(Schematic);
+    }
+    TArray<UClass*> ResearchTreeClasses;
+    ResearchTreeClasses.Reserve(ResearchTrees.Num());
+    for (const TSubclassOf<UFGResearchTree>& ResearchTree : ResearchTrees) {
+        ResearchTreeClasses.Add(ResearchTree);
+    }
+    PrefetchContentDependencies(SchematicClasses, ResearchTreeClasses);
+    const double PrefetchFinishedTime = FPlatformTime::Seconds();
+
+    //Phase two: commit registrations on the game thread, using prefetched dependencies
+    for (const TSubclassOf<UFGSchematic>& Schematic : Schematics) {
+        RegisterSchematic(ModReference, Schematic);
+    }
+    for (const TSubclassOf<UFGResearchTree>& ResearchTree : ResearchTrees) {
+        RegisterResearchTree(ModReference, ResearchTree);
+    }
+    PrefetchedDependencies.Empty();
+    const double EndTime = FPlatformTime::Seconds();
+
+    UE_LOG(LogContentRegistry, Display, TEXT("Registered content of %s in %.2fms (dependency extraction: %.2fms, registration: %.2fms): %d schematics, %d research trees, %d recipes, %d item descriptors"),
+        *ModReference.ToString(), (EndTime - StartTime) * 1000.0, (PrefetchFinishedTime - StartTime) * 1000.0, (EndTime - PrefetchFinishedTime) * 1000.0,
+        SchematicRegistryState.GetAllObjects().Num() - InitialSchematicCount, ResearchTreeRegistryState.GetAllObjects().Num() - InitialResearchTreeCount,
+        RecipeRegistryState.GetAllObjects().Num() - InitialRecipeCount, ItemRegistryState.GetAllObjects().Num() - InitialItemCount);
+}
+
 void AModContentRegistry::NotifyModuleRegistrationFinished() {
 	UE_LOG(LogContentRegistry, Log, TEXT("Module content registration finished notify received"));
+	//Vanilla content is normally registered already, since world module manager waits for it before modules register anything
+	WaitForVanillaContentDiscovery();
 	FreezeRegistryState();
 }
 
-void AModContentRegistry::FlushStateToSchematicManager(AFGSchematicManager* SchematicManager) const {
-    const TArray<TSharedPtr<FSchematicRegistrationInfo>> RegisteredSchematics = SchematicRegistryState.GetAllObjects();
+/** Returns true if provided schematic should be listed as available in the schematic manager */
+bool ShouldSchematicBeAvailable(AFGSchematicManager* SchematicManager, TSubclassOf<UFGSchematic> Schematic) {
+    return (UFGSchematic::GetType(Schematic) == ESchematicType::EST_Milestone ||
+        UFGSchematic::GetType(Schematic) == ESchematicType::EST_Tutorial ||
+        UFGSchematic::GetType(Schematic) == ESchematicType::EST_ResourceSink) &&
+        SchematicManager->CanGiveAccessToSchematic(Schematic);
+}
 
-    //Empty lists while maintaining enough capacity to re-populate it later
-    SchematicManager->mAllSchematics.Empty(RegisteredSchematics.Num());
-    SchematicManager->mAvailableSchematics.Empty(RegisteredSchematics.Num());
+void AModContentRegistry::FlushStateToSchematicManager(AFGSchematicManager* SchematicManager, int64 FlushedRegistrationCounter, bool bUnlockStateChanged) const {
+    //Full rebuild of all schematics is only needed when we have not flushed anything into the manager yet,
+    //after that we just append schematics that were registered since the last flush
+    if (FlushedRegistrationCounter < 0) {
+        //Empty list while maintaining enough capacity to re-populate it later
+        SchematicManager->mAllSchematics.Empty(SchematicRegistryState.GetAllObjects().Num());
+    }
+    const TArrayView<const TSharedPtr<FSchematicRegistrationInfo>> NewSchematics = SchematicRegistryState.GetObjectsRegisteredSince(FlushedRegistrationCounter);
+    for (const TSharedPtr<FSchematicRegistrationInfo>& RegistrationInfo : NewSchematics) {
+        SchematicManager->mAllSchematics.Add(RegistrationInfo->RegisteredObject);
+    }
 
-    for (const TSharedPtr<FSchematicRegistrationInfo>& RegistrationInfo : RegisteredSchematics) {
+    //Availability depends on the schematic manager unlock state (CanGiveAccessToSchematic), so schematics flushed earlier
+    //only need to be tested again when it has changed. Otherwise only the new schematics are tested and appended
+    const bool bRebuildAvailableSchematics = FlushedRegistrationCounter < 0 || bUnlockStateChanged;
+    if (bRebuildAvailableSchematics) {
+        SchematicManager->mAvailableSchematics.Reset();
+    }
+    const TArrayView<const TSharedPtr<FSchematicRegistrationInfo>> TestedSchematics = bRebuildAvailableSchematics ?
+        TArrayView<const TSharedPtr<FSchematicRegistrationInfo>>(SchematicRegistryState.GetAllObjects()) : NewSchematics;
+    for (const TSharedPtr<FSchematicRegistrationInfo>& RegistrationInfo : TestedSchematics) {
         TSubclassOf<UFGSchematic> Schematic = RegistrationInfo->RegisteredObject;
-        SchematicManager->mAllSchematics.Add(Schematic);
-
-        if ((UFGSchematic::GetType(Schematic) == ESchematicType::EST_Milestone ||
-            UFGSchematic::GetType(Schematic) == ESchematicType::EST_Tutorial ||
-            UFGSchematic::GetType(Schematic) == ESchematicType::EST_ResourceSink) &&
-            SchematicManager->CanGiveAccessToSchematic(Schematic)) {
+        if (ShouldSchematicBeAvailable(SchematicManager, Schematic)) {
             SchematicManager->mAvailableSchematics.Add(Schematic);
         }
     }
+
+    if (GVerifyIncrementalManagerFlush && !bRebuildAvailableSchematics) {
+        VerifySchematicManagerState(SchematicManager);
+    }
 }
 
-void AModContentRegistry::FlushStateToResearchManager(AFGResearchManager* ResearchManager) const {
-    const TArray<TSharedPtr<FResearchTreeRegistrationInfo>> RegisteredResearchTrees = ResearchTreeRegistryState.GetAllObjects();
+/** Unlocks research tree in the research manager if it is not unlocked yet and all of its unlock dependencies are met */
+static void UnlockResearchTreeIfDependenciesMet(AFGResearchManager* ResearchManager, TSubclassOf<UFGResearchTree> ResearchTree) {
+    if (ResearchManager->mUnlockedResearchTrees.Contains(ResearchTree)) {
+        return;
+    }
+    for (UFGAvailabilityDependency* Dependency : UFGResearchTree::GetUnlockDependencies(ResearchTree)) {
+        if (Dependency != NULL && !Dependency->AreDependenciesMet(ResearchManager)) {
+            return;
+        }
+    }
+    ResearchManager->UnlockResearchTree(ResearchTree);
+}
 
-    //Empty lists while maintaining enough capacity to re-populate it later
-    ResearchManager->mAvailableResearchTrees.Empty(RegisteredResearchTrees.Num());
+void AModContentRegistry::FlushStateToResearchManager(AFGResearchManager* ResearchManager, int64 FlushedRegistrationCounter) const {
+    if (FlushedRegistrationCounter < 0) {
+        //Empty lists while maintaining enough capacity to re-populate it later
+        ResearchManager->mAvailableResearchTrees.Empty(ResearchTreeRegistryState.GetAllObjects().Num());
+    }
 
-    for (const TSharedPtr<FResearchTreeRegistrationInfo>& RegistrationInfo : RegisteredResearchTrees) {
+    const TArrayView<const TSharedPtr<FResearchTreeRegistrationInfo>> NewResearchTrees = ResearchTreeRegistryState.GetObjectsRegisteredSince(FlushedRegistrationCounter);
+    for (const TSharedPtr<FResearchTreeRegistrationInfo>& RegistrationInfo : NewResearchTrees) {
         TSubclassOf<UFGResearchTree> ResearchTree = RegistrationInfo->RegisteredObject;
         ResearchManager->mAvailableResearchTrees.Add(ResearchTree);
     }
-    //Update unlocked research trees
-    ResearchManager->UpdateUnlockedResearchTrees();
+
+    if (FlushedRegistrationCounter < 0) {
+        //Update unlocked research trees
+        ResearchManager->UpdateUnlockedResearchTrees();
+        return;
+    }
+    if (GVerifyIncrementalManagerFlush) {
+        VerifyResearchManagerState(ResearchManager);
+    }
+    //Unlock state of the research trees flushed earlier has not changed, so only the new ones might have to be unlocked now.
+    //Same as UpdateUnlockedResearchTrees, it is only done on the authority, clients receive unlocked trees through replication
+    if (ResearchManager->HasAuthority()) {
+        for (const TSharedPtr<FResearchTreeRegistrationInfo>& RegistrationInfo : NewResearchTrees) {
+            UnlockResearchTreeIfDependenciesMet(ResearchManager, RegistrationInfo->RegisteredObject);
+        }
+    }
+}
+
+void AModContentRegistry::VerifySchematicManagerState(AFGSchematicManager* SchematicManager) const {
+    TArray<TSubclassOf<UFGSchematic>> ExpectedAllSchematics;
+    TArray<TSubclassOf<UFGSchematic>> ExpectedAvailableSchematics;
+    for (const TSharedPtr<FSchematicRegistrationInfo>& RegistrationInfo : SchematicRegistryState.GetAllObjects()) {
+        ExpectedAllSchematics.Add(RegistrationInfo->RegisteredObject);
+        if (ShouldSchematicBeAvailable(SchematicManager, RegistrationInfo->RegisteredObject)) {
+            ExpectedAvailableSchematics.Add(RegistrationInfo->RegisteredObject);
+        }
+    }
+
+    if (SchematicManager->mAllSchematics != ExpectedAllSchematics || SchematicManager->mAvailableSchematics != ExpectedAvailableSchematics) {
+        UE_LOG(LogContentRegistry, Error, TEXT("Incremental schematic manager flush diverged from full rebuild: %d/%d schematics, %d/%d available schematics. Falling back to full rebuild"),
+            SchematicManager->mAllSchematics.Num(), ExpectedAllSchematics.Num(), SchematicManager->mAvailableSchematics.Num(), ExpectedAvailableSchematics.Num());
+        SchematicManager->mAllSchematics = ExpectedAllSchematics;
+        SchematicManager->mAvailableSchematics = ExpectedAvailableSchematics;
+    }
+}
+
+void AModContentRegistry::VerifyResearchManagerState(AFGResearchManager* ResearchManager) const {
+    TArray<TSubclassOf<UFGResearchTree>> ExpectedResearchTrees;
+    for (const TSharedPtr<FResearchTreeRegistrationInfo>& RegistrationInfo : ResearchTreeRegistryState.GetAllObjects()) {
+        ExpectedResearchTrees.Add(RegistrationInfo->RegisteredObject);
+    }
+
+    if (ResearchManager->mAvailableResearchTrees != ExpectedResearchTrees) {
+        UE_LOG(LogContentRegistry, Error, TEXT("Incremental research manager flush diverged from full rebuild: %d/%d research trees. Falling back to full rebuild"),
+            ResearchManager->mAvailableResearchTrees.Num(), ExpectedResearchTrees.Num());
+        ResearchManager->mAvailableResearchTrees = ExpectedResearchTrees;
+    }
 }
 
 void AModContentRegistry::SubscribeToSchematicManager(AFGSchematicManager* SchematicManager) {
@@ -185,24 +494,80 @@ void AModContentRegistry::Init() {
     const FName FactoryGame = FACTORYGAME_MOD_NAME;
 
     UE_LOG(LogContentRegistry, Display, TEXT("Initializing mod content registry"));
-    const TArray<TSubclassOf<UFGSchematic>> AllSchematics = DiscoverVanillaContentOfType<UFGSchematic>();
-    const TArray<TSubclassOf<UFGResearchTree>> AllResearchTrees = DiscoverVanillaContentOfType<UFGResearchTree>();
+    TArray<TSubclassOf<UFGSchematic>> LoadedSchematics;
+    TArray<TSubclassOf<UFGResearchTree>> LoadedResearchTrees;
+    TArray<FSoftObjectPath> PendingContent;
+    DiscoverVanillaContentOfType<UFGSchematic>(LoadedSchematics, PendingContent);
+    DiscoverVanillaContentOfType<UFGResearchTree>(LoadedResearchTrees, PendingContent);
+
+    //Request the rest of the content to be streamed in. Most of it has been streaming in since the world was created already
+    if (PendingContent.Num()) {
+        VanillaContentStreamHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(PendingContent,
+            FStreamableDelegate::CreateUObject(this, &AModContentRegistry::OnVanillaContentStreamed), FStreamableManager::AsyncLoadHighPriority);
+    }
 
     //Start registering vanilla content now
     GIsRegisteringVanillaContent = true;
     
-    for (const TSubclassOf<UFGSchematic>& Schematic : AllSchematics) {
-        RegisterSchematic(FactoryGame, Schematic);
+    RegisterContentBatch(FactoryGame, LoadedSchematics, LoadedResearchTrees);
+
+    //Stop registering vanilla content at this point
+    GIsRegisteringVanillaContent = false;
+}
+
+TSharedPtr<FStreamableHandle> AModContentRegistry::StreamVanillaContentInAdvance() {
+    TArray<TSubclassOf<UFGSchematic>> LoadedSchematics;
+    TArray<TSubclassOf<UFGResearchTree>> LoadedResearchTrees;
+    TArray<FSoftObjectPath> PendingContent;
+    DiscoverVanillaContentOfType<UFGSchematic>(LoadedSchematics, PendingContent);
+    DiscoverVanillaContentOfType<UFGResearchTree>(LoadedResearchTrees, PendingContent);
+
+    //Registry requests the same content again in Init, which just joins the requests that are still in flight
+    if (PendingContent.Num() == 0) {
+        return NULL;
     }
-    
-    for (const TSubclassOf<UFGResearchTree>& ResearchTree : AllResearchTrees) {
-        RegisterResearchTree(FactoryGame, ResearchTree);
+    return UAssetManager::GetStreamableManager().RequestAsyncLoad(PendingContent, FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+}
+
+void AModContentRegistry::OnVanillaContentStreamed() {
+    //Content could have been registered already if we had to wait for it synchronously
+    if (!VanillaContentStreamHandle.IsValid()) {
+        return;
+    }
+    TArray<UObject*> LoadedAssets;
+    VanillaContentStreamHandle->GetLoadedAssets(LoadedAssets);
+
+    TArray<TSubclassOf<UFGSchematic>> LoadedSchematics;
+    TArray<TSubclassOf<UFGResearchTree>> LoadedResearchTrees;
+    for (UObject* LoadedAsset : LoadedAssets) {
+        UClass* LoadedClass = Cast<UClass>(LoadedAsset);
+        if (LoadedClass == NULL) {
+            continue;
+        }
+        if (LoadedClass->IsChildOf(UFGSchematic::StaticClass())) {
+            LoadedSchematics.Add(LoadedClass);
+        } else if (LoadedClass->IsChildOf(UFGResearchTree::StaticClass())) {
+            LoadedResearchTrees.Add(LoadedClass);
+        }
     }
 
-    //Stop registering vanilla content at this point
+    //Registry will keep classes referenced from now on, so the handle can be released
+    VanillaContentStreamHandle.Reset();
+    
+    GIsRegisteringVanillaContent = true;
+    RegisterContentBatch(FACTORYGAME_MOD_NAME, LoadedSchematics, LoadedResearchTrees);
     GIsRegisteringVanillaContent = false;
 }
 
+void AModContentRegistry::WaitForVanillaContentDiscovery() {
+    if (VanillaContentStreamHandle.IsValid()) {
+        UE_LOG(LogContentRegistry, Display, TEXT("Waiting for vanilla content streaming to finish"));
+        VanillaContentStreamHandle->WaitUntilComplete();
+        //Completion delegate is only dispatched on the next tick, so register streamed content right away
+        OnVanillaContentStreamed();
+    }
+}
+
 void AModContentRegistry::FreezeRegistryState() {
     checkf(!bIsRegistryFrozen, TEXT("Attempt to re-freeze already frozen registry"));
 
@@ -269,28 +634,58 @@ void AModContentRegistry::OnSchematicPurchased(TSubclassOf<UFGSchematic> Schemat
 }
 
 void AModContentRegistry::MarkItemDescriptorsFromRecipe(const TSubclassOf<UFGRecipe>& Recipe, const FName ModReference) {
-	TArray<FItemAmount> AllReferencedItems;
-	AllReferencedItems.Append(UFGRecipe::GetIngredients(Recipe));
-	AllReferencedItems.Append(UFGRecipe::GetProducts(Recipe));
+	//Ingredients come first, followed by the recipe products
+	TArray<TSubclassOf<UFGItemDescriptor>> AllReferencedItems;
+	int32 NumIngredients;
+	const FContentDependencyInfo* Dependencies = PrefetchedDependencies.Find(Recipe);
+	if (Dependencies != NULL) {
+		CopyPrefetchedReferences(*Dependencies, AllReferencedItems);
+		NumIngredients = Dependencies->NumIngredients;
+	} else {
+		for (const FItemAmount& ItemAmount : UFGRecipe::GetIngredients(Recipe)) {
+			AllReferencedItems.Add(ItemAmount.ItemClass);
+		}
+		NumIngredients = AllReferencedItems.Num();
+		for (const FItemAmount& ItemAmount : UFGRecipe::GetProducts(Recipe)) {
+			AllReferencedItems.Add(ItemAmount.ItemClass);
+		}
+	}
+
+	//This is only called once for each recipe, right after it has been registered, so the only duplicates
+	//we can encounter are items listed multiple times in this recipe. Tracking them in a set avoids linear
+	//ReferencedBy scans, which are quadratic for items referenced by lots of recipes
+	TSet<UClass*, DefaultKeyFuncs<UClass*>, TInlineSetAllocator<16>> ProcessedItems;
 
-	for (const FItemAmount& ItemAmount : AllReferencedItems) {
-		const TSubclassOf<UFGItemDescriptor>& ItemDescriptor = ItemAmount.ItemClass;
+	for (int32 i = 0; i < AllReferencedItems.Num(); i++) {
+		const TSubclassOf<UFGItemDescriptor>& ItemDescriptor = AllReferencedItems[i];
 
 		CHECK_PROVIDED_OBJECT_VALID(ItemDescriptor, TEXT("Recipe '%s' registered by %s contains invalid NULL ItemDescriptor in it's Ingredients or Results"),
 				*Recipe->GetPathName(), *ModReference.ToString());
     	
 		TSharedPtr<FItemRegistrationInfo> ItemRegistrationInfo = ItemRegistryState.FindObject(ItemDescriptor);
 		if (!ItemRegistrationInfo.IsValid()) {        	
-			const FName OwnerModReference = FindContentOwnerFast(ItemDescriptor);
+			const FName OwnerModReference = FindContentOwner(ItemDescriptor);
 			ItemRegistrationInfo = RegisterItemDescriptor(OwnerModReference, ModReference, ItemDescriptor);
 		}
-		//Associate item registration info with this recipe
-		ItemRegistrationInfo->ReferencedBy.AddUnique(Recipe);
+		//Associate item registration info with this recipe. ReferencedBy keeps registration order for deterministic serialization
+		bool bIsAlreadyProcessed = false;
+		ProcessedItems.Add(ItemDescriptor, &bIsAlreadyProcessed);
+		if (!bIsAlreadyProcessed) {
+			ItemRegistrationInfo->ReferencedBy.Add(Recipe);
+		}
+
+		//If item is listed twice on the same side of the recipe, recipe will be the last entry of the index already
+		TArray<TSubclassOf<UFGRecipe>>& IndexedRecipes = (i < NumIngredients ? RecipesByConsumedItem : RecipesByProducedItem).FindOrAdd(ItemDescriptor);
+		if (IndexedRecipes.Num() == 0 || IndexedRecipes.Last() != Recipe) {
+			IndexedRecipes.Add(Recipe);
+		}
 	}
 }
 
 void AModContentRegistry::MarkCustomizationRecipeFromRecipe(const TSubclassOf<UFGRecipe>& Recipe, const FName ModReference) {
-	TSubclassOf<UFGCustomizationRecipe> CustomizationRecipe = UFGRecipe::GetMaterialCustomizationRecipe(Recipe);
+	const FContentDependencyInfo* Dependencies = PrefetchedDependencies.Find(Recipe);
+	const TSubclassOf<UFGCustomizationRecipe> CustomizationRecipe = Dependencies != NULL ?
+		Dependencies->CustomizationRecipe : UFGRecipe::GetMaterialCustomizationRecipe(Recipe);
 
 	if (IsValid(CustomizationRecipe)) {
 		RegisterRecipe(ModReference, CustomizationRecipe);
@@ -299,19 +694,22 @@ void AModContentRegistry::MarkCustomizationRecipeFromRecipe(const TSubclassOf<UF
 
 TSharedPtr<FItemRegistrationInfo> AModContentRegistry::RegisterItemDescriptor(const FName OwnerModReference, const FName RegistrarModReference, const TSubclassOf<UFGItemDescriptor>& ItemDescriptor) {
 	checkf(ItemDescriptor, TEXT("Attempt to register NULL ItemDescriptor, mod reference: %s"), *RegistrarModReference.ToString());
+	//Registration paths are where the content loaded by mods and vanilla content discovery becomes known to us
+	InvalidateLoadedItemDescriptorsCache();
 	return ItemRegistryState.RegisterObject(MakeRegistrationInfo<FItemRegistrationInfo>(ItemDescriptor, OwnerModReference, RegistrarModReference));
 }
 
 void AModContentRegistry::FindMissingSchematics(AFGSchematicManager* SchematicManager,
                                                 TArray<FMissingObjectStruct>& MissingObjects) const {
     //Clear references to unlocked schematics if they are not registered
-    TArray<TSubclassOf<UFGSchematic>> PurchasedSchematics = SchematicManager->mPurchasedSchematics;
-    for (const TSubclassOf<UFGSchematic> Schematic : PurchasedSchematics) {
+    //RemoveAll compacts the array in a single pass and keeps order of the remaining entries intact
+    SchematicManager->mPurchasedSchematics.RemoveAll([&](const TSubclassOf<UFGSchematic>& Schematic) {
         if (!IsSchematicRegistered(Schematic)) {
             MissingObjects.Add(FMissingObjectStruct{TEXT("schematic"), Schematic->GetPathName()});
-            SchematicManager->mPurchasedSchematics.Remove(Schematic);
+            return true;
         }
-    }
+        return false;
+    });
     //Do same thing for incomplete schematic progress
     SchematicManager->mPaidOffSchematic.RemoveAll([&](const FSchematicCost& SchematicCost) {
         return !IsSchematicRegistered(SchematicCost.Schematic);
@@ -321,13 +719,13 @@ void AModContentRegistry::FindMissingSchematics(AFGSchematicManager* SchematicMa
 void AModContentRegistry::FindMissingResearchTrees(AFGResearchManager* ResearchManager,
                                                    TArray<FMissingObjectStruct>& MissingObjects) const {
     //Clear unlocked research trees
-    TArray<TSubclassOf<UFGResearchTree>> UnlockedResearchTrees = ResearchManager->mUnlockedResearchTrees;
-    for (const TSubclassOf<UFGResearchTree>& ResearchTree : UnlockedResearchTrees) {
+    ResearchManager->mUnlockedResearchTrees.RemoveAll([&](const TSubclassOf<UFGResearchTree>& ResearchTree) {
         if (!IsResearchTreeRegistered(ResearchTree)) {
-            ResearchManager->mUnlockedResearchTrees.Remove(ResearchTree);
             MissingObjects.Add(FMissingObjectStruct{TEXT("research_tree"), ResearchTree->GetPathName()});
+            return true;
         }
-    }
+        return false;
+    });
     
     //Clear completed, but unclaimed researches
     ResearchManager->mCompletedResearch.RemoveAll([&](const FResearchData& ResearchData) {
@@ -345,13 +743,13 @@ void AModContentRegistry::FindMissingResearchTrees(AFGResearchManager* ResearchM
 void AModContentRegistry::FindMissingRecipes(AFGRecipeManager* RecipeManager,
                                              TArray<FMissingObjectStruct>& MissingObjects) const {
     //Clear unlocked recipes
-    TArray<TSubclassOf<UFGRecipe>> UnlockedRecipes = RecipeManager->mAvailableRecipes;
-    for (const TSubclassOf<UFGRecipe>& Recipe : UnlockedRecipes) {
+    RecipeManager->mAvailableRecipes.RemoveAll([&](const TSubclassOf<UFGRecipe>& Recipe) {
         if (!IsRecipeRegistered(Recipe)) {
-            RecipeManager->mAvailableRecipes.Remove(Recipe);
             MissingObjects.Add(FMissingObjectStruct{TEXT("recipe"), Recipe->GetPathName()});
+            return true;
         }
-    }
+        return false;
+    });
 }
 
 void AModContentRegistry::WarnAboutMissingObjects(const TArray<FMissingObjectStruct>& MissingObjects) {
@@ -380,13 +778,18 @@ void AModContentRegistry::RegisterSchematic(const FName ModReference, const TSub
         EnsureRegistryUnfrozen();
 
         //Create registration entry and register
-        const FName OwnerModReference = FindContentOwnerFast(Schematic);
+        const FName OwnerModReference = FindContentOwner(Schematic);
         const TSharedPtr<FSchematicRegistrationInfo> RegistrationInfo = SchematicRegistryState.RegisterObject(
             MakeRegistrationInfo<FSchematicRegistrationInfo>(Schematic, OwnerModReference, ModReference));
 
         //Register referenced recipes automatically and associate schematic with them
         TArray<TSubclassOf<UFGRecipe>> OutReferencedRecipes;
-        ExtractRecipesFromSchematic(Schematic, OutReferencedRecipes);
+        const FContentDependencyInfo* Dependencies = PrefetchedDependencies.Find(Schematic);
+        if (Dependencies != NULL) {
+            CopyPrefetchedReferences(*Dependencies, OutReferencedRecipes);
+        } else {
+            ExtractRecipesFromSchematic(Schematic, OutReferencedRecipes);
+        }
 
     	for (const TSubclassOf<UFGRecipe>& Recipe : OutReferencedRecipes) {
     		CHECK_PROVIDED_OBJECT_VALID(Recipe, TEXT("Schematic '%s' registered by %s references invalid NULL Recipe in it's Unlocks Array"),
@@ -409,13 +812,18 @@ void AModContentRegistry::RegisterResearchTree(const FName ModReference, const T
         EnsureRegistryUnfrozen();
 
         //Create registration entry and register
-        const FName OwnerModReference = FindContentOwnerFast(ResearchTree);
+        const FName OwnerModReference = FindContentOwner(ResearchTree);
         const TSharedPtr<FResearchTreeRegistrationInfo> RegistrationInfo = ResearchTreeRegistryState.RegisterObject(
             MakeRegistrationInfo<FResearchTreeRegistrationInfo>(ResearchTree, OwnerModReference, ModReference));
         
         //Register referenced schematics automatically and associate research tree with them
         TArray<TSubclassOf<UFGSchematic>> OutReferencedSchematics;
-        ExtractSchematicsFromResearchTree(ResearchTree, OutReferencedSchematics);
+        const FContentDependencyInfo* Dependencies = PrefetchedDependencies.Find(ResearchTree);
+        if (Dependencies != NULL) {
+            CopyPrefetchedReferences(*Dependencies, OutReferencedSchematics);
+        } else {
+            ExtractSchematicsFromResearchTree(ResearchTree, OutReferencedSchematics);
+        }
     	
         for (const TSubclassOf<UFGSchematic>& Schematic : OutReferencedSchematics) {
         	CHECK_PROVIDED_OBJECT_VALID(Schematic, TEXT("ResearchTree '%s' registered by %s references invalid NULL Schematic in one of it's Nodes"),
@@ -438,7 +846,7 @@ void AModContentRegistry::RegisterRecipe(const FName ModReference, const TSubcla
         EnsureRegistryUnfrozen();
         
         //Create registration entry and register
-        const FName OwnerModReference = FindContentOwnerFast(Recipe);
+        const FName OwnerModReference = FindContentOwner(Recipe);
         const TSharedPtr<FRecipeRegistrationInfo> RegistrationInfo = RecipeRegistryState.RegisterObject(
             MakeRegistrationInfo<FRecipeRegistrationInfo>(Recipe, OwnerModReference, ModReference));
 
@@ -464,22 +872,66 @@ void AModContentRegistry::RegisterResourceSinkItemPointTable(FName ModReference,
 	FlushPendingResourceSinkRegistrations();
 }
 
-TArray<FItemRegistrationInfo> AModContentRegistry::GetLoadedItemDescriptors() {
+void AModContentRegistry::InvalidateLoadedItemDescriptorsCache() {
+    bLoadedItemDescriptorsCacheValid = false;
+}
+
+TArrayView<const TSharedPtr<FItemRegistrationInfo>> AModContentRegistry::GetLoadedItemDescriptorsView() {
+    //Engine bumps registered classes version whenever any class is loaded, created or destroyed, including the item descriptors
+    //loaded without being registered with us, in both editor and cooked builds. Reading it is a single atomic load
+    const uint64 CurrentClassesVersion = GetRegisteredClassesVersionNumber();
+    if (bLoadedItemDescriptorsCacheValid && LoadedItemDescriptorsCacheClassesVersion == CurrentClassesVersion) {
+        return LoadedItemDescriptorsCache;
+    }
+    
     //Since we don't have consistent registry, we have to iterate all loaded classes and generate information from them
     //We also keep all referenced classes loaded, so they will be included there too
-    TArray<FItemRegistrationInfo> OutRegistrationInfo;
+    LoadedItemDescriptorsCache.Reset();
+    bool bEncounteredLoadingClasses = false;
     
     UClass* ItemDescriptorClass = UFGItemDescriptor::StaticClass();
     ForEachObjectOfClass(UClass::StaticClass(), [&](UObject* LoadedClassObject) {
         UClass* Class = Cast<UClass>(LoadedClassObject);
+        //Classes that are still being loaded might not have their super class set yet, so we cannot trust IsChildOf for them
+        if (Class->HasAnyFlags(RF_NeedLoad)) {
+            bEncounteredLoadingClasses = true;
+            return;
+        }
         if (Class->IsChildOf(ItemDescriptorClass)) {
             const TSubclassOf<UFGItemDescriptor> ItemDescriptor = Class;
-            OutRegistrationInfo.Add(GetItemDescriptorInfo(ItemDescriptor));
+            //Registering item descriptor keeps it loaded, so cached entries cannot become stale
+            GetItemDescriptorInfo(ItemDescriptor);
+            LoadedItemDescriptorsCache.Add(ItemRegistryState.FindObject(ItemDescriptor));
         }
     });
+    
+    //Leave cache invalidated until classes finish loading. Registering descriptors above invalidates it too, so it is only marked valid here
+    bLoadedItemDescriptorsCacheValid = !bEncounteredLoadingClasses;
+    LoadedItemDescriptorsCacheClassesVersion = CurrentClassesVersion;
+    return LoadedItemDescriptorsCache;
+}
+
+TArray<FItemRegistrationInfo> AModContentRegistry::GetLoadedItemDescriptors() {
+    const TArrayView<const TSharedPtr<FItemRegistrationInfo>> LoadedItemDescriptors = GetLoadedItemDescriptorsView();
+    
+    TArray<FItemRegistrationInfo> OutRegistrationInfo;
+    OutRegistrationInfo.Reserve(LoadedItemDescriptors.Num());
+    for (const TSharedPtr<FItemRegistrationInfo>& RegistrationInfo : LoadedItemDescriptors) {
+        OutRegistrationInfo.Add(*RegistrationInfo);
+    }
     return OutRegistrationInfo;
 }
 
+TArrayView<const TSubclassOf<UFGRecipe>> AModContentRegistry::GetRecipesProducingItem(const TSubclassOf<UFGItemDescriptor> ItemDescriptor) const {
+    const TArray<TSubclassOf<UFGRecipe>>* Recipes = RecipesByProducedItem.Find(ItemDescriptor);
+    return Recipes ? TArrayView<const TSubclassOf<UFGRecipe>>(*Recipes) : TArrayView<const TSubclassOf<UFGRecipe>>();
+}
+
+TArrayView<const TSubclassOf<UFGRecipe>> AModContentRegistry::GetRecipesConsumingItem(const TSubclassOf<UFGItemDescriptor> ItemDescriptor) const {
+    const TArray<TSubclassOf<UFGRecipe>>* Recipes = RecipesByConsumedItem.Find(ItemDescriptor);
+    return Recipes ? TArrayView<const TSubclassOf<UFGRecipe>>(*Recipes) : TArrayView<const TSubclassOf<UFGRecipe>>();
+}
+
 TArray<FItemRegistrationInfo> AModContentRegistry::GetObtainableItemDescriptors() const {
     //All obtainable item descriptors are guaranteed to be present in ItemDescriptorRegistrationList,
     //So we can just iterate it and filter item descriptors without associated recipes out
@@ -514,6 +966,9 @@ AModContentRegistry::AModContentRegistry() {
     bIsRegistryFrozen = false;
     SchematicManagerInternalState = -1;
     ResearchManagerInternalState = -1;
+    SchematicManagerPurchasedSchematicCount = INDEX_NONE;
+    bLoadedItemDescriptorsCacheValid = false;
+    LoadedItemDescriptorsCacheClassesVersion = 0;
     bSubscribedToSchematicManager = false;
     PrimaryActorTick.bCanEverTick = true;
 	ActiveScriptFramePtr = NULL;
@@ -560,8 +1015,12 @@ void AModContentRegistry::Tick(float DeltaSeconds) {
         const int64 SchematicRegistryCounter = SchematicRegistryState.GetRegistrationCounter();
         
         if (SchematicRegistryCounter > SchematicManagerInternalState) {
-            FlushStateToSchematicManager(SchematicManager);
+            //Purchasing schematics is what satisfies dependencies of the other schematics, so it is what changes their availability
+            const int32 PurchasedSchematicCount = SchematicManager->mPurchasedSchematics.Num();
+            const bool bUnlockStateChanged = PurchasedSchematicCount != SchematicManagerPurchasedSchematicCount;
+            FlushStateToSchematicManager(SchematicManager, SchematicManagerInternalState, bUnlockStateChanged);
             SchematicManagerInternalState = SchematicRegistryCounter;
+            SchematicManagerPurchasedSchematicCount = PurchasedSchematicCount;
         }
 
         if (!bSubscribedToSchematicManager) {
@@ -574,7 +1033,7 @@ void AModContentRegistry::Tick(float DeltaSeconds) {
         const int64 ResearchTreeRegistryCounter = ResearchTreeRegistryState.GetRegistrationCounter();
         
         if (ResearchTreeRegistryCounter > ResearchManagerInternalState) {
-            FlushStateToResearchManager(ResearchManager);
+            FlushStateToResearchManager(ResearchManager, ResearchManagerInternalState);
             ResearchManagerInternalState = ResearchTreeRegistryCounter;
         }
     }
@@ -4,7 +4,11 @@
 FSMLConfiguration::FSMLConfiguration() :
     bDevelopmentMode(false),
     bConsoleWindow(false),
-    bEnableCheatConsoleCommands(false) {
+    bEnableCheatConsoleCommands(false),
+    bEnableConfigBinaryCache(true),
+    MaxModMessagesPerSecond(0),
+    MaxModMessageBytesPerSecond(0),
+    NetworkStatisticsLogInterval(0.0f) {
 }
 
 void FSMLConfiguration::ReadFromJson(const TSharedPtr<FJsonObject>& Json, FSMLConfiguration& OutConfiguration, bool* OutIsMissingSections) {
@@ -28,6 +32,30 @@ void FSMLConfiguration::ReadFromJson(const TSharedPtr<FJsonObject>& Json, FSMLCo
         bIsMissingSectionsInternal = true;
     }
     
+    if (Json->HasTypedField<EJson::Boolean>(TEXT("enableConfigBinaryCache"))) {
+        OutConfiguration.bEnableConfigBinaryCache = Json->GetBoolField(TEXT("enableConfigBinaryCache"));
+    } else {
+        bIsMissingSectionsInternal = true;
+    }
+    
+    if (Json->HasTypedField<EJson::Number>(TEXT("maxModMessagesPerSecond"))) {
+        OutConfiguration.MaxModMessagesPerSecond = Json->GetIntegerField(TEXT("maxModMessagesPerSecond"));
+    } else {
+        bIsMissingSectionsInternal = true;
+    }
+    
+    if (Json->HasTypedField<EJson::Number>(TEXT("maxModMessageBytesPerSecond"))) {
+        OutConfiguration.MaxModMessageBytesPerSecond = Json->GetIntegerField(TEXT("maxModMessageBytesPerSecond"));
+    } else {
+        bIsMissingSectionsInternal = true;
+    }
+    
+    if (Json->HasTypedField<EJson::Number>(TEXT("networkStatisticsLogInterval"))) {
+        OutConfiguration.NetworkStatisticsLogInterval = Json->GetNumberField(TEXT("networkStatisticsLogInterval"));
+    } else {
+        bIsMissingSectionsInternal = true;
+    }
+    
     if (Json->HasTypedField<EJson::Array>(TEXT("disabledChatCommands"))) {
         const TArray<TSharedPtr<FJsonValue>>& DisabledChatCommands = Json->GetArrayField(TEXT("disabledChatCommands"));
         for (const TSharedPtr<FJsonValue>& Value : DisabledChatCommands) {
@@ -47,6 +75,10 @@ void FSMLConfiguration::WriteToJson(const TSharedPtr<FJsonObject>& OutJson, cons
     OutJson->SetBoolField(TEXT("developmentMode"), Configuration.bDevelopmentMode);
     OutJson->SetBoolField(TEXT("consoleWindow"), Configuration.bConsoleWindow);
     OutJson->SetBoolField(TEXT("enableCheatConsoleCommands"), Configuration.bEnableCheatConsoleCommands);
+    OutJson->SetBoolField(TEXT("enableConfigBinaryCache"), Configuration.bEnableConfigBinaryCache);
+    OutJson->SetNumberField(TEXT("maxModMessagesPerSecond"), Configuration.MaxModMessagesPerSecond);
+    OutJson->SetNumberField(TEXT("maxModMessageBytesPerSecond"), Configuration.MaxModMessageBytesPerSecond);
+    OutJson->SetNumberField(TEXT("networkStatisticsLogInterval"), Configuration.NetworkStatisticsLogInterval);
 
     TArray<TSharedPtr<FJsonValue>> DisabledChatCommands;
     for (const FString& Value : Configuration.DisabledChatCommands) {
@@ -1,7 +1,11 @@
 #include "SMLModule.h"
 #include "SatisfactoryModLoader.h"
+#include "Patching/NativeHookManager.h"
 
 void FSMLModule::StartupModule() {
+	//Start reclaiming memory of the replaced hook handlers and uninstalled hooks
+	FNativeHookManagerInternal::Initialize();
+
 	//Basic subsystems like logging are initialized on OnInit
 	FSatisfactoryModLoader::PreInitializeModLoading();
         
@@ -10,6 +14,7 @@ void FSMLModule::StartupModule() {
 }
 
 void FSMLModule::ShutdownModule() {
+	FNativeHookManagerInternal::Shutdown();
 }
 
 IMPLEMENT_GAME_MODULE(FSMLModule, SML);
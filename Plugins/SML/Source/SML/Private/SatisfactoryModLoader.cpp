@@ -12,6 +12,7 @@
 #include "Patching/Patch/OfflinePlayerHandler.h"
 #include "Patching/Patch/OptionsKeybindPatch.h"
 #include "Player/PlayerCheatManagerHandler.h"
+#include "Patching/NativeHookManager.h"
 // #include "Toolkit/OldToolkit/FGNativeClassDumper.h"
 
 #ifndef SML_BUILD_METADATA
@@ -164,6 +165,9 @@ void FSatisfactoryModLoader::PreInitializeModLoading() {
 void FSatisfactoryModLoader::InitializeModLoading() {
     UE_LOG(LogSatisfactoryModLoader, Display, TEXT("Performing mod loader initialization"));
 
+    //Queue hooks registered during initialization so they are installed in a single batch
+    FNativeHookManagerInternal::BeginHookTransaction();
+
     //Install patches, but only do it in shipping for now because most of them involve FactoryGame code and
     //we currently do not have FG code available in the editor
     if (FPlatformProperties::RequiresCookedData()) {
@@ -175,5 +179,8 @@ void FSatisfactoryModLoader::InitializeModLoading() {
     UE_LOG(LogSatisfactoryModLoader, Display, TEXT("Registering global subsystems..."));
     RegisterSubsystems();
 
+    UE_LOG(LogSatisfactoryModLoader, Display, TEXT("Installing queued hooks..."));
+    FNativeHookManagerInternal::CommitHookTransaction();
+
     UE_LOG(LogSatisfactoryModLoader, Display, TEXT("Initialization finished!"));
 }
@@ -0,0 +1,192 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Configuration/RawFileFormat/Binary/BinaryRawFormatConverter.h"
+#include "Configuration/RawFileFormat/RawFormatValueArray.h"
+#include "Configuration/RawFileFormat/RawFormatValueBool.h"
+#include "Configuration/RawFileFormat/RawFormatValueNumber.h"
+#include "Configuration/RawFileFormat/RawFormatValueObject.h"
+#include "Configuration/RawFileFormat/RawFormatValueString.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static FString MakeRandomString(FRandomStream& RandomStream) {
+    FString String;
+    const int32 Length = RandomStream.RandRange(0, 24);
+    for (int32 i = 0; i < Length; i++) {
+        //Mostly printable ASCII, with occasional characters outside of it
+        String.AppendChar(RandomStream.RandRange(0, 7) == 0 ? (TCHAR) RandomStream.RandRange(0x80, 0xD7FF) : (TCHAR) RandomStream.RandRange(0x20, 0x7E));
+    }
+    return String;
+}
+
+/** Fills container value with random children, containers are only generated until the maximum depth is reached */
+static void FillRandomValue(URawFormatValue* Value, FRandomStream& RandomStream, int32 Depth) {
+    URawFormatValueArray* Array = Cast<URawFormatValueArray>(Value);
+    URawFormatValueObject* Object = Cast<URawFormatValueObject>(Value);
+    const int32 NumChildren = Array || Object ? RandomStream.RandRange(0, 6) : 0;
+
+    for (int32 i = 0; i < NumChildren; i++) {
+        const int32 MaxValueType = Depth < 4 ? 4 : 2;
+        const int32 ValueType = RandomStream.RandRange(0, MaxValueType);
+        TSubclassOf<URawFormatValue> ValueClass = ValueType == 0 ? URawFormatValueNumber::StaticClass() :
+            ValueType == 1 ? URawFormatValueString::StaticClass() :
+            ValueType == 2 ? URawFormatValueBool::StaticClass() :
+            ValueType == 3 ? URawFormatValueArray::StaticClass() : URawFormatValueObject::StaticClass();
+
+        URawFormatValue* ChildValue = Array ? Array->AddNewValue(ValueClass) : Object->AddNewValue(MakeRandomString(RandomStream), ValueClass);
+        if (URawFormatValueNumber* Number = Cast<URawFormatValueNumber>(ChildValue)) {
+            Number->Value = RandomStream.RandRange(0, 1) ? (double) RandomStream.RandRange(-100000, 100000) : RandomStream.FRandRange(-1e9f, 1e9f);
+        } else if (URawFormatValueString* String = Cast<URawFormatValueString>(ChildValue)) {
+            String->Value = MakeRandomString(RandomStream);
+        } else if (URawFormatValueBool* Boolean = Cast<URawFormatValueBool>(ChildValue)) {
+            Boolean->Value = RandomStream.RandRange(0, 1) != 0;
+        } else {
+            FillRandomValue(ChildValue, RandomStream, Depth + 1);
+        }
+    }
+}
+
+/** Compares two raw format values recursively, including the order of array elements and object keys */
+static bool AreRawValuesEqual(const URawFormatValue* A, const URawFormatValue* B) {
+    if (A == NULL || B == NULL || A->GetClass() != B->GetClass()) {
+        return false;
+    }
+    if (const URawFormatValueNumber* Number = Cast<URawFormatValueNumber>(A)) {
+        return Number->Value == CastChecked<URawFormatValueNumber>(B)->Value;
+    }
+    if (const URawFormatValueString* String = Cast<URawFormatValueString>(A)) {
+        return String->Value.Equals(CastChecked<URawFormatValueString>(B)->Value, ESearchCase::CaseSensitive);
+    }
+    if (const URawFormatValueBool* Boolean = Cast<URawFormatValueBool>(A)) {
+        return Boolean->Value == CastChecked<URawFormatValueBool>(B)->Value;
+    }
+    if (const URawFormatValueArray* Array = Cast<URawFormatValueArray>(A)) {
+        const TArray<URawFormatValue*>& ValuesA = Array->GetUnderlyingArrayRef();
+        const TArray<URawFormatValue*>& ValuesB = CastChecked<URawFormatValueArray>(B)->GetUnderlyingArrayRef();
+        if (ValuesA.Num() != ValuesB.Num()) {
+            return false;
+        }
+        for (int32 i = 0; i < ValuesA.Num(); i++) {
+            if (!AreRawValuesEqual(ValuesA[i], ValuesB[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    const TMap<FString, URawFormatValue*>& ValuesA = CastChecked<URawFormatValueObject>(A)->Values;
+    const TMap<FString, URawFormatValue*>& ValuesB = CastChecked<URawFormatValueObject>(B)->Values;
+    if (ValuesA.Num() != ValuesB.Num()) {
+        return false;
+    }
+    auto IteratorB = ValuesB.CreateConstIterator();
+    for (const TPair<FString, URawFormatValue*>& Pair : ValuesA) {
+        if (!Pair.Key.Equals(IteratorB.Key(), ESearchCase::CaseSensitive) || !AreRawValuesEqual(Pair.Value, IteratorB.Value())) {
+            return false;
+        }
+        ++IteratorB;
+    }
+    return true;
+}
+
+static FBinaryConfigCacheHeader MakeTestHeader() {
+    FBinaryConfigCacheHeader Header;
+    Header.SourceFileSize = 1234;
+    Header.SourceFileTimestamp = FDateTime(2021, 1, 1);
+    Header.SourceFileHash = 0xDEADBEEF;
+    Header.ModVersion = TEXT("1.2.3");
+    return Header;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBinaryRawFormatRoundTripTest, "SML.Configuration.BinaryRawFormat.RoundTrip",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBinaryRawFormatRoundTripTest::RunTest(const FString& Parameters) {
+    const int32 NumTrees = 200;
+    const FBinaryConfigCacheHeader Header = MakeTestHeader();
+    FRandomStream RandomStream(1337);
+
+    int32 NumMismatches = 0;
+    for (int32 i = 0; i < NumTrees; i++) {
+        URawFormatValueObject* RootValue = NewObject<URawFormatValueObject>(GetTransientPackage(), NAME_None, RF_Transient);
+        FillRandomValue(RootValue, RandomStream, 0);
+
+        TArray<uint8> BinaryData;
+        FBinaryRawFormatConverter::ConvertToBinary(RootValue, Header, BinaryData);
+        const URawFormatValue* DecodedValue = FBinaryRawFormatConverter::ConvertToRawFormat(GetTransientPackage(), BinaryData);
+
+        //Decoded value has to be identical to the original one, and encode back into exactly the same bytes
+        TArray<uint8> ReencodedData;
+        if (DecodedValue != NULL) {
+            FBinaryRawFormatConverter::ConvertToBinary(DecodedValue, Header, ReencodedData);
+        }
+        NumMismatches += !AreRawValuesEqual(RootValue, DecodedValue) || ReencodedData != BinaryData;
+    }
+    TestEqual(TEXT("Random trees not surviving the round trip"), NumMismatches, 0);
+
+    //Header is read back exactly as it has been written
+    TArray<uint8> BinaryData;
+    FBinaryRawFormatConverter::ConvertToBinary(NewObject<URawFormatValueObject>(GetTransientPackage(), NAME_None, RF_Transient), Header, BinaryData);
+    FBinaryConfigCacheHeader ReadHeader;
+    TestTrue(TEXT("Header is read"), FBinaryRawFormatConverter::ReadHeader(BinaryData, ReadHeader));
+    TestTrue(TEXT("Header matches the source file"), ReadHeader.MatchesSourceFile(Header));
+    TestEqual(TEXT("Header mod version"), ReadHeader.ModVersion, Header.ModVersion);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBinaryRawFormatFuzzTest, "SML.Configuration.BinaryRawFormat.Fuzz",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBinaryRawFormatFuzzTest::RunTest(const FString& Parameters) {
+    const int32 NumTrees = 20;
+    const int32 NumMutationsPerTree = 100;
+    const FBinaryConfigCacheHeader Header = MakeTestHeader();
+    FRandomStream RandomStream(7331);
+
+    int32 NumAcceptedTruncations = 0;
+    int32 NumAcceptedBitFlips = 0;
+    int32 NumBitFlips = 0;
+    for (int32 i = 0; i < NumTrees; i++) {
+        URawFormatValueObject* RootValue = NewObject<URawFormatValueObject>(GetTransientPackage(), NAME_None, RF_Transient);
+        FillRandomValue(RootValue, RandomStream, 0);
+        TArray<uint8> BinaryData;
+        FBinaryRawFormatConverter::ConvertToBinary(RootValue, Header, BinaryData);
+
+        //Every byte of the encoded tree is required, so any truncation has to be rejected
+        for (int32 j = 0; j < NumMutationsPerTree; j++) {
+            const int32 TruncatedSize = RandomStream.RandRange(0, BinaryData.Num() - 1);
+            const TArrayView<const uint8> TruncatedData(BinaryData.GetData(), TruncatedSize);
+            NumAcceptedTruncations += FBinaryRawFormatConverter::ConvertToRawFormat(GetTransientPackage(), TruncatedData) != NULL;
+        }
+
+        //Flipped bits can produce valid data, for example inside of the number or a string, but must never crash the reader
+        for (int32 j = 0; j < NumMutationsPerTree; j++) {
+            TArray<uint8> MutatedData = BinaryData;
+            const int32 NumFlippedBits = RandomStream.RandRange(1, 4);
+            for (int32 k = 0; k < NumFlippedBits; k++) {
+                MutatedData[RandomStream.RandRange(0, MutatedData.Num() - 1)] ^= 1 << RandomStream.RandRange(0, 7);
+            }
+            NumAcceptedBitFlips += FBinaryRawFormatConverter::ConvertToRawFormat(GetTransientPackage(), MutatedData) != NULL;
+            NumBitFlips++;
+        }
+    }
+    TestEqual(TEXT("Truncated data accepted by the reader"), NumAcceptedTruncations, 0);
+
+    //Random data and data with an inflated element count have to be rejected too
+    TArray<uint8> RandomData;
+    RandomData.SetNumUninitialized(4096);
+    for (uint8& Byte : RandomData) {
+        Byte = (uint8) RandomStream.RandRange(0, 255);
+    }
+    TestNull(TEXT("Random data is rejected"), FBinaryRawFormatConverter::ConvertToRawFormat(GetTransientPackage(), RandomData));
+
+    TArray<uint8> InflatedData;
+    FBinaryRawFormatConverter::ConvertToBinary(NewObject<URawFormatValueObject>(GetTransientPackage(), NAME_None, RF_Transient), Header, InflatedData);
+    const int32 InflatedCount = MAX_int32;
+    FMemory::Memcpy(InflatedData.GetData() + InflatedData.Num() - sizeof(int32), &InflatedCount, sizeof(int32));
+    TestNull(TEXT("Inflated object value count is rejected"), FBinaryRawFormatConverter::ConvertToRawFormat(GetTransientPackage(), InflatedData));
+
+    AddInfo(FString::Printf(TEXT("%d of %d bit flipped inputs decoded into valid values"), NumAcceptedBitFlips, NumBitFlips));
+    return true;
+}
+
+#endif
@@ -0,0 +1,132 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Configuration/ConfigManager.h"
+#include "Configuration/Properties/ConfigPropertyArray.h"
+#include "Configuration/Properties/ConfigPropertyInteger.h"
+#include "Configuration/Properties/ConfigPropertySection.h"
+#include "Configuration/Properties/ConfigPropertyString.h"
+#include "Configuration/RawFileFormat/Json/JsonRawFormatConverter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//Serializes JSON value the same way config manager writes it into the file
+static FString PrintJsonObject(const TSharedPtr<FJsonValue>& JsonValue) {
+    FString OutputString;
+    const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&OutputString);
+    FJsonSerializer::Serialize(JsonValue->AsObject().ToSharedRef(), JsonWriter);
+    return OutputString;
+}
+
+//Records JSON value each property has been serialized into. Properties always return their cached value right after the save
+static void CollectSerializedValues(UConfigProperty* RootProperty, TMap<UConfigProperty*, FJsonValue*>& OutSerializedValues, TFunctionRef<TSharedPtr<FJsonValue>(UConfigProperty*)> Serialize) {
+    OutSerializedValues.Add(RootProperty, Serialize(RootProperty).Get());
+    ForEachObjectWithOuter(RootProperty, [&](UObject* NestedObject) {
+        if (UConfigProperty* NestedProperty = Cast<UConfigProperty>(NestedObject)) {
+            OutSerializedValues.Add(NestedProperty, Serialize(NestedProperty).Get());
+        }
+    }, true);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FConfigJsonCacheTest, "SML.Configuration.JsonCache",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FConfigJsonCacheTest::RunTest(const FString& Parameters) {
+    const int32 NumArrays = 20;
+    const int32 NumElements = 500;
+    const int32 NumTimedSaves = 10;
+
+    //Root section holding arrays of sections, every nested property is outered to the property containing it
+    UConfigPropertySection* RootSection = NewObject<UConfigPropertySection>(GetTransientPackage(), NAME_None, RF_Transient);
+    UConfigPropertyInteger* ChangedLeaf = NULL;
+    for (int32 i = 0; i < NumArrays; i++) {
+        UConfigPropertyArray* Array = NewObject<UConfigPropertyArray>(RootSection);
+        RootSection->SectionProperties.Add(FString::Printf(TEXT("Array%d"), i), Array);
+
+        for (int32 j = 0; j < NumElements; j++) {
+            UConfigPropertySection* Element = NewObject<UConfigPropertySection>(Array);
+            UConfigPropertyInteger* IntegerValue = NewObject<UConfigPropertyInteger>(Element);
+            IntegerValue->Value = i * NumElements + j;
+            UConfigPropertyString* StringValue = NewObject<UConfigPropertyString>(Element);
+            StringValue->Value = FString::Printf(TEXT("Element %d of array %d"), j, i);
+            Element->SectionProperties.Add(TEXT("Integer"), IntegerValue);
+            Element->SectionProperties.Add(TEXT("String"), StringValue);
+            Array->Values.Add(Element);
+
+            if (i == NumArrays / 2 && j == NumElements / 2) {
+                ChangedLeaf = IntegerValue;
+            }
+        }
+    }
+
+    //Old save path serialized the whole tree into the raw format, and then converted it into JSON
+    const auto SerializeThroughRawFormat = [&]() {
+        return PrintJsonObject(FJsonRawFormatConverter::ConvertToJson(RootSection->Serialize(GetTransientPackage())));
+    };
+    const auto SerializeThroughCache = [&]() {
+        return PrintJsonObject(UConfigManager::SerializePropertyToJsonForTesting(RootSection));
+    };
+    const auto GetCachedValue = [](UConfigProperty* Property) {
+        return UConfigManager::SerializePropertyToJsonForTesting(Property);
+    };
+
+    TestEqual(TEXT("Initial save matches raw format path"), SerializeThroughCache(), SerializeThroughRawFormat());
+    TMap<UConfigProperty*, FJsonValue*> ValuesBeforeChange;
+    CollectSerializedValues(RootSection, ValuesBeforeChange, GetCachedValue);
+
+    //Change a single leaf deep inside of the array and save again
+    ChangedLeaf->Value = -1;
+    ChangedLeaf->MarkDirty();
+    TestEqual(TEXT("Save after single value change matches raw format path"), SerializeThroughCache(), SerializeThroughRawFormat());
+    TMap<UConfigProperty*, FJsonValue*> ValuesAfterChange;
+    CollectSerializedValues(RootSection, ValuesAfterChange, GetCachedValue);
+
+    //Only the changed leaf and properties containing it should have been serialized again
+    int32 NumReencodedProperties = 0;
+    int32 NumUnexpectedlyReencoded = 0;
+    int32 NumUnexpectedlyReused = 0;
+    for (const TPair<UConfigProperty*, FJsonValue*>& Pair : ValuesAfterChange) {
+        const bool bReencoded = ValuesBeforeChange.FindRef(Pair.Key) != Pair.Value;
+        const bool bShouldBeReencoded = Pair.Key == ChangedLeaf || ChangedLeaf->IsIn(Pair.Key);
+        NumReencodedProperties += bReencoded;
+        NumUnexpectedlyReencoded += bReencoded && !bShouldBeReencoded;
+        NumUnexpectedlyReused += !bReencoded && bShouldBeReencoded;
+    }
+    TestEqual(TEXT("Properties re-encoded without being changed"), NumUnexpectedlyReencoded, 0);
+    TestEqual(TEXT("Changed properties reusing outdated JSON"), NumUnexpectedlyReused, 0);
+    //Leaf, element section, array and root section
+    TestEqual(TEXT("Re-encoded property count"), NumReencodedProperties, 4);
+
+    //Value changed directly without marking the property dirty, followed by MarkConfigurationDirty on the whole configuration
+    const FConfigId TestConfigId{TEXT("SMLConfigJsonCacheTest")};
+    UConfigManager* ConfigManager = NewObject<UConfigManager>(GetTransientPackage(), NAME_None, RF_Transient);
+    ConfigManager->RegisterRootSectionForTesting(TestConfigId, RootSection);
+
+    ChangedLeaf->Value = -2;
+    ConfigManager->MarkConfigurationDirty(TestConfigId);
+    TestTrue(TEXT("Configuration is pending save after MarkConfigurationDirty"), ConfigManager->IsConfigurationPendingSaveForTesting(TestConfigId));
+    TestEqual(TEXT("Save after MarkConfigurationDirty matches raw format path"), SerializeThroughCache(), SerializeThroughRawFormat());
+    
+    //Nothing should be written into the file system by the save timer
+    ConfigManager->UnregisterConfigurationForTesting(TestConfigId);
+
+    //Compare the cost of saving after a single change with serializing the whole tree
+    double StartTime = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumTimedSaves; i++) {
+        ChangedLeaf->Value = i;
+        ChangedLeaf->MarkDirty();
+        SerializeThroughCache();
+    }
+    const double CachedSeconds = FPlatformTime::Seconds() - StartTime;
+
+    StartTime = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumTimedSaves; i++) {
+        SerializeThroughRawFormat();
+    }
+    const double RawFormatSeconds = FPlatformTime::Seconds() - StartTime;
+
+    AddInfo(FString::Printf(TEXT("Save of %d properties after a single change: cached JSON %.2fms, raw format path %.2fms"),
+        ValuesAfterChange.Num(), CachedSeconds * 1000.0 / NumTimedSaves, RawFormatSeconds * 1000.0 / NumTimedSaves));
+    return true;
+}
+
+#endif
@@ -0,0 +1,235 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/Class.h"
+#include "UObject/Package.h"
+#include "UObject/Script.h"
+#include "Toolkit/KismetBytecodeDisassembler.h"
+#include "Toolkit/KismetBytecodeWalker.h"
+#include "Toolkit/KismetStatementIndex.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static void WriteSkipCount(TArray<uint8>& Script, CodeSkipSizeType SkipCount) {
+    Script.Append(reinterpret_cast<const uint8*>(&SkipCount), sizeof(CodeSkipSizeType));
+}
+
+static void WriteIntConst(TArray<uint8>& Script, int32 Value) {
+    Script.Add(EX_IntConst);
+    Script.Append(reinterpret_cast<const uint8*>(&Value), sizeof(int32));
+}
+
+//Generates script of the provided amount of statements, using only opcodes that don't reference any objects or properties,
+//so it can be both walked and disassembled without a compiled blueprint. Ends with a return statement like compiled functions do
+static TArray<uint8> GenerateSyntheticScript(int32 NumStatements, FRandomStream& RandomStream) {
+    TArray<uint8> Script;
+    for (int32 i = 0; i < NumStatements; i++) {
+        switch (RandomStream.RandRange(0, 5)) {
+        case 0:
+            Script.Add(EX_JumpIfNot);
+            WriteSkipCount(Script, 0);
+            Script.Add(RandomStream.RandRange(0, 1) ? EX_True : EX_False);
+            break;
+        case 1:
+            Script.Add(EX_PushExecutionFlow);
+            WriteSkipCount(Script, 0);
+            break;
+        case 2:
+            Script.Add(EX_PopExecutionFlowIfNot);
+            Script.Add(EX_ArrayGetByRef);
+            WriteIntConst(Script, i);
+            WriteIntConst(Script, RandomStream.RandRange(0, 100));
+            break;
+        case 3:
+            {
+                Script.Add(EX_Assert);
+                const uint16 LineNumber = (uint16) i;
+                Script.Append(reinterpret_cast<const uint8*>(&LineNumber), sizeof(uint16));
+                Script.Add(1);
+                Script.Add(EX_StringConst);
+                const FTCHARToUTF8 AssertMessage(*FString::Printf(TEXT("Synthetic assert %d"), i));
+                Script.Append(reinterpret_cast<const uint8*>(AssertMessage.Get()), AssertMessage.Length() + 1);
+                break;
+            }
+        case 4:
+            Script.Add(EX_Jump);
+            WriteSkipCount(Script, 0);
+            break;
+        default:
+            Script.Add(EX_Tracepoint);
+            break;
+        }
+    }
+    Script.Add(EX_Return);
+    Script.Add(EX_Nothing);
+    Script.Add(EX_EndOfScript);
+    return Script;
+}
+
+//Counts statements reported by the walker
+class FStatementCounter : public ISMLKismetBytecodeVisitor {
+public:
+    int32 NumStatements = 0;
+
+    virtual void VisitExpression(uint8 Opcode, int32 Offset, int32 Length, int32 Depth) override {
+        NumStatements += Depth == 0;
+    }
+};
+
+//Creates transient function holding provided script, which is all disassembler and statement index need
+static UFunction* CreateSyntheticFunction(const TArray<uint8>& Script) {
+    UFunction* Function = NewObject<UFunction>(GetTransientPackage(), NAME_None, RF_Transient);
+    Function->Script = Script;
+    return Function;
+}
+
+//Replicates loop FSMLKismetBytecodeDisassembler::GetStatementLength used before the statement index, serializing every statement
+static bool GetStatementLengthSerializing(FSMLKismetBytecodeDisassembler& Disassembler, const TArray<uint8>& Script, int32 ExpectedStatementIndex, int32& OutStatementLength) {
+    int32 ScriptIndex = 0;
+    while (ScriptIndex < Script.Num()) {
+        const int32 StatementIndex = ScriptIndex;
+        Disassembler.SerializeExpression(ScriptIndex);
+        if (StatementIndex == ExpectedStatementIndex) {
+            OutStatementLength = ScriptIndex - StatementIndex;
+            return true;
+        }
+    }
+    OutStatementLength = -1;
+    return false;
+}
+
+//Replicates loop FSMLKismetBytecodeDisassembler::FindFirstStatementOfType used before the statement index, serializing every statement
+static bool FindFirstStatementOfTypeSerializing(FSMLKismetBytecodeDisassembler& Disassembler, const TArray<uint8>& Script, int32 StartScriptIndex, uint8 ExpectedStatementOpcode, int32& OutStatementIndex) {
+    int32 ScriptIndex = StartScriptIndex;
+    while (ScriptIndex < Script.Num()) {
+        const int32 StatementIndex = ScriptIndex;
+        const uint8 StatementOpcode = Script[ScriptIndex];
+        Disassembler.SerializeExpression(ScriptIndex);
+        if (StatementOpcode == ExpectedStatementOpcode) {
+            OutStatementIndex = StatementIndex;
+            return true;
+        }
+    }
+    OutStatementIndex = -1;
+    return false;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FKismetStatementIndexTest, "SML.Toolkit.KismetBytecode.StatementIndex",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FKismetStatementIndexTest::RunTest(const FString& Parameters) {
+    const int32 NumStatements = 20000;
+    const int32 NumLookups = 50;
+
+    FRandomStream RandomStream(1337);
+    UFunction* Function = CreateSyntheticFunction(GenerateSyntheticScript(NumStatements, RandomStream));
+    const TArray<uint8>& Script = Function->Script;
+
+    //Serializing the function points disassembler at its script, so the old lookup loops can be replicated on top of it
+    FSMLKismetBytecodeDisassembler Disassembler;
+    const TArray<TSharedPtr<FJsonValue>> Statements = Disassembler.SerializeFunction(Function);
+
+    //Lookups are spread across the whole function, like hooks installed at arbitrary statements. Return is only found at the end
+    TArray<int32> StatementIndices;
+    for (int32 i = 0; i < NumLookups; i++) {
+        const int32 StatementNumber = RandomStream.RandRange(0, Statements.Num() - 1);
+        StatementIndices.Add((int32) Statements[StatementNumber]->AsObject()->GetNumberField(TEXT("StatementIndex")));
+    }
+
+    FSMLKismetStatementIndex StatementIndex;
+    StatementIndex.Build(Function);
+
+    //Both ways of looking statements up have to agree on every lookup
+    int32 NumMismatches = 0;
+    for (const int32 LookupIndex : StatementIndices) {
+        int32 IndexLength, SerializedLength;
+        const bool bIndexFound = StatementIndex.GetStatementLength(LookupIndex, IndexLength);
+        const bool bSerializedFound = GetStatementLengthSerializing(Disassembler, Script, LookupIndex, SerializedLength);
+        NumMismatches += bIndexFound != bSerializedFound || IndexLength != SerializedLength;
+
+        int32 IndexReturn, SerializedReturn;
+        const bool bIndexReturnFound = StatementIndex.FindFirstStatementOfType(LookupIndex, EX_Return, IndexReturn);
+        const bool bSerializedReturnFound = FindFirstStatementOfTypeSerializing(Disassembler, Script, LookupIndex, EX_Return, SerializedReturn);
+        NumMismatches += bIndexReturnFound != bSerializedReturnFound || IndexReturn != SerializedReturn;
+    }
+    TestEqual(TEXT("Statement index lookups matching serializing lookups"), NumMismatches, 0);
+
+    int32 NumFound = 0;
+    double StartTime = FPlatformTime::Seconds();
+    for (const int32 LookupIndex : StatementIndices) {
+        int32 StatementLength, ReturnIndex;
+        NumFound += GetStatementLengthSerializing(Disassembler, Script, LookupIndex, StatementLength);
+        NumFound += FindFirstStatementOfTypeSerializing(Disassembler, Script, LookupIndex, EX_Return, ReturnIndex);
+    }
+    const double SerializingSeconds = FPlatformTime::Seconds() - StartTime;
+
+    //Index is built once per hooked function, so its build time is included
+    StartTime = FPlatformTime::Seconds();
+    FSMLKismetStatementIndex BenchmarkIndex;
+    BenchmarkIndex.Build(Function);
+    for (const int32 LookupIndex : StatementIndices) {
+        int32 StatementLength, ReturnIndex;
+        NumFound += BenchmarkIndex.GetStatementLength(LookupIndex, StatementLength);
+        NumFound += BenchmarkIndex.FindFirstStatementOfType(LookupIndex, EX_Return, ReturnIndex);
+    }
+    const double IndexSeconds = FPlatformTime::Seconds() - StartTime;
+
+    AddInfo(FString::Printf(TEXT("%d statement length and return lookups over %d statements (%d found): serializing loops %.2fms, statement index %.2fms including build"),
+        NumLookups * 2, Statements.Num(), NumFound, SerializingSeconds * 1000.0, IndexSeconds * 1000.0));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FKismetBytecodeDisassemblerTest, "SML.Toolkit.KismetBytecode.Disassembler",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FKismetBytecodeDisassemblerTest::RunTest(const FString& Parameters) {
+    const int32 NumStatements = 20000;
+    const int32 NumIterations = 10;
+
+    FRandomStream RandomStream(1337);
+    UFunction* Function = CreateSyntheticFunction(GenerateSyntheticScript(NumStatements, RandomStream));
+    const TArray<uint8>& Script = Function->Script;
+
+    FSMLKismetBytecodeDisassembler Disassembler;
+    const TArray<TSharedPtr<FJsonValue>> Statements = Disassembler.SerializeFunction(Function);
+
+    FStatementCounter StatementCounter;
+    FSMLKismetBytecodeWalker(Script).WalkStatements(0, StatementCounter);
+    TestEqual(TEXT("Serialized statements"), Statements.Num(), NumStatements + 2);
+    TestEqual(TEXT("Walked statements"), StatementCounter.NumStatements, Statements.Num());
+    TestEqual(TEXT("Last statement index"), (int32) Statements.Last()->AsObject()->GetNumberField(TEXT("StatementIndex")), Script.Num() - 1);
+
+    //Walker on its own is the cost of decoding statements without serializing them. SerializeFunction consumes statements
+    //while walking, so it should be on par with the single pass loop rather than with both combined
+    double StartTime = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumIterations; i++) {
+        FStatementCounter IterationCounter;
+        FSMLKismetBytecodeWalker(Script).WalkStatements(0, IterationCounter);
+    }
+    const double WalkerSeconds = FPlatformTime::Seconds() - StartTime;
+
+    StartTime = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumIterations; i++) {
+        Disassembler.SerializeFunction(Function);
+    }
+    const double SerializeFunctionSeconds = FPlatformTime::Seconds() - StartTime;
+
+    //Single pass loop SerializeFunction used before, taking statement lengths from the decoded expressions
+    StartTime = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumIterations; i++) {
+        TArray<TSharedPtr<FJsonValue>> SinglePassStatements;
+        int32 ScriptIndex = 0;
+        while (ScriptIndex < Script.Num()) {
+            const int32 StatementIndex = ScriptIndex;
+            TSharedPtr<FJsonObject> StatementObject = Disassembler.SerializeExpression(ScriptIndex);
+            StatementObject->SetNumberField(TEXT("StatementIndex"), StatementIndex);
+            SinglePassStatements.Add(MakeShareable(new FJsonValueObject(StatementObject)));
+        }
+    }
+    const double SinglePassSeconds = FPlatformTime::Seconds() - StartTime;
+
+    AddInfo(FString::Printf(TEXT("%d statements (%d bytes) x%d: walker alone %.2fms, SerializeFunction through walker %.2fms, single pass serialization %.2fms"),
+        Statements.Num(), Script.Num(), NumIterations, WalkerSeconds * 1000.0, SerializeFunctionSeconds * 1000.0, SinglePassSeconds * 1000.0));
+    return true;
+}
+
+#endif
@@ -0,0 +1,138 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Registry/ModContentRegistry.h"
+#include "ModLoading/ModLoadingLibrary.h"
+#include "Reflection/ReflectionHelper.h"
+#include "Resources/FGItemDescriptor.h"
+#include "FGRecipe.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Creates a class deriving from the native parent without any blueprint, so content can be registered headlessly
+ * Class lives in the transient package, which content registry attributes to FactoryGame
+ */
+static UClass* CreateSyntheticContentClass(UClass* ParentClass, const FString& BaseName) {
+    UPackage* TransientPackage = GetTransientPackage();
+    const FName ClassName = MakeUniqueObjectName(TransientPackage, UClass::StaticClass(), *BaseName);
+    UClass* SyntheticClass = NewObject<UClass>(TransientPackage, ClassName, RF_Public | RF_Transient);
+
+    SyntheticClass->SetSuperStruct(ParentClass);
+    SyntheticClass->ClassWithin = ParentClass->ClassWithin;
+    SyntheticClass->ClassFlags |= ParentClass->ClassFlags & CLASS_Inherit;
+    SyntheticClass->Bind();
+    SyntheticClass->StaticLink(true);
+    SyntheticClass->AssembleReferenceTokenStream(true);
+    return SyntheticClass;
+}
+
+/** Marks synthetic class and its default object for garbage collection, so they do not outlive the test */
+static void DestroySyntheticContentClass(UClass* SyntheticClass) {
+    if (UObject* DefaultObject = SyntheticClass->GetDefaultObject(false)) {
+        DefaultObject->MarkPendingKill();
+    }
+    SyntheticClass->MarkPendingKill();
+}
+
+static bool ContainsRegisteredObject(TArrayView<const TSharedPtr<FItemRegistrationInfo>> RegistrationInfos, UClass* Object) {
+    return RegistrationInfos.ContainsByPredicate([Object](const TSharedPtr<FItemRegistrationInfo>& RegistrationInfo) {
+        return RegistrationInfo->RegisteredObject == Object;
+    });
+}
+
+/** Registers recipes in a fresh registry and returns how long registration took, in seconds */
+static double RegisterSyntheticRecipes(const TArray<TSubclassOf<UFGRecipe>>& Recipes, int32 NumRecipes, AModContentRegistry*& OutRegistry) {
+    //Registration only touches registry state, so the registry does not have to be spawned into a world. Caller marks it for garbage collection
+    OutRegistry = NewObject<AModContentRegistry>(GetTransientPackage(), NAME_None, RF_Transient);
+
+    const double StartTime = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumRecipes; i++) {
+        OutRegistry->RegisterRecipe(TEXT("SyntheticMod"), Recipes[i]);
+    }
+    return FPlatformTime::Seconds() - StartTime;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModContentRegistryRecipeScalingTest, "SML.Registry.RecipeRegistrationScaling",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::StressFilter)
+
+bool FModContentRegistryRecipeScalingTest::RunTest(const FString& Parameters) {
+    const int32 NumRecipes = 25000;
+    const int32 NumAttempts = 3;
+
+    //Every recipe references the same few items, which is the worst case for per-item recipe tracking.
+    //Shared ingredient is listed twice to make sure duplicates within a single recipe are still collapsed
+    TArray<TSubclassOf<UFGItemDescriptor>> SharedItems;
+    for (int32 i = 0; i < 3; i++) {
+        SharedItems.Add(CreateSyntheticContentClass(UFGItemDescriptor::StaticClass(), TEXT("SyntheticItem")));
+    }
+    FArrayProperty* IngredientsProperty = FReflectionHelper::FindPropertyChecked<FArrayProperty>(UFGRecipe::StaticClass(), TEXT("mIngredients"));
+    FArrayProperty* ProductsProperty = FReflectionHelper::FindPropertyChecked<FArrayProperty>(UFGRecipe::StaticClass(), TEXT("mProduct"));
+
+    TArray<TSubclassOf<UFGRecipe>> Recipes;
+    for (int32 i = 0; i < NumRecipes * 2; i++) {
+        UClass* RecipeClass = CreateSyntheticContentClass(UFGRecipe::StaticClass(), TEXT("SyntheticRecipe"));
+        UFGRecipe* RecipeDefaultObject = RecipeClass->GetDefaultObject<UFGRecipe>();
+
+        TArray<FItemAmount>& Ingredients = *IngredientsProperty->ContainerPtrToValuePtr<TArray<FItemAmount>>(RecipeDefaultObject);
+        Ingredients.Add(FItemAmount(SharedItems[0], 1));
+        Ingredients.Add(FItemAmount(SharedItems[1], 1));
+        Ingredients.Add(FItemAmount(SharedItems[0], 1));
+        ProductsProperty->ContainerPtrToValuePtr<TArray<FItemAmount>>(RecipeDefaultObject)->Add(FItemAmount(SharedItems[2], 1));
+        Recipes.Add(RecipeClass);
+    }
+
+    //Timing is only reported, linear tracking is verified structurally through the reference counts below.
+    //Fastest of the several attempts is reported, so a single hiccup does not skew it
+    double RegistrationSeconds[2] = {MAX_dbl, MAX_dbl};
+    for (int32 SizeIndex = 0; SizeIndex < 2; SizeIndex++) {
+        const int32 NumRegisteredRecipes = NumRecipes * (SizeIndex + 1);
+
+        for (int32 Attempt = 0; Attempt < NumAttempts; Attempt++) {
+            AModContentRegistry* Registry = NULL;
+            RegistrationSeconds[SizeIndex] = FMath::Min(RegistrationSeconds[SizeIndex], RegisterSyntheticRecipes(Recipes, NumRegisteredRecipes, Registry));
+
+            //Shared items have to reference every recipe exactly once, in registration order
+            const FItemRegistrationInfo SharedItemInfo = Registry->GetItemDescriptorInfo(SharedItems[0]);
+            TestEqual(TEXT("Shared item referenced by every recipe once"), SharedItemInfo.ReferencedBy.Num(), NumRegisteredRecipes);
+            TestTrue(TEXT("Shared item references are in registration order"), SharedItemInfo.ReferencedBy.Num() == NumRegisteredRecipes &&
+                SharedItemInfo.ReferencedBy[0] == Recipes[0] && SharedItemInfo.ReferencedBy.Last() == Recipes[NumRegisteredRecipes - 1]);
+            TestEqual(TEXT("Shared ingredient is consumed by every recipe once"), Registry->GetRecipesConsumingItem(SharedItems[0]).Num(), NumRegisteredRecipes);
+            TestEqual(TEXT("Shared product is produced by every recipe once"), Registry->GetRecipesProducingItem(SharedItems[2]).Num(), NumRegisteredRecipes);
+            Registry->MarkPendingKill();
+        }
+    }
+
+    //Linear registration takes twice as long for twice the recipes, while quadratic one takes four times as long
+    const double GrowthFactor = RegistrationSeconds[1] / FMath::Max(RegistrationSeconds[0], 1e-6);
+    AddInfo(FString::Printf(TEXT("Registering %d recipes took %.2fms, %d recipes took %.2fms (%.2fx)"),
+        NumRecipes, RegistrationSeconds[0] * 1000.0, NumRecipes * 2, RegistrationSeconds[1] * 1000.0, GrowthFactor));
+
+    for (const TSubclassOf<UFGRecipe>& Recipe : Recipes) {
+        DestroySyntheticContentClass(Recipe);
+    }
+    for (const TSubclassOf<UFGItemDescriptor>& SharedItem : SharedItems) {
+        DestroySyntheticContentClass(SharedItem);
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModContentRegistryLoadedItemDescriptorsTest, "SML.Registry.LoadedItemDescriptorsCache",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FModContentRegistryLoadedItemDescriptorsTest::RunTest(const FString& Parameters) {
+    AModContentRegistry* Registry = NewObject<AModContentRegistry>(GetTransientPackage(), NAME_None, RF_Transient);
+
+    //Builds the cache, registering every loaded item descriptor
+    TestTrue(TEXT("Loaded item descriptors are found"), Registry->GetLoadedItemDescriptorsView().Num() > 0);
+
+    //Item descriptor class appearing without going through the registry, like a class loaded by another subsystem
+    UClass* LoadedItemDescriptor = CreateSyntheticContentClass(UFGItemDescriptor::StaticClass(), TEXT("SyntheticLoadedItem"));
+    TestFalse(TEXT("Item descriptor is not registered by loading it"), ContainsRegisteredObject(Registry->GetItemDescriptorsOwnedBy(FACTORYGAME_MOD_NAME), LoadedItemDescriptor));
+    TestTrue(TEXT("Item descriptor loaded outside of registration is picked up by the cache"), ContainsRegisteredObject(Registry->GetLoadedItemDescriptorsView(), LoadedItemDescriptor));
+
+    DestroySyntheticContentClass(LoadedItemDescriptor);
+    Registry->MarkPendingKill();
+    return true;
+}
+
+#endif
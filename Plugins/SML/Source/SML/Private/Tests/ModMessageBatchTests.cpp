@@ -0,0 +1,213 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Network/ModMessageBatch.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//Reads all entries of the batch, returning false once the first malformed one is encountered
+static bool ReadWholeBatch(const TArray<uint8>& Payload, int32& OutNumEntries) {
+    FMemoryReader Reader(Payload);
+    FMessageBatchEntry Entry;
+    OutNumEntries = 0;
+    while (!Reader.AtEnd()) {
+        if (!FModMessageBatchFormat::ReadEntry(Reader, Entry)) {
+            return false;
+        }
+        OutNumEntries++;
+    }
+    return true;
+}
+
+//Writes entry addressed by name, but with the raw string length prefix instead of the actual string
+static TArray<uint8> MakeEntryWithStringLength(int32 SavedLength, int32 NumCharacterBytes) {
+    TArray<uint8> Payload;
+    FMemoryWriter Writer(Payload);
+    uint8 EntryFlags = 0;
+    int32 DataSize = 0;
+    Writer << EntryFlags;
+    Writer << SavedLength;
+    for (int32 i = 0; i < NumCharacterBytes; i++) {
+        uint8 Character = 'A';
+        Writer << Character;
+    }
+    Writer << DataSize;
+    return Payload;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModMessageBatchMalformedTest, "SML.Network.MessageBatch.Malformed",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FModMessageBatchMalformedTest::RunTest(const FString& Parameters) {
+    const FMessageType MessageType{TEXT("TestMod"), 1};
+    const TArray<uint8> MessageData{1, 2, 3, 4};
+    int32 NumEntries = 0;
+
+    //Well formed batch is read completely, whichever way entries are addressed
+    TArray<uint8> ValidPayload;
+    {
+        FMemoryWriter Writer(ValidPayload);
+        FModMessageBatchFormat::WriteEntry(Writer, MessageType, INDEX_NONE, 0, MessageData.GetData(), MessageData.Num());
+        FModMessageBatchFormat::WriteEntry(Writer, MessageType, 5, 0, MessageData.GetData(), MessageData.Num());
+    }
+    TestTrue(TEXT("Well formed batch is accepted"), ReadWholeBatch(ValidPayload, NumEntries));
+    TestEqual(TEXT("Well formed batch entry count"), NumEntries, 2);
+
+    //String lengths claiming more data than there is left are rejected before the string is allocated
+    TestFalse(TEXT("Huge ANSI string length is rejected"), ReadWholeBatch(MakeEntryWithStringLength(MAX_int32, 4), NumEntries));
+    TestFalse(TEXT("Huge UCS2 string length is rejected"), ReadWholeBatch(MakeEntryWithStringLength(-(MAX_int32 / 2), 4), NumEntries));
+    TestFalse(TEXT("Minimal string length is rejected"), ReadWholeBatch(MakeEntryWithStringLength(MIN_int32, 4), NumEntries));
+    TestFalse(TEXT("String length past the end of the batch is rejected"), ReadWholeBatch(MakeEntryWithStringLength(16, 4), NumEntries));
+
+    //Data sizes that are negative or past the end of the batch are rejected
+    for (const int32 DataSize : {-1, MIN_int32, MAX_int32, MessageData.Num() + 1}) {
+        TArray<uint8> Payload;
+        FMemoryWriter Writer(Payload);
+        uint8 EntryFlags = EMessageEntryFlags::ChannelId;
+        uint32 ChannelId = 0;
+        int32 MutableDataSize = DataSize;
+        Writer << EntryFlags;
+        Writer.SerializeIntPacked(ChannelId);
+        Writer << MutableDataSize;
+        Writer.Serialize(const_cast<uint8*>(MessageData.GetData()), MessageData.Num());
+        TestFalse(FString::Printf(TEXT("Data size %d is rejected"), DataSize), ReadWholeBatch(Payload, NumEntries));
+    }
+
+    //Every truncation of the well formed batch is either rejected or read up to the last complete entry
+    for (int32 TruncatedSize = 1; TruncatedSize < ValidPayload.Num(); TruncatedSize++) {
+        const TArray<uint8> TruncatedPayload(ValidPayload.GetData(), TruncatedSize);
+        if (ReadWholeBatch(TruncatedPayload, NumEntries)) {
+            TestTrue(TEXT("Truncated batch only contains complete entries"), NumEntries < 2);
+        }
+    }
+
+    //Compressed data too short to contain the uncompressed size is reported as such
+    TestEqual(TEXT("Uncompressed size of short data"), FModMessageBatchFormat::GetUncompressedSize(TArray<uint8>{1, 2}), (int32) INDEX_NONE);
+    return true;
+}
+
+/**
+ * Stand-in for the pair of connections: sending side queues entries into batches exactly like the network handler does,
+ * and receiving side reads them back, reassembling fragments and decompressing messages
+ */
+struct FLoopbackMessageChannel {
+    TArray<TArray<uint8>> SentBatches;
+    TArray<uint8> PendingBatch;
+    TArray<uint8> CompressedDataBuffer;
+    int32 MaxBatchSize = 0;
+
+    void Send(const FMessageType& MessageType, int32 RemoteChannelId, const TArray<uint8>& Data) {
+        FModMessageBatchFormat::EncodeMessage(Data.GetData(), Data.Num(), true, CompressedDataBuffer,
+            [&](uint8 EntryFlags, const uint8* EntryData, int32 EntryDataSize) {
+                FMemoryWriter Writer(PendingBatch, false, true);
+                FModMessageBatchFormat::WriteEntry(Writer, MessageType, RemoteChannelId, EntryFlags, EntryData, EntryDataSize);
+                if (PendingBatch.Num() >= MaxBatchSize) {
+                    Flush();
+                }
+            });
+    }
+
+    void Flush() {
+        if (PendingBatch.Num() > 0) {
+            SentBatches.Add(MoveTemp(PendingBatch));
+            PendingBatch.Reset();
+        }
+    }
+
+    /** Returns amount of the received messages and their total size after decompression, or false if any batch was malformed */
+    bool ReceiveAll(int32& OutNumMessages, int64& OutNumBytes) const {
+        FMessageBatchEntry Entry;
+        TArray<uint8> PartialMessage;
+        TArray<uint8> UncompressedData;
+        OutNumMessages = 0;
+        OutNumBytes = 0;
+
+        for (const TArray<uint8>& Batch : SentBatches) {
+            FMemoryReader Reader(Batch);
+            while (!Reader.AtEnd()) {
+                if (!FModMessageBatchFormat::ReadEntry(Reader, Entry)) {
+                    return false;
+                }
+                const TArray<uint8>* MessageData = &Entry.Data;
+                if (Entry.EntryFlags & EMessageEntryFlags::Fragment) {
+                    PartialMessage.Append(Entry.Data);
+                    if ((Entry.EntryFlags & EMessageEntryFlags::LastFragment) == 0) {
+                        continue;
+                    }
+                    MessageData = &PartialMessage;
+                }
+                if (Entry.EntryFlags & EMessageEntryFlags::Compressed) {
+                    const int32 UncompressedSize = FModMessageBatchFormat::GetUncompressedSize(*MessageData);
+                    if (UncompressedSize <= 0 || !FModMessageBatchFormat::DecompressMessage(*MessageData, UncompressedSize, UncompressedData)) {
+                        return false;
+                    }
+                    MessageData = &UncompressedData;
+                }
+                OutNumMessages++;
+                OutNumBytes += MessageData->Num();
+                PartialMessage.Reset();
+            }
+        }
+        return true;
+    }
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModMessageBatchThroughputTest, "SML.Network.MessageBatch.Throughput",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FModMessageBatchThroughputTest::RunTest(const FString& Parameters) {
+    const FMessageType MessageType{TEXT("TestMod"), 1};
+    const int32 NumMessages = 20000;
+
+    //Mostly small state updates, with occasional large blobs. Compressible blobs get compressed,
+    //and random ones don't compress at all and are fragmented instead
+    FRandomStream RandomStream(1337);
+    TArray<TArray<uint8>> Messages;
+    int64 TotalMessageBytes = 0;
+    for (int32 i = 0; i < NumMessages; i++) {
+        TArray<uint8>& Message = Messages.AddDefaulted_GetRef();
+        const bool bIsCompressibleBlob = i % 500 == 0;
+        const bool bIsRandomBlob = i % 500 == 250;
+        Message.SetNumUninitialized(bIsCompressibleBlob || bIsRandomBlob ? 64 * 1024 : RandomStream.RandRange(8, 256));
+        for (int32 j = 0; j < Message.Num(); j++) {
+            Message[j] = bIsCompressibleBlob ? (uint8) (j % 64) : (uint8) RandomStream.RandRange(0, 255);
+        }
+        TotalMessageBytes += Message.Num();
+    }
+
+    //Batched sending, same as the network handler does, compared to sending each message in its own control message
+    for (const bool bBatchMessages : {true, false}) {
+        for (const int32 RemoteChannelId : {(int32) INDEX_NONE, 0}) {
+            FLoopbackMessageChannel Channel;
+            Channel.MaxBatchSize = bBatchMessages ? 32 * 1024 : 1;
+
+            const double StartTime = FPlatformTime::Seconds();
+            for (const TArray<uint8>& Message : Messages) {
+                Channel.Send(MessageType, RemoteChannelId, Message);
+            }
+            Channel.Flush();
+            const double SendSeconds = FPlatformTime::Seconds() - StartTime;
+
+            int32 NumReceivedMessages = 0;
+            int64 NumReceivedBytes = 0;
+            const bool bReceived = Channel.ReceiveAll(NumReceivedMessages, NumReceivedBytes);
+            const double TotalSeconds = FPlatformTime::Seconds() - StartTime;
+
+            TestTrue(TEXT("All batches are well formed"), bReceived);
+            TestEqual(TEXT("Received message count"), NumReceivedMessages, NumMessages);
+            TestEqual(TEXT("Received byte count"), NumReceivedBytes, TotalMessageBytes);
+
+            int64 NumWireBytes = 0;
+            for (const TArray<uint8>& Batch : Channel.SentBatches) {
+                NumWireBytes += Batch.Num();
+            }
+            AddInfo(FString::Printf(TEXT("%s, addressed by %s: %d control messages, %lld bytes on the wire for %lld bytes of data, send %.2fms, round trip %.2fms (%.0f messages/s)"),
+                bBatchMessages ? TEXT("Batched") : TEXT("Unbatched"), RemoteChannelId == INDEX_NONE ? TEXT("name") : TEXT("channel ID"),
+                Channel.SentBatches.Num(), NumWireBytes, TotalMessageBytes, SendSeconds * 1000.0, TotalSeconds * 1000.0, NumMessages / TotalSeconds));
+        }
+    }
+    return true;
+}
+
+#endif
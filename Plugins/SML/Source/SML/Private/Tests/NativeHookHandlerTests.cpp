@@ -0,0 +1,98 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Patching/NativeHookManager.h"
+#include <functional>
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//Written by the handlers and the hooked function, so the compiler can't optimize the calls away
+static volatile int64 DispatchBenchmarkSink = 0;
+
+static void BenchmarkHookedFunction(int32 Value) {
+	DispatchBenchmarkSink = DispatchBenchmarkSink + Value;
+}
+
+/** Call scope handlers were dispatched through before THookHandler, storing handlers as std::function */
+struct FStdFunctionCallScope {
+	typedef std::function<void(FStdFunctionCallScope&, int32)> HookFunc;
+
+	TArray<HookFunc>* functionList;
+	int32 handlerPtr = 0;
+	void(*function)(int32);
+	bool forwardCall = true;
+
+	FStdFunctionCallScope(TArray<HookFunc>* functionList, void(*function)(int32)) : functionList(functionList), function(function) {}
+
+	void operator()(int32 Value) {
+		if (functionList == nullptr || handlerPtr >= functionList->Num()) {
+			function(Value);
+			forwardCall = false;
+		} else {
+			const int32 cachePtr = handlerPtr + 1;
+			HookFunc& handler = (*functionList)[handlerPtr++];
+			handler(*this, Value);
+			if (handlerPtr == cachePtr && forwardCall) {
+				(*this)(Value);
+			}
+		}
+	}
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNativeHookHandlerDispatchTest, "SML.Hooks.HandlerDispatch",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FNativeHookHandlerDispatchTest::RunTest(const FString& Parameters) {
+	using FScopeType = CallScope<void(*)(int32)>;
+	const int32 NumCalls = 1000000;
+	const FString CapturedString = TEXT("Captured by value, so handler is stored on the heap");
+	int64 CapturedValue = 7;
+
+	//Typical mix of handlers: captureless lambda, lambda capturing a pointer and lambda capturing a non-trivial object
+	TArray<FScopeType::HookEntry> HookHandlers;
+	HookHandlers.Add(FScopeType::HookEntry{FScopeType::HookFunc([](FScopeType& Scope, int32 Value) {
+		DispatchBenchmarkSink = DispatchBenchmarkSink + 1;
+	}), FDelegateHandle(), NULL});
+	HookHandlers.Add(FScopeType::HookEntry{FScopeType::HookFunc([&CapturedValue](FScopeType& Scope, int32 Value) {
+		DispatchBenchmarkSink = DispatchBenchmarkSink + CapturedValue;
+	}), FDelegateHandle(), NULL});
+	HookHandlers.Add(FScopeType::HookEntry{FScopeType::HookFunc([CapturedString](FScopeType& Scope, int32 Value) {
+		DispatchBenchmarkSink = DispatchBenchmarkSink + CapturedString.Len();
+	}), FDelegateHandle(), NULL});
+
+	TArray<FStdFunctionCallScope::HookFunc> StdFunctionHandlers;
+	StdFunctionHandlers.Add([](FStdFunctionCallScope& Scope, int32 Value) {
+		DispatchBenchmarkSink = DispatchBenchmarkSink + 1;
+	});
+	StdFunctionHandlers.Add([&CapturedValue](FStdFunctionCallScope& Scope, int32 Value) {
+		DispatchBenchmarkSink = DispatchBenchmarkSink + CapturedValue;
+	});
+	StdFunctionHandlers.Add([CapturedString](FStdFunctionCallScope& Scope, int32 Value) {
+		DispatchBenchmarkSink = DispatchBenchmarkSink + CapturedString.Len();
+	});
+
+	DispatchBenchmarkSink = 0;
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < NumCalls; i++) {
+		FScopeType Scope(&HookHandlers, &BenchmarkHookedFunction);
+		Scope(i);
+	}
+	const double HookHandlerSeconds = FPlatformTime::Seconds() - StartTime;
+	const int64 HookHandlerSink = DispatchBenchmarkSink;
+
+	DispatchBenchmarkSink = 0;
+	StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < NumCalls; i++) {
+		FStdFunctionCallScope Scope(&StdFunctionHandlers, &BenchmarkHookedFunction);
+		Scope(i);
+	}
+	const double StdFunctionSeconds = FPlatformTime::Seconds() - StartTime;
+	const int64 StdFunctionSink = DispatchBenchmarkSink;
+
+	//Both paths must call every handler and the original function exactly once per call
+	TestEqual(TEXT("Both dispatch paths produce the same result"), HookHandlerSink, StdFunctionSink);
+	AddInfo(FString::Printf(TEXT("%d hooked calls with %d handlers: THookHandler %.2fns per call, std::function %.2fns per call"),
+		NumCalls, HookHandlers.Num(), HookHandlerSeconds * 1e9 / NumCalls, StdFunctionSeconds * 1e9 / NumCalls));
+	return true;
+}
+
+#endif
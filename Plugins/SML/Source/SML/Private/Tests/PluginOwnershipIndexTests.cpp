@@ -0,0 +1,133 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Util/PluginOwnershipIndex.h"
+#include "Interfaces/IPluginManager.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//Replicates linear search over enabled plugins FindOwnerPluginForMountPoint used before the ownership index
+static const FPluginOwnershipInfo* FindMountPointOwnerLinear(const TArray<FPluginOwnershipInfo>& Plugins, const FString& MountPoint) {
+    for (const FPluginOwnershipInfo& Plugin : Plugins) {
+        if (Plugin.MountPoint == MountPoint) {
+            return &Plugin;
+        }
+    }
+    return NULL;
+}
+
+//Replicates linear search over enabled plugins FindOwnerPluginForModuleName used before the ownership index
+static const FPluginOwnershipInfo* FindModuleOwnerLinear(const TArray<FPluginOwnershipInfo>& Plugins, FName ModuleName, bool bModsOnly) {
+    for (const FPluginOwnershipInfo& Plugin : Plugins) {
+        if ((Plugin.Owner.bIsMod || !bModsOnly) && Plugin.ModuleNames.Contains(ModuleName)) {
+            return &Plugin;
+        }
+    }
+    return NULL;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPluginOwnershipIndexTest, "SML.Util.PluginOwnershipIndex",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FPluginOwnershipIndexTest::RunTest(const FString& Parameters) {
+    const int32 NumPlugins = 500;
+    const int32 NumLookups = 100000;
+
+    //Every fourth plugin is a non-mod engine plugin, and every tenth one declares the module shared with the next plugin,
+    //so lookups of ambiguous modules have to skip non-mod plugins the same way linear search did
+    TArray<FPluginOwnershipInfo> Plugins;
+    for (int32 i = 0; i < NumPlugins; i++) {
+        FPluginOwnershipInfo& Plugin = Plugins.AddDefaulted_GetRef();
+        Plugin.Owner.PluginName = FString::Printf(TEXT("SyntheticPlugin%d"), i);
+        Plugin.Owner.bIsMod = i % 4 != 0;
+        if (i % 3 != 0) {
+            Plugin.MountPoint = Plugin.Owner.PluginName;
+        }
+        Plugin.ModuleNames.Add(*FString::Printf(TEXT("SyntheticModule%d"), i));
+        if (i % 10 == 0 || i % 10 == 1) {
+            Plugin.ModuleNames.Add(*FString::Printf(TEXT("SharedModule%d"), i / 10));
+        }
+    }
+    FPluginOwnershipIndex OwnershipIndex;
+    OwnershipIndex.Build(Plugins);
+
+    //Lookups are spread across all plugins, including the ones missing from the index
+    TArray<FString> MountPoints;
+    TArray<FName> ModuleNames;
+    FRandomStream RandomStream(1337);
+    for (int32 i = 0; i < NumLookups; i++) {
+        const int32 PluginIndex = RandomStream.RandRange(0, NumPlugins - 1);
+        MountPoints.Add(FString::Printf(TEXT("SyntheticPlugin%d"), PluginIndex));
+        ModuleNames.Add(PluginIndex % 2 == 0 ? FName(*FString::Printf(TEXT("SharedModule%d"), PluginIndex / 10)) : FName(*FString::Printf(TEXT("SyntheticModule%d"), PluginIndex)));
+    }
+
+    //Both ways of looking up the owner have to agree on every lookup
+    int32 NumMismatches = 0;
+    for (int32 i = 0; i < NumLookups; i++) {
+        FPluginOwnerEntry OwnerEntry;
+        const FPluginOwnershipInfo* LinearOwner = FindMountPointOwnerLinear(Plugins, MountPoints[i]);
+        const bool bFoundMountPoint = OwnershipIndex.FindOwnerForMountPoint(MountPoints[i], OwnerEntry);
+        NumMismatches += bFoundMountPoint != (LinearOwner != NULL) || (LinearOwner && LinearOwner->Owner.PluginName != OwnerEntry.PluginName);
+
+        for (const bool bModsOnly : {false, true}) {
+            LinearOwner = FindModuleOwnerLinear(Plugins, ModuleNames[i], bModsOnly);
+            const bool bFoundModule = OwnershipIndex.FindOwnerForModule(ModuleNames[i], bModsOnly, OwnerEntry);
+            NumMismatches += bFoundModule != (LinearOwner != NULL) || (LinearOwner && LinearOwner->Owner.PluginName != OwnerEntry.PluginName);
+        }
+    }
+    TestEqual(TEXT("Ownership index lookups matching linear search"), NumMismatches, 0);
+
+    //Shared module declared by a non-mod plugin first has to resolve to the mod declaring it when only mods are considered
+    FPluginOwnerEntry SharedModuleOwner;
+    TestTrue(TEXT("Shared module is found"), OwnershipIndex.FindOwnerForModule(TEXT("SharedModule0"), true, SharedModuleOwner));
+    TestEqual(TEXT("Shared module is owned by the mod"), SharedModuleOwner.PluginName, FString(TEXT("SyntheticPlugin1")));
+
+    int32 NumFound = 0;
+    double StartTime = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumLookups; i++) {
+        NumFound += FindMountPointOwnerLinear(Plugins, MountPoints[i]) != NULL;
+        NumFound += FindModuleOwnerLinear(Plugins, ModuleNames[i], true) != NULL;
+    }
+    const double LinearSeconds = FPlatformTime::Seconds() - StartTime;
+
+    StartTime = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumLookups; i++) {
+        FPluginOwnerEntry OwnerEntry;
+        NumFound += OwnershipIndex.FindOwnerForMountPoint(MountPoints[i], OwnerEntry);
+        NumFound += OwnershipIndex.FindOwnerForModule(ModuleNames[i], true, OwnerEntry);
+    }
+    const double IndexSeconds = FPlatformTime::Seconds() - StartTime;
+
+    AddInfo(FString::Printf(TEXT("%d mount point and module lookups over %d plugins (%d found): linear search %.2fms, ownership index %.2fms"),
+        NumLookups * 2, NumPlugins, NumFound, LinearSeconds * 1000.0, IndexSeconds * 1000.0));
+
+    //Misses on the global index, like native FactoryGame and engine modules looked up among mods only,
+    //should cost the same as hits instead of enumerating enabled plugins every time
+    TArray<FName> MissingModuleNames;
+    for (int32 i = 0; i < NumLookups; i++) {
+        MissingModuleNames.Add(*FString::Printf(TEXT("MissingSyntheticModule%d"), RandomStream.RandRange(0, NumPlugins - 1)));
+    }
+    FPluginOwnershipIndex& GlobalOwnershipIndex = FPluginOwnershipIndex::Get();
+    int32 NumUnexpectedlyFound = 0;
+
+    StartTime = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumLookups; i++) {
+        FPluginOwnerEntry OwnerEntry;
+        NumUnexpectedlyFound += GlobalOwnershipIndex.FindOwnerForModule(MissingModuleNames[i], true, OwnerEntry);
+    }
+    const double GlobalMissSeconds = FPlatformTime::Seconds() - StartTime;
+
+    //Cost of the plugin enumeration every miss used to perform before reporting it
+    StartTime = FPlatformTime::Seconds();
+    int32 NumEnumeratedPlugins = 0;
+    for (int32 i = 0; i < NumLookups; i++) {
+        NumEnumeratedPlugins += IPluginManager::Get().GetEnabledPlugins().Num();
+    }
+    const double EnumerationSeconds = FPlatformTime::Seconds() - StartTime;
+
+    TestEqual(TEXT("Missing modules found in the global index"), NumUnexpectedlyFound, 0);
+    AddInfo(FString::Printf(TEXT("%d missing module lookups in the global index: %.2fms, enumerating %d enabled plugins on each of them would take %.2fms"),
+        NumLookups, GlobalMissSeconds * 1000.0, NumEnumeratedPlugins / NumLookups, EnumerationSeconds * 1000.0));
+    return true;
+}
+
+#endif
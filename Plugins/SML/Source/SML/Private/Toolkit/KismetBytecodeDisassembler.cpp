@@ -1,6 +1,8 @@
 #include "Toolkit/KismetBytecodeDisassembler.h"
 #include "Serialization/JsonSerializer.h"
 #include "Toolkit/PropertyTypeHandler.h"
+#include "Toolkit/KismetStatementIndex.h"
+#include "Toolkit/KismetBytecodeWalker.h"
 
 TSharedPtr<FJsonObject> FSMLKismetBytecodeDisassembler::SerializeExpression(int32& ScriptIndex) {
 	EExprToken Opcode = (EExprToken) ReadByte(ScriptIndex);
@@ -106,7 +108,7 @@ TSharedPtr<FJsonObject> FSMLKismetBytecodeDisassembler::SerializeExpression(int3
 			TArray<TSharedPtr<FJsonValue>> Values;
 			ReadInt(ScriptIndex); //Skip element amount
 				
-			while (Script[ScriptIndex] != EX_EndMap) {
+			while (Script[ScriptIndex] != EX_EndMapConst) {
 				TSharedPtr<FJsonObject> KeyExpression = SerializeExpression(ScriptIndex);
 				TSharedPtr<FJsonObject> ValueExpression = SerializeExpression(ScriptIndex);
 				
@@ -313,6 +315,18 @@ TSharedPtr<FJsonObject> FSMLKismetBytecodeDisassembler::SerializeExpression(int3
 			FEdGraphPinType PropertyPinType;
 			FSMLPropertyTypeHelper::ConvertPropertyToPinType(Property, PropertyPinType);
 				
+			Result->SetObjectField(TEXT("VariableType"), FSMLPropertyTypeHelper::SerializeGraphPinType(PropertyPinType, SelfScope.Get()));
+			Result->SetStringField(TEXT("VariableName"), Property->GetName());
+			break;
+		}
+	case EX_ClassSparseDataVariable:
+		{
+			Result->SetStringField(TEXT("Inst"), TEXT("ClassSparseDataVariable"));
+			
+			FProperty* Property = ReadPointer<FProperty>(ScriptIndex);
+			FEdGraphPinType PropertyPinType;
+			FSMLPropertyTypeHelper::ConvertPropertyToPinType(Property, PropertyPinType);
+				
 			Result->SetObjectField(TEXT("VariableType"), FSMLPropertyTypeHelper::SerializeGraphPinType(PropertyPinType, SelfScope.Get()));
 			Result->SetStringField(TEXT("VariableName"), Property->GetName());
 			break;
@@ -968,62 +982,55 @@ TSharedPtr<FJsonObject> FSMLKismetBytecodeDisassembler::SerializeExpression(int3
 	return Result;
 }
 
-TArray<TSharedPtr<FJsonValue>> FSMLKismetBytecodeDisassembler::SerializeFunction(UStruct* Function) {
-	this->Script = Function->Script;
-	this->SelfScope = Function->GetTypedOuter<UClass>();
+/** Serializes statements walked by the bytecode walker into json objects, decoding every statement exactly once */
+class FStatementJsonSerializer : public ISMLKismetBytecodeVisitor {
+public:
+	FSMLKismetBytecodeDisassembler& Disassembler;
+	TArray<TSharedPtr<FJsonValue>>& Statements;
 
-	TArray<TSharedPtr<FJsonValue>> Statements;
-	int32 ScriptIndex = 0;
+	FStatementJsonSerializer(FSMLKismetBytecodeDisassembler& InDisassembler, TArray<TSharedPtr<FJsonValue>>& InStatements) :
+		Disassembler(InDisassembler), Statements(InStatements) {}
 
-	while (ScriptIndex < Script.Num()) {
-		const int32 StatementIndex = ScriptIndex;
-		TSharedPtr<FJsonObject> StatementObject = SerializeExpression(ScriptIndex);
+	virtual bool ConsumeStatement(int32 Offset, int32& OutLength) override {
+		int32 ScriptIndex = Offset;
+		TSharedPtr<FJsonObject> StatementObject = Disassembler.SerializeExpression(ScriptIndex);
 		
 		//Append statement index because several instructions can jump to statements (but not to separate expressions inside of statements!)
-		StatementObject->SetNumberField(TEXT("StatementIndex"), StatementIndex);
+		StatementObject->SetNumberField(TEXT("StatementIndex"), Offset);
 		Statements.Add(MakeShareable(new FJsonValueObject(StatementObject)));
+
+		//Serialized length is where the walker continues, so the statement is not decoded again
+		OutLength = ScriptIndex - Offset;
+		return true;
+	}
+
+	virtual void VisitExpression(uint8 Opcode, int32 Offset, int32 Length, int32 Depth) override {
+		//Only reached when walker falls back to walking statement that has already been serialized
 	}
+};
+
+TArray<TSharedPtr<FJsonValue>> FSMLKismetBytecodeDisassembler::SerializeFunction(UStruct* Function) {
+	this->Script = Function->Script;
+	this->SelfScope = Function->GetTypedOuter<UClass>();
+
+	TArray<TSharedPtr<FJsonValue>> Statements;
+	FStatementJsonSerializer Serializer{*this, Statements};
+	FSMLKismetBytecodeWalker(Script).WalkStatements(0, Serializer);
 	
 	return Statements;
 }
 
 bool FSMLKismetBytecodeDisassembler::FindFirstStatementOfType(UStruct* Function, int32 StartScriptIndex, uint8 ExpectedStatementOpcode, int32& OutStatementIndex) {
-	this->Script = Function->Script;
-	this->SelfScope = Function->GetTypedOuter<UClass>();
-
-	int32 ScriptIndex = StartScriptIndex;
-	while (ScriptIndex < Script.Num()) {
-		const int32 StatementIndex = ScriptIndex;
-		const uint8 StatementOpcode = Script[ScriptIndex];
-		FString ResultString;
-		SerializeExpression(ScriptIndex);
-		if (StatementOpcode == ExpectedStatementOpcode) {
-			OutStatementIndex = StatementIndex;
-			return true;
-		}
-	}
-	//We haven't found any statement with matching opcode
-	OutStatementIndex = -1;
-	return false;
+	//Statement lookups don't need expressions to be serialized, so use lightweight statement index instead
+	FSMLKismetStatementIndex StatementIndex;
+	StatementIndex.Build(Function);
+	return StatementIndex.FindFirstStatementOfType(StartScriptIndex, ExpectedStatementOpcode, OutStatementIndex);
 }
 
 bool FSMLKismetBytecodeDisassembler::GetStatementLength(UStruct* Function, int32 ExpectedStatementIndex, int32& OutStatementLength) {
-	this->Script = Function->Script;
-	this->SelfScope = Function->GetTypedOuter<UClass>();
-
-	int32 ScriptIndex = 0;
-	while (ScriptIndex < Script.Num()) {
-		const int32 StatementIndex = ScriptIndex;
-		SerializeExpression(ScriptIndex);
-		if (StatementIndex == ExpectedStatementIndex) {
-			//This is the statement we are looking for, compute difference and return it as length
-			OutStatementLength = ScriptIndex - StatementIndex;
-			return true;
-		}
-	}
-	//We haven't found a statement with expected index, so input is probably invalid
-	OutStatementLength = -1;
-	return false;
+	FSMLKismetStatementIndex StatementIndex;
+	StatementIndex.Build(Function);
+	return StatementIndex.GetStatementLength(ExpectedStatementIndex, OutStatementLength);
 }
 
 
@@ -0,0 +1,344 @@
+#include "Toolkit/KismetBytecodeWalker.h"
+#include "UObject/Class.h"
+#include "UObject/Script.h"
+#include "UObject/UnrealType.h"
+
+void FSMLKismetBytecodeWalker::SkipString8(int32& ScriptIndex) const {
+	while (Script[ScriptIndex++] != 0);
+}
+
+void FSMLKismetBytecodeWalker::SkipString16(int32& ScriptIndex) const {
+	while (Script[ScriptIndex] != 0 || Script[ScriptIndex + 1] != 0) {
+		ScriptIndex += 2;
+	}
+	ScriptIndex += 2;
+}
+
+void FSMLKismetBytecodeWalker::SkipString(int32& ScriptIndex) const {
+	const uint8 Opcode = Script[ScriptIndex++];
+	if (Opcode == EX_StringConst) {
+		SkipString8(ScriptIndex);
+	} else {
+		checkf(Opcode == EX_UnicodeStringConst, TEXT("Unexpected string opcode %d"), Opcode);
+		SkipString16(ScriptIndex);
+	}
+}
+
+void FSMLKismetBytecodeWalker::WalkStatements(int32 StartOffset, ISMLKismetBytecodeVisitor& Visitor) const {
+	int32 ScriptIndex = StartOffset;
+	while (ScriptIndex < Script.Num()) {
+		int32 ConsumedLength;
+		if (Visitor.ConsumeStatement(ScriptIndex, ConsumedLength)) {
+			if (ensureMsgf(ConsumedLength > 0 && ScriptIndex + ConsumedLength <= Script.Num(),
+				TEXT("Visitor consumed %d bytes of statement at %d, outside of %d bytes long script"), ConsumedLength, ScriptIndex, Script.Num())) {
+				ScriptIndex += ConsumedLength;
+				continue;
+			}
+		}
+		//Fall back to walking statement when the visitor did not consume it or reported invalid length
+		WalkExpression(ScriptIndex, &Visitor, 0);
+	}
+}
+
+void FSMLKismetBytecodeWalker::WalkExpression(int32& ScriptIndex, ISMLKismetBytecodeVisitor* Visitor, int32 Depth) const {
+	const int32 ExpressionOffset = ScriptIndex;
+	const EExprToken Opcode = (EExprToken) Script[ScriptIndex++];
+
+	//Walks a single sub-expression of this expression
+	auto WalkSubExpression = [&]() {
+		WalkExpression(ScriptIndex, Visitor, Depth + 1);
+	};
+	//Walks sub-expressions until provided terminator opcode, and skips the terminator itself
+	auto WalkSubExpressionList = [&](const uint8 TerminatorOpcode) {
+		while (Script[ScriptIndex] != TerminatorOpcode) {
+			WalkSubExpression();
+		}
+		ScriptIndex++;
+	};
+
+	switch (Opcode) {
+	case EX_PrimitiveCast:
+		{
+			const uint8 ConversionType = Script[ScriptIndex++];
+			if (ConversionType == ECastToken::CST_ObjectToInterface) {
+				ScriptIndex += sizeof(ScriptPointerType);
+			}
+			WalkSubExpression();
+			break;
+		}
+	case EX_SetSet:
+	case EX_SetMap:
+		{
+			WalkSubExpression();
+			ScriptIndex += sizeof(int32); //Element amount
+			WalkSubExpressionList(Opcode == EX_SetSet ? EX_EndSet : EX_EndMap);
+			break;
+		}
+	case EX_SetConst:
+	case EX_ArrayConst:
+		{
+			ScriptIndex += sizeof(ScriptPointerType) + sizeof(int32); //Inner property and element amount
+			WalkSubExpressionList(Opcode == EX_SetConst ? EX_EndSetConst : EX_EndArrayConst);
+			break;
+		}
+	case EX_MapConst:
+		{
+			ScriptIndex += 2 * sizeof(ScriptPointerType) + sizeof(int32); //Key and value properties, element amount
+			WalkSubExpressionList(EX_EndMapConst);
+			break;
+		}
+	case EX_SetArray:
+		{
+			WalkSubExpression();
+			WalkSubExpressionList(EX_EndArray);
+			break;
+		}
+	case EX_ObjToInterfaceCast:
+	case EX_CrossInterfaceCast:
+	case EX_InterfaceToObjCast:
+	case EX_MetaCast:
+	case EX_DynamicCast:
+	case EX_LetValueOnPersistentFrame:
+	case EX_StructMemberContext:
+		{
+			ScriptIndex += sizeof(ScriptPointerType);
+			WalkSubExpression();
+			break;
+		}
+	case EX_Let:
+		{
+			ScriptIndex += sizeof(ScriptPointerType);
+			WalkSubExpression();
+			WalkSubExpression();
+			break;
+		}
+	case EX_LetObj:
+	case EX_LetWeakObjPtr:
+	case EX_LetBool:
+	case EX_LetDelegate:
+	case EX_LetMulticastDelegate:
+	case EX_AddMulticastDelegate:
+	case EX_RemoveMulticastDelegate:
+	case EX_ArrayGetByRef:
+		{
+			WalkSubExpression();
+			WalkSubExpression();
+			break;
+		}
+	case EX_ComputedJump:
+	case EX_InterfaceContext:
+	case EX_Return:
+	case EX_SoftObjectConst:
+	case EX_FieldPathConst:
+	case EX_ClearMulticastDelegate:
+	case EX_PopExecutionFlowIfNot:
+		{
+			WalkSubExpression();
+			break;
+		}
+	case EX_LocalVirtualFunction:
+	case EX_VirtualFunction:
+		{
+			ScriptIndex += sizeof(FScriptName);
+			WalkSubExpressionList(EX_EndFunctionParms);
+			break;
+		}
+	case EX_LocalFinalFunction:
+	case EX_FinalFunction:
+	case EX_CallMath:
+		{
+			ScriptIndex += sizeof(ScriptPointerType);
+			WalkSubExpressionList(EX_EndFunctionParms);
+			break;
+		}
+	case EX_CallMulticastDelegate:
+		{
+			ScriptIndex += sizeof(ScriptPointerType);
+			WalkSubExpression();
+			WalkSubExpressionList(EX_EndFunctionParms);
+			break;
+		}
+	case EX_Jump:
+	case EX_SkipOffsetConst:
+	case EX_PushExecutionFlow:
+		{
+			ScriptIndex += sizeof(CodeSkipSizeType);
+			break;
+		}
+	case EX_JumpIfNot:
+		{
+			ScriptIndex += sizeof(CodeSkipSizeType);
+			WalkSubExpression();
+			break;
+		}
+	case EX_LocalVariable:
+	case EX_DefaultVariable:
+	case EX_InstanceVariable:
+	case EX_LocalOutVariable:
+	case EX_ClassSparseDataVariable:
+	case EX_ObjectConst:
+		{
+			ScriptIndex += sizeof(ScriptPointerType);
+			break;
+		}
+	case EX_DeprecatedOp4A:
+	case EX_Nothing:
+	case EX_EndOfScript:
+	case EX_IntZero:
+	case EX_IntOne:
+	case EX_True:
+	case EX_False:
+	case EX_NoObject:
+	case EX_NoInterface:
+	case EX_Self:
+	case EX_PopExecutionFlow:
+	case EX_Breakpoint:
+	case EX_WireTracepoint:
+	case EX_Tracepoint:
+		{
+			break;
+		}
+	case EX_ClassContext:
+	case EX_Context:
+	case EX_Context_FailSilent:
+		{
+			WalkSubExpression();
+			ScriptIndex += sizeof(CodeSkipSizeType) + sizeof(ScriptPointerType); //Skip offset for NULL and r-value property
+			WalkSubExpression();
+			break;
+		}
+	case EX_IntConst:
+	case EX_FloatConst:
+		{
+			ScriptIndex += sizeof(int32);
+			break;
+		}
+	case EX_ByteConst:
+	case EX_IntConstByte:
+		{
+			ScriptIndex += sizeof(uint8);
+			break;
+		}
+	case EX_Int64Const:
+	case EX_UInt64Const:
+		{
+			ScriptIndex += sizeof(uint64);
+			break;
+		}
+	case EX_NameConst:
+	case EX_InstanceDelegate:
+		{
+			ScriptIndex += sizeof(FScriptName);
+			break;
+		}
+	case EX_StringConst:
+		{
+			SkipString8(ScriptIndex);
+			break;
+		}
+	case EX_UnicodeStringConst:
+		{
+			SkipString16(ScriptIndex);
+			break;
+		}
+	case EX_TextConst:
+		{
+			const EBlueprintTextLiteralType TextLiteralType = (EBlueprintTextLiteralType) Script[ScriptIndex++];
+			switch (TextLiteralType) {
+			case EBlueprintTextLiteralType::Empty:
+				break;
+			case EBlueprintTextLiteralType::LocalizedText:
+				SkipString(ScriptIndex);
+				SkipString(ScriptIndex);
+				SkipString(ScriptIndex);
+				break;
+			case EBlueprintTextLiteralType::InvariantText:
+			case EBlueprintTextLiteralType::LiteralString:
+				SkipString(ScriptIndex);
+				break;
+			case EBlueprintTextLiteralType::StringTableEntry:
+				ScriptIndex += sizeof(ScriptPointerType);
+				SkipString(ScriptIndex);
+				SkipString(ScriptIndex);
+				break;
+			default:
+				checkf(false, TEXT("Unknown EBlueprintTextLiteralType %d"), (uint8) TextLiteralType);
+				break;
+			}
+			break;
+		}
+	case EX_RotationConst:
+	case EX_VectorConst:
+		{
+			ScriptIndex += 3 * sizeof(float);
+			break;
+		}
+	case EX_TransformConst:
+		{
+			ScriptIndex += 10 * sizeof(float);
+			break;
+		}
+	case EX_StructConst:
+		{
+			UScriptStruct* Struct = (UScriptStruct*) FPlatformMemory::ReadUnaligned<ScriptPointerType>(&Script[ScriptIndex]);
+			ScriptIndex += sizeof(ScriptPointerType) + sizeof(int32); //Struct pointer and serialized size
+
+			//Needs to be kept in sync with KismetCompilerVMBackend, same as the disassembler
+			for (FProperty* StructProp = Struct->PropertyLink; StructProp; StructProp = StructProp->PropertyLinkNext) {
+				if (StructProp->PropertyFlags & (CPF_Transient | CPF_EditorOnly)) {
+					continue;
+				}
+				for (int32 ArrayIter = 0; ArrayIter < StructProp->ArrayDim; ++ArrayIter) {
+					WalkSubExpression();
+				}
+			}
+			ScriptIndex++; //Skip over EX_EndStructConst
+			break;
+		}
+	case EX_Assert:
+		{
+			ScriptIndex += sizeof(uint16) + sizeof(uint8); //Line number and debug mode flag
+			WalkSubExpression();
+			break;
+		}
+	case EX_BindDelegate:
+		{
+			ScriptIndex += sizeof(FScriptName);
+			WalkSubExpression();
+			WalkSubExpression();
+			break;
+		}
+	case EX_InstrumentationEvent:
+		{
+			const uint8 EventType = Script[ScriptIndex++];
+			if (EventType == EScriptInstrumentation::InlineEvent) {
+				ScriptIndex += sizeof(FScriptName);
+			}
+			break;
+		}
+	case EX_SwitchValue:
+		{
+			const uint16 NumCases = FPlatformMemory::ReadUnaligned<uint16>(&Script[ScriptIndex]);
+			ScriptIndex += sizeof(uint16) + sizeof(CodeSkipSizeType); //Case amount and offset to switch end
+
+			WalkSubExpression();
+			for (uint16 CaseIndex = 0; CaseIndex < NumCases; ++CaseIndex) {
+				WalkSubExpression(); //Case value
+				ScriptIndex += sizeof(CodeSkipSizeType); //Offset to next case
+				WalkSubExpression(); //Case result
+			}
+			WalkSubExpression(); //Default result
+			break;
+		}
+	default:
+		{
+			// This should never occur.
+			checkf(0, TEXT("Unknown bytecode 0x%02X"), (uint8) Opcode);
+			break;
+		}
+	}
+
+	if (Visitor != NULL) {
+		Visitor->VisitExpression(Opcode, ExpressionOffset, ScriptIndex - ExpressionOffset, Depth);
+	}
+}
@@ -0,0 +1,81 @@
+#include "Toolkit/KismetStatementIndex.h"
+#include "Algo/BinarySearch.h"
+#include "Toolkit/KismetBytecodeWalker.h"
+#include "UObject/Script.h"
+
+/** Collects statements reported by the walker into the index arrays */
+class FStatementIndexBuilder : public ISMLKismetBytecodeVisitor {
+public:
+	TArray<int32>& StatementOffsets;
+	TArray<uint8>& StatementOpcodes;
+
+	FStatementIndexBuilder(TArray<int32>& InStatementOffsets, TArray<uint8>& InStatementOpcodes) :
+		StatementOffsets(InStatementOffsets), StatementOpcodes(InStatementOpcodes) {}
+
+	virtual void VisitExpression(uint8 Opcode, int32 Offset, int32 Length, int32 Depth) override {
+		if (Depth == 0) {
+			StatementOffsets.Add(Offset);
+			StatementOpcodes.Add(Opcode);
+		}
+	}
+};
+
+void FSMLKismetStatementIndex::Build(UStruct* Function) {
+	StatementOffsets.Reset();
+	StatementOpcodes.Reset();
+	AppendStatements(Function, 0);
+}
+
+bool FSMLKismetStatementIndex::GetStatementLength(int32 StatementIndex, int32& OutStatementLength) const {
+	const int32 Position = Algo::BinarySearch(StatementOffsets, StatementIndex);
+	if (Position == INDEX_NONE) {
+		//Provided index is either inside of some statement or outside of the script
+		OutStatementLength = -1;
+		return false;
+	}
+	const int32 NextStatementIndex = Position + 1 < StatementOffsets.Num() ? StatementOffsets[Position + 1] : ScriptSize;
+	OutStatementLength = NextStatementIndex - StatementIndex;
+	return true;
+}
+
+bool FSMLKismetStatementIndex::FindFirstStatementOfType(int32 StartIndex, uint8 StatementOpcode, int32& OutStatementIndex) const {
+	for (int32 Position = Algo::LowerBound(StatementOffsets, StartIndex); Position < StatementOffsets.Num(); Position++) {
+		if (StatementOpcodes[Position] == StatementOpcode) {
+			OutStatementIndex = StatementOffsets[Position];
+			return true;
+		}
+	}
+	//We haven't found any statement with matching opcode
+	OutStatementIndex = -1;
+	return false;
+}
+
+void FSMLKismetStatementIndex::NotifyScriptPatched(UStruct* Function, int32 PatchOffset, int32 PatchLength, int32 AppendedCodeOffset) {
+	//Drop statements that were overwritten by the patch
+	const int32 FirstRemoved = Algo::LowerBound(StatementOffsets, PatchOffset);
+	const int32 LastRemoved = Algo::LowerBound(StatementOffsets, PatchOffset + PatchLength);
+	StatementOffsets.RemoveAt(FirstRemoved, LastRemoved - FirstRemoved, false);
+	StatementOpcodes.RemoveAt(FirstRemoved, LastRemoved - FirstRemoved, false);
+
+	//Patched range now consists of the jump and single byte EX_EndOfScript statements filling the rest of it
+	const int32 JumpLength = 1 + sizeof(CodeSkipSizeType);
+	const int32 NumPatchedStatements = 1 + (PatchLength - JumpLength);
+	StatementOffsets.InsertUninitialized(FirstRemoved, NumPatchedStatements);
+	StatementOpcodes.InsertUninitialized(FirstRemoved, NumPatchedStatements);
+
+	StatementOffsets[FirstRemoved] = PatchOffset;
+	StatementOpcodes[FirstRemoved] = EX_Jump;
+	for (int32 i = 1; i < NumPatchedStatements; i++) {
+		StatementOffsets[FirstRemoved + i] = PatchOffset + JumpLength + i - 1;
+		StatementOpcodes[FirstRemoved + i] = EX_EndOfScript;
+	}
+
+	//Parse only the newly appended code, everything before it is already indexed
+	AppendStatements(Function, AppendedCodeOffset);
+}
+
+void FSMLKismetStatementIndex::AppendStatements(UStruct* Function, int32 StartOffset) {
+	FStatementIndexBuilder Builder{StatementOffsets, StatementOpcodes};
+	FSMLKismetBytecodeWalker(Function->Script).WalkStatements(StartOffset, Builder);
+	ScriptSize = Function->Script.Num();
+}
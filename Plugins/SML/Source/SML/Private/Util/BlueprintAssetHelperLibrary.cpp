@@ -1,8 +1,7 @@
 #include "Util/BlueprintAssetHelperLibrary.h"
 #include "AssetRegistryModule.h"
 #include "SatisfactoryModLoader.h"
-#include "Interfaces/IPluginManager.h"
-#include "ModLoading/ModLoadingLibrary.h"
+#include "Util/PluginOwnershipIndex.h"
 
 void UBlueprintAssetHelperLibrary::FindBlueprintAssetsByTag(UClass* BaseClass, const FName TagName, const TArray<FString>& TagValues, TArray<UClass*>& FoundAssets) {
 	
@@ -55,16 +54,10 @@ void UBlueprintAssetHelperLibrary::FindNativeClassesByType(UClass* BaseClass, TA
 }
 
 FString FindOwnerPluginForModuleName(const FString& ModuleName, bool bTreatNonModPluginsAsGame) {
-	//Iterate mod plugin modules and find the owning plugin for them
-	const TArray<TSharedRef<IPlugin>> EnabledPlugins = IPluginManager::Get().GetEnabledPlugins();
-	for (const TSharedRef<IPlugin>& Plugin : EnabledPlugins) {
-		if (UModLoadingLibrary::IsPluginAMod(Plugin.Get()) || !bTreatNonModPluginsAsGame) {
-			for (const FModuleDescriptor& ModuleDescriptor : Plugin->GetDescriptor().Modules) {
-				if (ModuleDescriptor.Name == *ModuleName) {
-					return Plugin->GetName();
-				}
-			}
-		}
+	//Look up plugin owning the module in the ownership index, only considering mods if other plugins are treated as game
+	FPluginOwnerEntry OwnerEntry;
+	if (FPluginOwnershipIndex::Get().FindOwnerForModule(*ModuleName, bTreatNonModPluginsAsGame, OwnerEntry)) {
+		return OwnerEntry.PluginName;
 	}
 	
 	//If package is not owned by any of the mod modules, we assume it's game or engine native module
@@ -73,21 +66,16 @@ FString FindOwnerPluginForModuleName(const FString& ModuleName, bool bTreatNonMo
 }
 
 FString FindOwnerPluginForMountPoint(const FString& MountPoint, bool bTreatNonModPluginsAsGame) {
-	const TArray<TSharedRef<IPlugin>> EnabledPlugins = IPluginManager::Get().GetEnabledPluginsWithContent();
-	for (const TSharedRef<IPlugin>& Plugin : EnabledPlugins) {
-		
-		//Check whenever given mount point is owned by this plugin
-		const FString PluginMountPath = Plugin->GetMountedAssetPath();
-		if (PluginMountPath.Mid(1, PluginMountPath.Len() - 2) == MountPoint) {
-			//We only want to use plugin name for mods
-			if (UModLoadingLibrary::IsPluginAMod(Plugin.Get()) || !bTreatNonModPluginsAsGame) {
-				return Plugin->GetName();
-			}
-			
-			//This mount point is plugin owned, but does not represent a mod
-			//Assume FactoryGame/Engine plugin
-			return FACTORYGAME_MOD_NAME;
+	FPluginOwnerEntry OwnerEntry;
+	if (FPluginOwnershipIndex::Get().FindOwnerForMountPoint(MountPoint, OwnerEntry)) {
+		//We only want to use plugin name for mods
+		if (OwnerEntry.bIsMod || !bTreatNonModPluginsAsGame) {
+			return OwnerEntry.PluginName;
 		}
+		
+		//This mount point is plugin owned, but does not represent a mod
+		//Assume FactoryGame/Engine plugin
+		return FACTORYGAME_MOD_NAME;
 	}
 
 	//Return empty string if we haven't found any associated plugin
@@ -95,14 +83,16 @@ FString FindOwnerPluginForMountPoint(const FString& MountPoint, bool bTreatNonMo
 }
 
 FString UBlueprintAssetHelperLibrary::FindPluginNameByObjectPath(const FString& ObjectPath, bool bTreatNonModPluginsAsGame) {
-	//Retrieve mount point for package name
-	const FString PackageMountPoint = FPackageName::GetPackageMountPoint(ObjectPath).ToString();
+	//Retrieve mount point for package name. It is always the first path segment, so we extract it directly
+	//instead of going through FPackageName::GetPackageMountPoint, which tests the path against every registered mount point
+	const int32 MountPointEnd = ObjectPath.Len() > 1 && ObjectPath[0] == TEXT('/') ? ObjectPath.Find(TEXT("/"), ESearchCase::CaseSensitive, ESearchDir::FromStart, 1) : INDEX_NONE;
 
 	//Make sure that package name represents a valid mount point
-	if (PackageMountPoint == TEXT("None")) {
+	if (MountPointEnd == INDEX_NONE) {
 		UE_LOG(LogSatisfactoryModLoader, Error, TEXT("FindPluginNameByObjectPath: received invalid path with no associated mount point: %s"), *ObjectPath);
 		return TEXT("");
 	}
+	const FString PackageMountPoint = ObjectPath.Mid(1, MountPointEnd - 1);
 
 	//Game mount point is owned by Satisfactory itself, since we now have a strong content separation between mods and the game
 	//We use StartsWith here because editor can create sub-mounts under /Game/ for representing shared content packs
@@ -0,0 +1,108 @@
+#include "Util/PluginOwnershipIndex.h"
+#include "Interfaces/IPluginManager.h"
+#include "ModLoading/ModLoadingLibrary.h"
+
+FPluginOwnershipInfo FPluginOwnershipInfo::FromPlugin(IPlugin& Plugin) {
+    FPluginOwnershipInfo OwnershipInfo;
+    OwnershipInfo.Owner.PluginName = Plugin.GetName();
+    OwnershipInfo.Owner.bIsMod = UModLoadingLibrary::IsPluginAMod(Plugin);
+
+    //Mounted asset path has the form of /PluginName/, we index it by the name between slashes
+    if (Plugin.CanContainContent()) {
+        const FString PluginMountPath = Plugin.GetMountedAssetPath();
+        OwnershipInfo.MountPoint = PluginMountPath.Mid(1, PluginMountPath.Len() - 2);
+    }
+    for (const FModuleDescriptor& ModuleDescriptor : Plugin.GetDescriptor().Modules) {
+        OwnershipInfo.ModuleNames.Add(ModuleDescriptor.Name);
+    }
+    return OwnershipInfo;
+}
+
+FPluginOwnershipIndex::FPluginOwnershipIndex(bool bTrackPluginManager) : bTrackPluginManager(bTrackPluginManager) {
+}
+
+FPluginOwnershipIndex& FPluginOwnershipIndex::Get() {
+    static FPluginOwnershipIndex PluginOwnershipIndex(true);
+    return PluginOwnershipIndex;
+}
+
+void FPluginOwnershipIndex::Invalidate() {
+    FRWScopeLock Lock(IndexLock, SLT_Write);
+    bIndexBuilt = false;
+}
+
+void FPluginOwnershipIndex::Build(const TArray<FPluginOwnershipInfo>& Plugins) {
+    FRWScopeLock Lock(IndexLock, SLT_Write);
+    BuildInternal(Plugins);
+}
+
+bool FPluginOwnershipIndex::FindOwnerForMountPoint(const FString& MountPoint, FPluginOwnerEntry& OutOwner) {
+    //Misses are common (vanilla content looked up in the mods only index), so they never touch the plugin manager
+    EnsureIndexUpToDate();
+    FRWScopeLock Lock(IndexLock, SLT_ReadOnly);
+
+    const FPluginOwnerEntry* OwnerEntry = OwnerByMountPoint.Find(MountPoint);
+    if (OwnerEntry) {
+        OutOwner = *OwnerEntry;
+        return true;
+    }
+    return false;
+}
+
+bool FPluginOwnershipIndex::FindOwnerForModule(FName ModuleName, bool bModsOnly, FPluginOwnerEntry& OutOwner) {
+    EnsureIndexUpToDate();
+    FRWScopeLock Lock(IndexLock, SLT_ReadOnly);
+
+    const FPluginOwnerEntry* OwnerEntry = (bModsOnly ? ModOwnerByModuleName : OwnerByModuleName).Find(ModuleName);
+    if (OwnerEntry) {
+        OutOwner = *OwnerEntry;
+        return true;
+    }
+    return false;
+}
+
+void FPluginOwnershipIndex::EnsureIndexUpToDate() {
+    if (!bTrackPluginManager) {
+        return;
+    }
+    {
+        FRWScopeLock Lock(IndexLock, SLT_ReadOnly);
+        if (bIndexBuilt) {
+            return;
+        }
+    }
+    FRWScopeLock Lock(IndexLock, SLT_Write);
+    //Another thread could have rebuilt the index while we were waiting for the write lock
+    if (bIndexBuilt) {
+        return;
+    }
+    const TArray<TSharedRef<IPlugin>> EnabledPlugins = IPluginManager::Get().GetEnabledPlugins();
+    TArray<FPluginOwnershipInfo> Plugins;
+    Plugins.Reserve(EnabledPlugins.Num());
+    for (const TSharedRef<IPlugin>& Plugin : EnabledPlugins) {
+        Plugins.Add(FPluginOwnershipInfo::FromPlugin(Plugin.Get()));
+    }
+    BuildInternal(Plugins);
+}
+
+void FPluginOwnershipIndex::BuildInternal(const TArray<FPluginOwnershipInfo>& Plugins) {
+    OwnerByMountPoint.Reset();
+    OwnerByModuleName.Reset();
+    ModOwnerByModuleName.Reset();
+
+    for (const FPluginOwnershipInfo& Plugin : Plugins) {
+        if (!Plugin.MountPoint.IsEmpty() && !OwnerByMountPoint.Contains(Plugin.MountPoint)) {
+            OwnerByMountPoint.Add(Plugin.MountPoint, Plugin.Owner);
+        }
+        //First plugin declaring the module wins, same as with the linear search we used before
+        for (const FName& ModuleName : Plugin.ModuleNames) {
+            if (!OwnerByModuleName.Contains(ModuleName)) {
+                OwnerByModuleName.Add(ModuleName, Plugin.Owner);
+            }
+            if (Plugin.Owner.bIsMod && !ModOwnerByModuleName.Contains(ModuleName)) {
+                ModOwnerByModuleName.Add(ModuleName, Plugin.Owner);
+            }
+        }
+    }
+    bIndexBuilt = true;
+}
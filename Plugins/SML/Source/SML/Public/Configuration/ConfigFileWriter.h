@@ -0,0 +1,62 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+/**
+ * Writes serialized configuration files on a background thread
+ * Writes of the same file are coalesced, so only the latest queued contents are written,
+ * and every file is written into a temporary file first and then renamed over the original one in a single step,
+ * so a crash in the middle of the write never leaves a truncated or missing configuration behind
+ *
+ * Writes can only be queued and flushed from the game thread
+ */
+class SML_API FConfigFileWriter {
+public:
+    ~FConfigFileWriter();
+
+    /** Queues contents to be written into the file, replacing any contents queued for it that haven't been written yet */
+    void EnqueueWrite(const FString& FilePath, FString&& FileContents);
+
+    /** Queues binary contents to be written into the file, same as the text version */
+    void EnqueueWrite(const FString& FilePath, TArray<uint8>&& FileContents);
+
+    /** Blocks until all queued writes have been performed */
+    void Flush();
+
+    /**
+     * Restores the file from the backup if the previous write has been interrupted before the new file was moved in place
+     * Backups are only made on platforms without an atomic file replace, elsewhere this is a no-op
+     */
+    static void RecoverInterruptedWrite(const FString& FilePath);
+private:
+    /** Contents of the single queued file write */
+    struct FPendingWrite {
+        FString TextContents;
+        TArray<uint8> BinaryContents;
+        bool bIsBinary = false;
+    };
+
+    /** Adds write to the queue and starts the worker if needed */
+    void EnqueueWriteInternal(const FString& FilePath, FPendingWrite&& PendingWrite);
+
+    /** Runs on the worker thread, writes queued files until the queue is empty */
+    void ProcessPendingWrites();
+
+    /** Writes contents to the temporary file and then moves it over the target file */
+    static bool WriteFileAtomically(const FString& FilePath, const FPendingWrite& PendingWrite);
+
+    /** Renames source file over the target file, replacing it atomically on platforms that support it */
+    static bool ReplaceFile(const FString& FilePath, const FString& SourceFilePath);
+
+    /** Returns path of the backup file kept during the non-atomic file replace */
+    static FString GetBackupFilePath(const FString& FilePath);
+
+    /** Guards PendingWrites and bWriteTaskRunning */
+    FCriticalSection QueueLock;
+    /** Contents of the files waiting to be written, keyed by file path */
+    TMap<FString, FPendingWrite> PendingWrites;
+    /** True when worker task is running. Worker keeps running until it drains the queue */
+    bool bWriteTaskRunning = false;
+    /** Currently running worker task. Only accessed from the game thread */
+    TFuture<void> WriteTask;
+};
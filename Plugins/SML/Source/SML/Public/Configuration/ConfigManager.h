@@ -2,10 +2,14 @@
 #include "CoreMinimal.h"
 #include "Subsystems/EngineSubsystem.h"
 #include "Configuration/ModConfiguration.h"
+#include "Configuration/ConfigFileWriter.h"
+#include "Configuration/RawFileFormat/Binary/BinaryRawFormatConverter.h"
+#include "Configuration/ConfigStructFillPlan.h"
 #include "Reflection/ReflectionHelper.h"
+#include "Dom/JsonObject.h"
 #include "ConfigManager.generated.h"
 
-//Whenever to use FillConfigStruct optimization caching results in a single struct and then copying it
+//Whenever to use FillConfigStruct optimization compiling a fill plan for each struct type and executing it directly
 //When disabled, each FillConfigStruct call will cause full population of passed struct through UConfigValue chain
 #define OPTIMIZE_FILL_CONFIGURATION_STRUCT 1
 
@@ -31,9 +35,23 @@ public:
     UPROPERTY()
     URootConfigValueHolder* RootValue;
 
-    /** Cached structs populated with this configuration values. Used for faster FillConfigStruct implementation */
+    /** Fill plans compiled for struct types filled from this configuration. Used for faster FillConfigStruct implementation */
     UPROPERTY()
-    TMap<UScriptStruct*, FReflectedObject> CachedValues;
+    TMap<UScriptStruct*, FConfigStructFillPlan> CachedFillPlans;
+};
+
+/** Contents of the configuration file read from the file system */
+struct SML_API FConfigurationFileContents {
+    /** Parsed contents of the configuration file, NULL if binary cache is used instead or file failed to load */
+    TSharedPtr<FJsonObject> JsonObject;
+    /** Contents of the binary cache matching the configuration file, empty if there is no up to date cache */
+    TArray<uint8> BinaryCacheData;
+    /** Describes configuration file as it was read, or as it was when binary cache has been written */
+    FBinaryConfigCacheHeader SourceFileInfo;
+    /** Describes why the file failed to load or parse. Only logged once the file is actually loaded for a registered configuration */
+    FString ErrorMessage;
+
+    FORCEINLINE bool IsValid() const { return JsonObject.IsValid() || BinaryCacheData.Num() > 0; }
 };
 
 /** Manages mod configuration states */
@@ -45,11 +63,21 @@ public:
     UFUNCTION(BlueprintCallable)
     void ReloadModConfigurations();
 
-    /** Flushes all pending saves and forces manager to write them into filesystem */
+    /**
+     * Flushes all pending saves and forces manager to write them into filesystem
+     * Configurations are serialized immediately, but files are written on a background thread
+     */
     UFUNCTION(BlueprintCallable)
     void FlushPendingSaves();
 
-    /** Marks configuration as dirty and pending save */
+    /** Flushes all pending saves and blocks until they have been written into the filesystem */
+    UFUNCTION(BlueprintCallable)
+    void FlushPendingSavesAndWait();
+
+    /**
+     * Marks configuration as dirty and pending save
+     * Whole configuration is serialized again, so values changed without marking their properties dirty are saved too
+     */
     UFUNCTION(BlueprintCallable)
     void MarkConfigurationDirty(const FConfigId& ConfigId);
     
@@ -74,32 +102,89 @@ public:
     UConfigPropertySection* GetConfigurationRootSection(const FConfigId& ConfigId) const;
 
     void Initialize(FSubsystemCollectionBase& Collection) override;
+    void Deinitialize() override;
     
     /** Returns configuration folder path used by config manager */
     static FString GetConfigurationFolderPath();
+
+#if WITH_DEV_AUTOMATION_TESTS
+    /** Serializes property to JSON exactly like configuration saves do, reusing JSON cached by the unchanged properties. Only for tests */
+    static TSharedPtr<FJsonValue> SerializePropertyToJsonForTesting(const UConfigProperty* Property) { return SerializePropertyToJson(Property); }
+
+    /** Registers root section under the provided id without configuration class and without loading it from the disk. Only for tests */
+    void RegisterRootSectionForTesting(const FConfigId& ConfigId, UConfigPropertySection* RootSection);
+
+    /** Returns true if configuration is queued to be saved. Only for tests */
+    bool IsConfigurationPendingSaveForTesting(const FConfigId& ConfigId) const { return PendingSaveConfigurations.Contains(ConfigId); }
+
+    /** Drops configuration registered for testing along with its pending save, so it is never written into the file system */
+    void UnregisterConfigurationForTesting(const FConfigId& ConfigId);
+#endif
 private:
     friend class FSatisfactoryModLoader;
 	friend class URuntimeBlueprintFunctionLibrary;
+    friend class URootConfigValueHolder;
+    friend class UGameInstanceModuleManager;
     /** Returns path to the provided configuration */
     static FString GetConfigurationFilePath(const FConfigId& ConfigId);
 
+    /** Returns path to the binary cache of the configuration file at the provided path */
+    static FString GetBinaryCacheFilePath(const FString& ConfigurationFilePath);
+
     void ReplaceConfigurationClass(FRegisteredConfigurationData* ExistingData, TSubclassOf<UModConfiguration> NewConfiguration);
     
     void OnTimerManagerAvailable(class FTimerManager* TimerManager);
 
     void OnConfigMarkedDirty(FTimerManager* TimerManager);
 
-    /** Saves configuration with specified id into the file system */
+    /** Queues configuration save, reusing JSON cached by the properties that have not been marked dirty since the last save */
+    void QueueConfigurationSave(const FConfigId& ConfigId);
+
+    /** Serializes configuration with specified id and queues it to be written into the file system */
     void SaveConfigurationInternal(const FConfigId& ConfigId);
 
+    /**
+     * Converts property value to JSON, reusing JSON values cached by properties that haven't changed since the last save
+     * Sections and arrays are assembled from the values of their nested properties, so changing a single value
+     * only requires re-serializing it and the properties containing it
+     */
+    static TSharedPtr<FJsonValue> SerializePropertyToJson(const UConfigProperty* Property);
+
+    /**
+     * Reads configuration file, using its binary cache instead of parsing it if the cache is up to date
+     * Can be called from any thread. Returns invalid contents with the error message set on failure
+     */
+    static FConfigurationFileContents ReadConfigurationFile(const FString& ConfigurationFilePath, bool bAllowBinaryCache);
+
+    /** Starts reading and parsing configuration files of the loaded mods on worker threads, ahead of configurations being registered */
+    void PrefetchConfigurationFiles();
+
+    /**
+     * Drops prefetched files that have not been taken by any registered configuration
+     * Called once game instance modules have been initialized, since no more configurations are registered after that
+     */
+    void DiscardPrefetchedConfigurationFiles();
+
+    /**
+     * Takes prefetched contents of the configuration file, waiting for the prefetch to finish if needed
+     * Returns false if file has not been prefetched. OutContents are invalid if file failed to load or parse
+     */
+    bool TakePrefetchedConfigurationFile(const FString& ConfigurationFilePath, FConfigurationFileContents& OutContents);
+
     /** Loads configuration and optionally overwrites it on the disk */
     void LoadConfigurationInternal(const FConfigId& ConfigId, class URootConfigValueHolder* RootConfigValueHolder, bool bSaveOnSchemaChange);
 
-    /** Updates cached struct values with actual values from configuration */
-    void ReinitializeCachedStructs(const FConfigId& ConfigId);
+    /** Configurations pending save. Multiple dirty marks of the same configuration result in a single save */
+    TSet<FConfigId> PendingSaveConfigurations;
+
+    /** Writes serialized configurations into the file system on a background thread */
+    FConfigFileWriter ConfigFileWriter;
+
+    /** Result of the running configuration file prefetch, keyed by normalized file path */
+    TFuture<TMap<FString, FConfigurationFileContents>> PrefetchedConfigurationsFuture;
 
-    /** Array of all configurations pending save */
-    TArray<FConfigId> PendingSaveConfigurations;
+    /** Prefetched configuration files that have not been loaded yet. Each of them is only used for the first load */
+    TMap<FString, FConfigurationFileContents> PrefetchedConfigurations;
     
     /** Registered configurations */
     UPROPERTY()
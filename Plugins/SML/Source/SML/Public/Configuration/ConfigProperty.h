@@ -7,6 +7,7 @@
 
 class URawFormatValue;
 class UUserWidget;
+class FJsonValue;
 
 /**
  * Describes single value inside the configuration
@@ -49,6 +50,12 @@ public:
 	/** Marks this property directly, forcing file system synchronization to happen afterwards */
 	UFUNCTION(BlueprintCallable)
     virtual void MarkDirty();
+
+	/**
+	 * Drops cached serialized state of this property and all properties containing it, and optionally of all properties nested in it
+	 * Called automatically by MarkDirty, only needs to be called manually when property is changed without marking it dirty
+	 */
+	void InvalidateSerializationCache(bool bIncludeNestedProperties = true);
 	
     /** Creates widget instance for editing this configuration property's value. Can return NULL if property doesn't support direct UI editing */
     UFUNCTION(BlueprintPure, BlueprintNativeEvent, meta = (DefaultToSelf = "ParentWidget"))
@@ -61,4 +68,9 @@ public:
 	/** Fills variable of provided object with the value carried by this property */
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
     void FillConfigStruct(const FReflectedObject& ReflectedObject, const FString& VariableName) const;
+private:
+	friend class UConfigManager;
+
+	/** JSON representation of this property produced by the last save, reused by the config manager until property is changed */
+	mutable TSharedPtr<FJsonValue> CachedJsonValue;
 };
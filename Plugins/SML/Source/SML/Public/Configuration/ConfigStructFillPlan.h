@@ -0,0 +1,60 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "ConfigStructFillPlan.generated.h"
+
+class UConfigProperty;
+class UConfigPropertySection;
+
+/** Kind of the operation performed by the fill plan step */
+enum class EConfigFillStepType : uint8 {
+    Bool,
+    Integer,
+    Float,
+    String,
+    Class,
+    /** Resizes array to match configuration property and runs steps following this one for each element */
+    Array,
+    /** Calls FillConfigStruct on the configuration property, used for property types plan cannot write directly */
+    Fallback
+};
+
+/** Single operation of the fill plan, copying value of one configuration property into one struct field */
+struct SML_API FConfigFillStep {
+    EConfigFillStepType StepType;
+    /** Field written by this step and its offset relative to the start of the filled container */
+    FProperty* DestinationProperty = NULL;
+    int32 DestinationOffset = 0;
+    /** Property providing the value, resolved when plan is compiled. NULL for steps executed for array elements */
+    const UConfigProperty* SourceProperty = NULL;
+    /** Section keys leading to the source property from the array element, for steps executed for array elements */
+    TArray<FString> SourcePath;
+    /** Number of the steps following array step which are executed for each of the array elements */
+    int32 NumElementSteps = 0;
+    /** Struct containing the field and its offset, used by fallback steps to reflect the containing struct */
+    UScriptStruct* ContainerStruct = NULL;
+    int32 ContainerOffset = 0;
+    /** Name of the written field as passed to FillConfigStruct by fallback steps */
+    FString VariableName;
+};
+
+/**
+ * Precompiled list of operations filling script struct of specific type with the values of the configuration
+ * Struct fields are resolved once when plan is compiled, so executing it only writes values at known offsets,
+ * without going through FReflectedObject accessors and looking up properties by name for every field
+ *
+ * Plan references configuration properties directly, so it stays valid as long as configuration
+ * properties are not replaced. Values of the properties are read every time plan is executed
+ */
+USTRUCT()
+struct SML_API FConfigStructFillPlan {
+    GENERATED_BODY()
+public:
+    /** Compiles plan filling struct of the provided type with the values of the root section */
+    static FConfigStructFillPlan Compile(UScriptStruct* Struct, const UConfigPropertySection* RootSection);
+
+    /** Writes current configuration values into the struct of the type plan has been compiled for */
+    void Execute(void* StructValue) const;
+private:
+    /** Steps in execution order. Steps executed for array elements directly follow their array step */
+    TArray<FConfigFillStep> Steps;
+};
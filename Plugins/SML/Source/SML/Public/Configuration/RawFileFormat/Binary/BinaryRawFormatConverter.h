@@ -0,0 +1,40 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Configuration/RawFileFormat/RawFormatValue.h"
+
+/** Header of the binary configuration cache, describing the configuration file it has been generated from */
+struct SML_API FBinaryConfigCacheHeader {
+    /** Size of the source configuration file, in bytes */
+    int64 SourceFileSize = 0;
+    /** Modification time of the source configuration file */
+    FDateTime SourceFileTimestamp;
+    /** Hash of the source configuration file contents */
+    uint64 SourceFileHash = 0;
+    /** Version of the mod at the moment cache was written, same value as the one recorded in SMLConfigModVersionField */
+    FString ModVersion;
+
+    /** Returns true when both headers describe the same source file */
+    FORCEINLINE bool MatchesSourceFile(const FBinaryConfigCacheHeader& Other) const {
+        return SourceFileSize == Other.SourceFileSize && SourceFileTimestamp == Other.SourceFileTimestamp && SourceFileHash == Other.SourceFileHash;
+    }
+};
+
+/**
+ * Class handling conversion from raw format value to compact binary form and vice versa
+ * Binary form is only used as a cache of the human-readable configuration files, allowing to skip
+ * JSON parsing when configuration file hasn't changed since the last time it was loaded
+ *
+ * Binary data is validated while reading, and any mismatch or malformed data results in
+ * reading failure instead of a crash, so callers can fall back to the source file
+ */
+class SML_API FBinaryRawFormatConverter {
+public:
+    /** Encodes raw format value into the binary form, prefixed with the provided header */
+    static void ConvertToBinary(const URawFormatValue* RawFormatValue, const FBinaryConfigCacheHeader& Header, TArray<uint8>& OutData);
+
+    /** Reads header of the binary data. Returns false if data is not a binary cache of the current format version */
+    static bool ReadHeader(TArrayView<const uint8> Data, FBinaryConfigCacheHeader& OutHeader);
+
+    /** Decodes raw format value from the binary data, using specified object as Outer for raw value. Returns NULL if data is malformed */
+    static URawFormatValue* ConvertToRawFormat(UObject* Outer, TArrayView<const uint8> Data);
+};
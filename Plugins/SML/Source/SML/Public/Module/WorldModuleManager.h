@@ -16,6 +16,9 @@ private:
     /** Root module list for fast iteration according to order of registration */
     UPROPERTY()
     TArray<UWorldModule*> RootModuleList;
+
+    /** Vanilla content being streamed in since the world was created, released once the content registry takes over */
+    TSharedPtr<struct FStreamableHandle> VanillaContentStreamHandle;
 public:
     /** Retrieves world module by provided mod reference */
     UFUNCTION(BlueprintPure)
@@ -40,6 +43,12 @@ private:
     /** Called when world post initialization has been completed */
     void PostInitializeModules();
 
+	/** Returns true if world settings specify main menu game mode. Usable before the game mode is spawned */
+	static bool IsMainMenuWorldSettings(UWorld* World);
+
+	/** Waits for content registry to finish registering vanilla content, so it is never registered on behalf of a mod */
+	void WaitForVanillaContent();
+
 	/** Notifies content registry that modded content registration has been finished */
 	void NotifyContentRegistry();
     
@@ -0,0 +1,39 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Network/NetworkHandler.h"
+#include "ModConnectionStatistics.generated.h"
+
+/**
+ * Mod message traffic of the single connection
+ * Stored in the connection metadata under MetadataSubobjectName, so it lives exactly as long as the connection
+ * Counters are updated by the network handler, use UModNetworkHandler::GetConnectionStatistics to retrieve them
+ */
+UCLASS()
+class SML_API UModConnectionStatistics : public UObject {
+    GENERATED_BODY()
+public:
+    /** Name of the subobject holding statistics in the connection metadata */
+    static const FString MetadataSubobjectName;
+
+    /** Traffic of each message type, indexed by the local channel ID. Only covers channels which had any traffic */
+    TArray<FMessageTypeStats> MessageTypeStats;
+    /** Traffic of all mod messages, including the ones of the message types not registered locally */
+    FMessageTypeStats TotalStats;
+
+    /** Amount and size of the sent and received message batches, which is the actual traffic after compression and fragmenting */
+    int64 BatchesSent = 0;
+    int64 BatchBytesSent = 0;
+    int64 BatchesReceived = 0;
+    int64 BatchBytesReceived = 0;
+
+    /** Start of the current rate limit window and the traffic received from the connection during it */
+    double RateLimitWindowStart = 0.0;
+    int32 MessagesReceivedInWindow = 0;
+    int64 BytesReceivedInWindow = 0;
+    /** Whenever rate limit has already been reported during the current window */
+    bool bRateLimitExceededInWindow = false;
+public:
+    /** Returns traffic counters of the message type with the provided local channel ID, adding them if needed */
+    FMessageTypeStats& GetMessageTypeStats(int32 ChannelId);
+};
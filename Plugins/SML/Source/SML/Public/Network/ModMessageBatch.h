@@ -0,0 +1,61 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Network/NetworkHandler.h"
+
+/** Flags describing single entry of the message batch */
+namespace EMessageEntryFlags {
+    enum Type : uint8 {
+        /** Message data is zlib compressed and prefixed by the uncompressed size */
+        Compressed = 1 << 0,
+        /** Entry contains a part of the message, which is continued by the following entries */
+        Fragment = 1 << 1,
+        /** Entry contains the last part of the fragmented message */
+        LastFragment = 1 << 2,
+        /** Message type is identified by the channel ID negotiated with the receiver instead of the mod reference and message ID */
+        ChannelId = 1 << 3,
+        /** Message has been sent with SendMessage, its data is UTF-8 encoded string dispatched to the string message handler */
+        StringMessage = 1 << 4
+    };
+}
+
+/** Single entry of the received message batch */
+struct FMessageBatchEntry {
+    uint8 EntryFlags = 0;
+    /** Channel ID the entry is addressed to, only valid if EntryFlags contain EMessageEntryFlags::ChannelId */
+    uint32 ChannelId = 0;
+    /** Message type the entry is addressed to, only valid if it is not addressed by the channel ID */
+    FString ModReference;
+    int32 MessageId = 0;
+    /** Entry data. Allocation is kept between entries when the same entry object is used to read the whole batch */
+    TArray<uint8> Data;
+};
+
+/**
+ * Wire format of the binary mod message batches
+ * It only deals with serialization and doesn't depend on the connection state, so both sides of the connection share it
+ */
+class SML_API FModMessageBatchFormat {
+public:
+    /**
+     * Compresses message data if that makes it smaller and splits it into fragments if it is too large
+     * EntryWriter is called with the flags and data of each resulting batch entry, in order
+     * CompressedDataBuffer is a scratch buffer which can be reused between messages
+     */
+    static void EncodeMessage(const uint8* Data, int32 DataSize, bool bAllowCompression, TArray<uint8>& CompressedDataBuffer,
+        TFunctionRef<void(uint8 EntryFlags, const uint8* EntryData, int32 EntryDataSize)> EntryWriter);
+
+    /** Writes single batch entry, addressed by the remote channel ID, or by the message type if it is INDEX_NONE */
+    static void WriteEntry(FArchive& Writer, const FMessageType& MessageType, int32 RemoteChannelId, uint8 EntryFlags, const uint8* Data, int32 DataSize);
+
+    /**
+     * Reads single batch entry, validating every length against the remaining data before allocating anything
+     * Returns false if the batch is malformed, in which case the rest of it should be discarded
+     */
+    static bool ReadEntry(FArchive& Reader, FMessageBatchEntry& OutEntry);
+
+    /** Returns uncompressed size prefixed to the compressed message data, or INDEX_NONE if data is too short to contain it */
+    static int32 GetUncompressedSize(const TArray<uint8>& Data);
+
+    /** Decompresses message data into OutData. Uncompressed size must be validated by the caller beforehand */
+    static bool DecompressMessage(const TArray<uint8>& Data, int32 UncompressedSize, TArray<uint8>& OutData);
+};
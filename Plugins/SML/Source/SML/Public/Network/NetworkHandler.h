@@ -1,12 +1,15 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "Subsystems/EngineSubsystem.h"
+#include "Containers/IndirectArray.h"
 #include "UObject/Object.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "NetworkHandler.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogModNetworkHandler, Log, All);
 DECLARE_DELEGATE_TwoParams(FMessageReceived, class UNetConnection* /*Connection*/, FString /*Data*/);
+DECLARE_DELEGATE_TwoParams(FBinaryMessageReceived, class UNetConnection* /*Connection*/, const TArray<uint8>& /*Data*/);
+DECLARE_DELEGATE_RetVal_OneParam(bool, FIsExemptFromRateLimits, class UNetConnection* /*Connection*/);
 DECLARE_MULTICAST_DELEGATE_TwoParams(FWelcomePlayer, UWorld* /*ServerWorld*/, class UNetConnection* /*Connection*/);
 DECLARE_MULTICAST_DELEGATE_OneParam(FClientInitialJoin, class UNetConnection* /*Connection*/);
 
@@ -15,10 +18,68 @@ struct FMessageType {
     int32 MessageId;
 };
 
+DECLARE_MULTICAST_DELEGATE_TwoParams(FModMessageRateLimitExceeded, class UNetConnection* /*Connection*/, const FMessageType& /*MessageType*/);
+
+/** Traffic counters of the single message type */
+struct FMessageTypeStats {
+    int64 MessagesSent = 0;
+    int64 BytesSent = 0;
+    int64 MessagesReceived = 0;
+    int64 BytesReceived = 0;
+    /** Messages that have not been sent or dispatched because they exceeded the size quota or were malformed */
+    int64 MessagesDropped = 0;
+
+    FORCEINLINE void RecordSent(int32 DataSize) { MessagesSent++; BytesSent += DataSize; }
+    FORCEINLINE void RecordReceived(int32 DataSize) { MessagesReceived++; BytesReceived += DataSize; }
+};
+
 struct FMessageEntry {
     bool bClientHandled;
     bool bServerHandled;
     FMessageReceived MessageReceived;
+    /** Called for the messages sent with SendBinaryMessage */
+    FBinaryMessageReceived BinaryMessageReceived;
+    /** Whenever large binary messages of this type can be compressed before sending */
+    bool bAllowCompression = true;
+    /** Maximum size of the message data in bytes, before compression. Larger messages are dropped on both sides. 0 means no quota */
+    int32 MaxMessageSize = 0;
+    /**
+     * Decides whenever message of this type received through the connection bypasses the rate limits, messages are never exempt when unbound
+     * Only meant for the first handshake message of the connection, since dropping it would make the connection fail to join
+     * instead of just slowing it down. Must return false for the repeated messages, so remote side can't use them to flood us
+     */
+    FIsExemptFromRateLimits IsExemptFromRateLimits;
+    /** Amount of messages and bytes of this type sent and received through all connections */
+    FMessageTypeStats Stats;
+};
+
+/** Message type registered in the network handler, along with its handlers */
+struct FRegisteredMessageType {
+    FMessageType MessageType;
+    FMessageEntry Entry;
+};
+
+/** Channel IDs negotiated with the remote side of the connection */
+struct FNegotiatedMessageChannels {
+    /** Channel ID used by the remote side for each of the local message types, INDEX_NONE if remote side doesn't know the type */
+    TArray<int32> RemoteChannelIds;
+};
+
+/** Binary message which is being received in fragments */
+struct FPartialBinaryMessage {
+    /** Local channel ID of the message type, INDEX_NONE if it is not known */
+    int32 ChannelId = INDEX_NONE;
+    /** Flags of the first fragment, describing how to decode the message once it is complete */
+    uint8 MessageFlags = 0;
+    TArray<uint8> Data;
+};
+
+/** Binary messages queued for the connection which have not been sent yet */
+struct FPendingMessageBatch {
+    /** Serialized messages, in the order they have been queued */
+    TArray<uint8> Payload;
+    /** Amount of messages serialized into the payload */
+    int32 NumMessages = 0;
 };
 
 /**
@@ -38,12 +99,89 @@ class SML_API UModNetworkHandler : public UEngineSubsystem {
 private:
     UPROPERTY()
     TMap<TWeakObjectPtr<class UNetConnection>, class UObjectMetadata*> Metadata;
-    TMap<FString, TMap<int32, FMessageEntry>> MessageHandlers;
+    /** Registered message types. Index of the type is its local channel ID, which remote side uses to address it */
+    TIndirectArray<FRegisteredMessageType> MessageTypes;
+    /** Channel IDs of the message types by mod reference and message ID, used for messages addressed by name */
+    TMap<FString, TMap<int32, int32>> MessageChannelIds;
+    /** Channel IDs negotiated with each connection during the join handshake */
+    TMap<TWeakObjectPtr<class UNetConnection>, FNegotiatedMessageChannels> NegotiatedChannels;
     FWelcomePlayer WelcomePlayerDelegate;
     FClientInitialJoin ClientLoginDelegate;
+    /** Binary messages waiting to be sent to each connection on the next tick */
+    TMap<TWeakObjectPtr<class UNetConnection>, FPendingMessageBatch> PendingMessageBatches;
+    /** Binary messages received from each connection which are still missing some of their fragments */
+    TMap<TWeakObjectPtr<class UNetConnection>, FPartialBinaryMessage> PartialBinaryMessages;
+    /** Scratch buffers reused between messages to avoid allocating them for each sent message */
+    TArray<uint8> MessageDataBuffer;
+    TArray<uint8> CompressedDataBuffer;
+    FDelegateHandle TickerDelegateHandle;
+    FModMessageRateLimitExceeded RateLimitExceededDelegate;
+    /** Limits on the mod messages received from each connection, read from SML configuration. 0 means no limit */
+    int32 MaxReceivedMessagesPerSecond;
+    int32 MaxReceivedBytesPerSecond;
+    /** Interval between network statistics log lines in seconds, 0 if they are disabled */
+    float StatisticsLogInterval;
+    float TimeSinceStatisticsLogged;
 private:
-    void ReceiveMessage(class UNetConnection* Connection, const FString& ModId, int32 MessageId, const FString& Content) const;
+    /** Returns local channel ID of the registered message type, or INDEX_NONE if it has not been registered */
+    int32 FindMessageChannelId(const FString& ModId, int32 MessageId) const;
+    
+    /** Returns entry of the registered message type, or nullptr if it has not been registered */
+    FMessageEntry* FindMessageEntry(const FString& ModId, int32 MessageId);
+
+    /** Returns true if message can be handled on this side of the connection */
+    static bool CanHandleMessage(class UNetConnection* Connection, const FMessageEntry& MessageEntry);
+    
+    void ReceiveMessage(class UNetConnection* Connection, const FString& ModId, int32 MessageId, const FString& Content);
+
+    /** Dispatches every binary message contained in the received batch, reassembling fragmented messages */
+    void ReceiveMessageBatch(class UNetConnection* Connection, const TArray<uint8>& Payload);
+
+    /** Decompresses complete binary message if needed and dispatches it to the handler */
+    void ReceiveBinaryMessage(class UNetConnection* Connection, int32 ChannelId, uint8 MessageFlags, const TArray<uint8>& Data);
+
+    /** Dispatches complete message data to the string or binary message handler, depending on how it has been sent */
+    static void DispatchBatchedMessage(class UNetConnection* Connection, const FMessageEntry& MessageEntry, uint8 MessageFlags, const TArray<uint8>& Data);
+
+    /**
+     * Sends string message as a batch entry addressed by the channel ID, so receiver doesn't have to look up the message type by name
+     * Returns false if remote side has not negotiated the channel ID for the message type, in which case it has to be sent by name
+     */
+    bool SendStringMessageByChannelId(class UNetConnection* Connection, const FMessageType& MessageType, const FString& Data);
+
+    /** Serializes binary message using provided callback and appends it to the batch of the connection, compressing and fragmenting it if needed */
+    void EnqueueBinaryMessage(class UNetConnection* Connection, const FMessageType& MessageType, TFunctionRef<void(FArchive&)> DataWriter);
+
+    /** Appends single message entry to the batch, sending the batch if it grows too large */
+    void AppendMessageBatchEntry(class UNetConnection* Connection, const FMessageType& MessageType, int32 RemoteChannelId, uint8 EntryFlags, const uint8* Data, int32 DataSize);
+
+    /** Sends messages queued for the connection in a single control message */
+    void FlushMessageBatch(class UNetConnection* Connection, FPendingMessageBatch& MessageBatch);
+
+    /** Records sent message in the statistics of the message type and the connection. Channel ID can be INDEX_NONE */
+    void RecordSentMessage(class UNetConnection* Connection, int32 ChannelId, int32 DataSize);
+
+    /** Records message that has been dropped instead of being sent or dispatched. Channel ID can be INDEX_NONE */
+    void RecordDroppedMessage(class UNetConnection* Connection, int32 ChannelId);
+
+    /**
+     * Applies rate limits to the message received from the connection, recording it in the statistics
+     * Returns false if the message exceeds the limits and should be dropped
+     */
+    bool AdmitReceivedMessage(class UNetConnection* Connection, int32 ChannelId, int32 DataSize);
+
+    /** Serializes traffic statistics of the connection into the JSON object */
+    TSharedRef<class FJsonObject> SerializeConnectionStatistics(class UNetConnection* Connection, const class UModConnectionStatistics* Statistics) const;
+
+    /** Called every tick to send all queued binary messages */
+    bool TickMessageBatches(float DeltaTime);
 public:
+    //Begin USubsystem
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    //End USubsystem
+    
+
     /**
      * Retrieves metadata object for given connection
      * Metadata object can be used to store information related to given connection before
@@ -64,18 +202,64 @@ public:
      */
     FORCEINLINE FClientInitialJoin& OnClientInitialJoin() { return ClientLoginDelegate; }
 
+    /**
+     * Delegate called when connection exceeds the limits on the received mod messages set in SML configuration
+     * Messages exceeding the limits are dropped, and the delegate is called at most once per second for each connection
+     * It can be used to apply additional measures to the offending connection, like closing it
+     */
+    FORCEINLINE FModMessageRateLimitExceeded& OnModMessageRateLimitExceeded() { return RateLimitExceededDelegate; }
+
     /**
      * Register new mod message type and return message entry which can be used
      * to set message processing preferences and siding
      */
     FMessageEntry& RegisterMessageType(const FMessageType& MessageType);
 
+    /** Returns traffic counters of the registered message type, or nullptr if it has not been registered */
+    const FMessageTypeStats* GetMessageTypeStats(const FMessageType& MessageType) const;
+
+    /**
+     * Returns names of the registered message types, in the order of their local channel IDs
+     * Sent to the remote side during the join handshake, so it can address binary messages by the channel ID
+     */
+    TArray<FString> GetLocalMessageChannels() const;
+
+    /** Returns amount of the registered message types, which changes every time GetLocalMessageChannels would return a different list */
+    FORCEINLINE int32 GetNumLocalMessageChannels() const { return MessageTypes.Num(); }
+
+    /** Records channel IDs remote side of the connection uses for the message types, as returned by its GetLocalMessageChannels */
+    void SetRemoteMessageChannels(class UNetConnection* Connection, const TArray<FString>& RemoteMessageChannels);
+
+    /** Returns human readable name of the message type with the provided local channel ID, for diagnostics */
+    FString DescribeMessageChannel(int32 ChannelId) const;
+
+    /** Returns mod message traffic statistics of the connection, stored in its metadata */
+    class UModConnectionStatistics* GetConnectionStatistics(class UNetConnection* Connection);
+
+    /** Serializes traffic statistics of all message types and open connections, broken down by mod and message type */
+    TSharedRef<class FJsonObject> SerializeNetworkStatistics() const;
+
+    /** Writes network statistics into the log as a single JSON line */
+    void LogNetworkStatistics() const;
+
     static void CloseWithFailureMessage(class UNetConnection* Connection, const FString& Message);
     
     /**
      * Send registered mod message to this connection to be processed on the remote side
+     * Message is sent immediately, after any binary messages queued for the connection
+     * Once message channels are negotiated, it is addressed by the channel ID instead of the mod reference and message ID
      */
     static void SendMessage(class UNetConnection* Connection, FMessageType MessageType, FString Data);
+
+    /**
+     * Queues binary mod message to be sent to this connection and processed on the remote side by BinaryMessageReceived
+     * Binary messages are batched per connection and sent together once per tick, preserving their order
+     * Large messages are transparently compressed and split into fragments, so they are not limited by the bunch size
+     */
+    static void SendBinaryMessage(class UNetConnection* Connection, const FMessageType& MessageType, const TArray<uint8>& Data);
+
+    /** Same as above, but message data is written directly into the batch by the provided callback */
+    static void SendBinaryMessage(class UNetConnection* Connection, const FMessageType& MessageType, TFunctionRef<void(FArchive&)> DataWriter);
 private:
     friend class FSatisfactoryModLoader;
 
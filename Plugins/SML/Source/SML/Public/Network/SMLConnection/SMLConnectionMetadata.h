@@ -3,10 +3,31 @@
 #include "Util/SemVersion.h"
 #include "SMLConnectionMetadata.generated.h"
 
+/**
+ * Mod list sent by the client during the join handshake
+ * Parsed and validated once, and shared by all of the clients sending identical mod lists
+ */
+struct SML_API FSMLClientModList {
+    /** Raw mod list message, compared on lookup so clients with different mod lists are never mixed up */
+    FString ModListString;
+    /** Whenever mod list message has been parsed successfully */
+    bool bIsValid = false;
+    TMap<FString, FVersion> InstalledMods;
+    TArray<FString> MessageChannels;
+    /** Whenever mod list has been checked against the local mods already */
+    bool bIsValidated = false;
+    /** Mods that are missing on the client or have mismatched versions, empty if client can join */
+    TArray<FString> MissingMods;
+};
+
 UCLASS()
 class SML_API USMLConnectionMetadata : public UObject {
     GENERATED_BODY()
 public:
     bool bIsInitialized;
-    TMap<FString, FVersion> InstalledClientMods;    
+    /** Whenever server has sent us its message channels, set on the client side only */
+    bool bReceivedMessageChannels;
+    TMap<FString, FVersion> InstalledClientMods;
+    /** Mod list received from the client, shared with the other connections which sent the same one */
+    TSharedPtr<FSMLClientModList> ClientModList;
 };
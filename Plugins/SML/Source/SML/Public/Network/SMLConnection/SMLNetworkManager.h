@@ -1,11 +1,15 @@
 #pragma once
 #include "CoreMinimal.h"
+#include "Util/SemVersion.h"
 
 class SML_API FSMLNetworkManager {
 public:
     /** Handles SML message being received on the server side */
     static void HandleMessageReceived(class UNetConnection* Connection, FString Data);
 
+    /** Handles message channels sent by the server in response to the mod list, on the client side */
+    static void HandleMessageChannelsReceived(class UNetConnection* Connection, FString Data);
+
     /** Handles Initial Join request on Client. Called after sending initial NMT_Hello message with endianness/basic network version to server */
     static void HandleInitialClientJoin(UNetConnection* Connection);
 
@@ -15,17 +19,30 @@ public:
     /** Handles AGameModeBase::PostLogin call, which is the first place where APlayerController is available and is called after NMT_Join is received from client */
     static void HandleGameModePostLogin(class AGameModeBase* GameMode, class APlayerController* Controller);
 
-    /** Serializes mod list into packed json string */
+    /** Serializes mod list into packed json string. Result is cached until local mods or message types change */
     static FString SerializeLocalModList();
 
-    /** Parses packaged json mod list string and sets relevant information on connection */
-    static bool HandleModListObject(class USMLConnectionMetadata* Metadata, const FString& ModList);
+    /** Parses packaged json mod list string into the installed mods and message channels of the client */
+    static bool HandleModListObject(const FString& ModList, TMap<FString, FVersion>& OutInstalledMods, TArray<FString>& OutMessageChannels);
 
     /** Ensures that Connection has required SML initialization data and kicks player off if it doesn't */
     static void ValidateSMLConnectionData(class UNetConnection* Connection);
+
+    /** Discards cached handshake data, so it is rebuilt on the next join. Called automatically when new plugins are mounted */
+    static void InvalidateHandshakeCache();
 private:
     friend class FSatisfactoryModLoader;
     static TSharedPtr<struct FMessageType> MessageTypeModInit;
+    static TSharedPtr<struct FMessageType> MessageTypeMessageChannels;
 
     static void RegisterMessageTypeAndHandlers();
+
+    /** Returns true if connection has not sent us the mod list yet, so the first handshake message of the connection is never rate limited */
+    static bool IsAwaitingModList(class UNetConnection* Connection);
+
+    /** Returns true if server has not sent us the message channels yet, so the first reply of the server is never rate limited */
+    static bool IsAwaitingMessageChannels(class UNetConnection* Connection);
+
+    /** Returns parsed mod list for the client mod list message, reusing the one parsed for the previous identical message */
+    static TSharedRef<struct FSMLClientModList> FindOrParseClientModList(const FString& ModListString);
 };
\ No newline at end of file
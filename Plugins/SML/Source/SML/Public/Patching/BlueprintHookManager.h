@@ -1,27 +1,45 @@
 #pragma once
 #include "Subsystems/EngineSubsystem.h"
 #include "Engine/Engine.h"
+#include "Containers/IndirectArray.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "Toolkit/KismetStatementIndex.h"
 #include "BlueprintHookManager.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogBlueprintHookManager, Log, All);
 
 using HookFunctionSignature = void(class FBlueprintHookHelper& HookHelper);
 
+/** Hooks installed at a single code offset of the blueprint function. Referenced by index from the injected bytecode */
+struct FBlueprintHookSite {
+    /**
+     * Hooks to invoke, in the order they were registered. Published array is immutable, adding a hook publishes a modified copy,
+     * so invocation only has to take a reference to the current snapshot to keep iterating it while hooks register more hooks
+     */
+    TSharedRef<const TArray<TFunction<HookFunctionSignature>>> Hooks = MakeShared<TArray<TFunction<HookFunctionSignature>>>();
+    /** Offset of the EX_Return statement inside of the hooked function */
+    int32 ReturnStatementOffset = 0;
+
+    /** Invokes all hooks installed at this site */
+    void InvokeBlueprintHook(FFrame& Frame) const;
+
+    /** Publishes a copy of the hook list with the provided hook appended to it */
+    void AddHook(const TFunction<HookFunctionSignature>& Hook);
+};
+
 /** Holds information about hooked blueprint function */
 USTRUCT()
 struct FFunctionHookInfo {
     GENERATED_BODY()
 private:
-    TMap<int32, TArray<TFunction<HookFunctionSignature>>> CodeOffsetByHookList;
-    int32 ReturnStatementOffset;
+    /** Maps hook offset to the index of the hook site in UBlueprintHookManager::HookSites */
+    TMap<int32, int32> HookSiteIndexByCodeOffset;
+    /** Statement boundaries of the hooked function, built once and updated as hooks are installed */
+    FSMLKismetStatementIndex StatementIndex;
     friend class UBlueprintHookManager;
 public:
-    /** Invokes all hooks associated with provided hook offset */
-    void InvokeBlueprintHook(FFrame& Frame, int32 HookOffset);
-
-    /** Re-calculates return statement offset inside of the function */
-    void RecalculateReturnStatementOffset(UFunction* Function);
+    /** Re-calculates return statement offset inside of the function and updates all hook sites of it */
+    void RecalculateReturnStatementOffset();
 };
 
 /** Describes predefined hook offsets with special handling */
@@ -46,30 +64,34 @@ public:
     */
     void HookBlueprintFunction(UFunction* Function, const TFunction<HookFunctionSignature>& Hook, int32 HookOffset);
 private:
-    /** Actually performs bytecode modification to install hook */
-    static void InstallBlueprintHook(UFunction* Function, int32 HookOffset);
+    /** Actually performs bytecode modification to install hook calling hook site with the given index */
+    static void InstallBlueprintHook(UFunction* Function, int32 HookOffset, int32 HookSiteIndex, FSMLKismetStatementIndex& StatementIndex);
     
     /** Does preprocessing to hook offset to handle predefined hook locations */
-    static int32 PreProcessHookOffset(UFunction* Function, int32 HookOffset);
+    static int32 PreProcessHookOffset(UFunction* Function, int32 HookOffset, const FSMLKismetStatementIndex& StatementIndex);
     
-    /** Called when hook is executed */
-    void HandleHookedFunctionCall(FFrame& Frame, int32 HookOffset);
-
     /** This function is just a stub for UHT to generate reflection data, it is not actually implemented. */
     UFUNCTION(BlueprintInternalUseOnly, CustomThunk)
-    static void ExecuteBPHook(int32 HookOffset) { check(0); };
+    static void ExecuteBPHook(int32 HookSiteIndex) { check(0); };
 
     DECLARE_FUNCTION(execExecuteBPHook) {
         //StepCompiledIn is not used here since this function cannot be called from BP directly, it can only
         //be inserted into byte-code, so codegen support is not needed
-        int32 HookOffset = 0;
-        Stack.Step(Context, &HookOffset);
+        int32 HookSiteIndex = 0;
+        Stack.Step(Context, &HookSiteIndex);
         P_FINISH; //skip EX_EndFunctionParams
-        //Call hook function handler that will do some wrapping
-        UBlueprintHookManager* HookManager = GEngine->GetEngineSubsystem<UBlueprintHookManager>();
-        HookManager->HandleHookedFunctionCall(Stack, HookOffset);
+        //Hook site index is baked into the bytecode, so dispatch is just an array access
+        HookSites[HookSiteIndex].InvokeBlueprintHook(Stack);
     }
 
+    /**
+     * Hook sites referenced by the injected bytecode. Static because installed hooks are never removed
+     * from the bytecode, so indices must stay valid for the lifetime of the process
+     * Sites are allocated separately, so a hook adding new sites doesn't move the site that is currently being invoked
+     */
+    static TIndirectArray<FBlueprintHookSite> HookSites;
+    friend struct FFunctionHookInfo;
+
     /** Classes that we installed hooks in */
     UPROPERTY()
     TArray<UClass*> HookedClasses;
@@ -1,7 +1,9 @@
 #pragma once
 #include "CoreMinimal.h"
-#include <functional>
 #include <type_traits>
+#include <atomic>
+#include "Misc/ScopeLock.h"
+#include "Delegates/IDelegateInstance.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogNativeHookManager, Log, Log);
 
@@ -47,29 +49,486 @@ FORCEINLINE FMemberFunctionPointer ConvertFunctionPointer(const TMemberFunctionP
 	return ResultPointer;
 }
 
+//Name of the module registering the hook handler, resolved to the mod owning it when hook profiling data is dumped
+#ifdef UE_MODULE_NAME
+#define SML_HOOK_OWNER_MODULE_NAME TEXT(UE_MODULE_NAME)
+#else
+#define SML_HOOK_OWNER_MODULE_NAME TEXT("Unknown")
+#endif
+
+/** Profiling data of a single hook handler, attributed to the module that has registered it and to the mod owning that module */
+struct SML_API FNativeHookHandlerStats {
+	FString OwnerModuleName;
+	bool bIsAfterHandler;
+	std::atomic<uint64> CallCount;
+	//Exclusive time of the handler, e.g time spent in nested handlers and original function is not included
+	std::atomic<uint64> TotalCycles;
+
+	FNativeHookHandlerStats(const FString& OwnerModuleName, bool bIsAfterHandler);
+
+	FORCEINLINE void Record(uint64 Cycles) {
+		CallCount.fetch_add(1, std::memory_order_relaxed);
+		TotalCycles.fetch_add(Cycles, std::memory_order_relaxed);
+	}
+
+	void Reset();
+};
+
+/** Profiling data of a single hooked function, keyed by the resolved function address */
+struct SML_API FNativeHookStats {
+	//Bucket N holds original function calls which took [2^N, 2^(N+1)) cycles
+	static constexpr int32 NumHistogramBuckets = 64;
+
+	FString DebugSymbolName;
+	void* FunctionAddress;
+	std::atomic<uint64> InvocationCount;
+	std::atomic<uint64> OriginalCallCycles;
+	std::atomic<uint64> OriginalCallHistogram[NumHistogramBuckets];
+	TArray<FNativeHookHandlerStats*> HandlerStats;
+
+	FNativeHookStats(const FString& DebugSymbolName, void* FunctionAddress);
+
+	FORCEINLINE void RecordOriginalCall(uint64 Cycles) {
+		OriginalCallCycles.fetch_add(Cycles, std::memory_order_relaxed);
+		OriginalCallHistogram[FPlatformMath::FloorLog2_64(Cycles)].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/** Returns upper bound of the original call time for the given percentile (0-1) in cycles */
+	uint64 GetOriginalCallPercentileCycles(float Percentile) const;
+
+	void Reset();
+};
+
+/** Type independent part of the hook handler lists, accessible from the hook manager implementation */
+struct FNativeHookHandlerListsBase {
+	void* FunctionAddress;
+	//Owned by the hook manager. Freed once the hook is uninstalled and replaced when it is installed again
+	std::atomic<FNativeHookStats*> Stats;
+	//Whenever hook is currently installed. It is uninstalled once the last handler is removed, unless it shares funchook handle with other hooks
+	bool bHookInstalled;
+
+	FNativeHookHandlerListsBase(void* FunctionAddress, FNativeHookStats* Stats) : FunctionAddress(FunctionAddress), Stats(Stats), bHookInstalled(false) {}
+};
+
+/**
+ * Hook call state of the single thread. Only ever written by the owning thread, and kept on its own cache line,
+ * so hook calls on different threads never write to the same memory
+ */
+struct alignas(PLATFORM_CACHE_LINE_SIZE) FNativeHookThreadState {
+	//Global hook epoch observed when the outermost hook call of the thread has started, or 0 if the thread is not inside of any hook
+	std::atomic<uint64> ActiveEpoch;
+	//Number of the nested hook calls currently in progress on the thread
+	int32 CallDepth;
+
+	FNativeHookThreadState() : ActiveEpoch(0), CallDepth(0) {}
+};
+
 class SML_API FNativeHookManagerInternal {
 public:
+	/** Whenever hook profiling is enabled. Can be toggled at runtime using SML.Hooks.EnableProfiling console variable */
+	static bool bProfilingEnabled;
+
+	/** Current hook epoch, advanced every time an allocation is retired. Starts at 1, since 0 marks threads outside of any hook */
+	static std::atomic<uint64> GlobalEpoch;
+
+	/** Returns hook call state of the calling thread, registering it on the first call */
+	static FNativeHookThreadState* GetCurrentThreadState();
+
+	/** Starts reclaiming retired allocations at the end of each frame. Called on SML module startup */
+	static void Initialize();
+	/** Stops reclaiming retired allocations. Called on SML module shutdown */
+	static void Shutdown();
+
+	/**
+	 * Lock guarding hook installation and handler registration, shared by all modules
+	 * Hook invocation never takes it, handler lists are read through atomically published snapshots instead
+	 */
+	static FCriticalSection& GetRegistrationLock();
+
 	static void* GetHandlerListInternal(void* RealFunctionAddress);
 	static void SetHandlerListInstanceInternal(void* RealFunctionAddress, void* handlerList);
-	static void* RegisterHookFunction(const FString& DebugSymbolName, void* OriginalFunctionPointer, void* SampleObjectInstance, int ThisAdjustment, void* HookFunctionPointer, void** OutTrampolineFunction);
+
+	/**
+	 * Resolves the function implementation and installs the hook on it
+	 * Handler lists shared by all modules hooking that function are created using CreateHandlerLists if they don't exist yet,
+	 * and are written to OutHandlerLists before the hook is installed, so the hook never observes them unset
+	 */
+	static void* RegisterHookFunction(const FString& DebugSymbolName, void* OriginalFunctionPointer, void* SampleObjectInstance, int ThisAdjustment,
+		void* HookFunctionPointer, void** OutTrampolineFunction, FNativeHookHandlerListsBase* (*CreateHandlerLists)(void* FunctionAddress, FNativeHookStats* Stats), void** OutHandlerLists);
+
+	/**
+	 * Uninstalls the hook from the function, restoring the original code, so it runs at native speed again
+	 * Called automatically once the last handler of the hook is removed. Hook will be installed again if new handler is added
+	 * Hooks installed in a batch by the hook transaction share their funchook handle, so they are left installed instead
+	 * and only pass the calls through to the original function, never affecting the other hooks of the batch
+	 */
+	static void UnregisterHookFunction(FNativeHookHandlerListsBase* HandlerLists);
+
+	/**
+	 * Begins hook transaction. Hooks registered while the transaction is active are not installed immediately,
+	 * instead they are queued and prepared on a single funchook handle when transaction is committed,
+	 * then installed with a single funchook_install call. Queued hooks are not active until then, original function is called instead
+	 * Mod loader opens the transaction for the duration of its initialization
+	 */
+	static void BeginHookTransaction();
+	/** Installs all hooks queued since the transaction began and logs the measured time it took */
+	static void CommitHookTransaction();
+
+	/**
+	 * Frees memory which might still be used by the hook calls in progress once they are guaranteed to have finished
+	 * Allocation must already be unreachable for the new hook calls. Retiring it advances the global epoch, and it is reclaimed
+	 * once every thread is either outside of any hook or has entered its outermost hook call after that, since such calls
+	 * can only observe the replacement. Threads are checked on the game thread at the end of each frame. Can be called from any thread
+	 */
+	static void RetireAllocation(TFunction<void()>&& Reclaim);
+
+	/** Returns profiling data for the hooked function, creating it if it doesn't exist yet. Freed once the hook is uninstalled */
+	static FNativeHookStats* GetHookStats(void* RealFunctionAddress, const FString& DebugSymbolName);
+	/** Allocates profiling data for the new handler of the hooked function */
+	static FNativeHookHandlerStats* RegisterHandlerStats(FNativeHookStats* HookStats, const TCHAR* OwnerModuleName, bool bIsAfterHandler);
+	/** Removes profiling data of the removed handler from the hook */
+	static void UnregisterHandlerStats(FNativeHookHandlerListsBase* HandlerLists, FNativeHookHandlerStats* HandlerStats);
+
+	/** Logs collected hook profiling data, sorted by the total time spent in the hook */
+	static void DumpHookStats();
+	/** Writes collected hook profiling data to the file as JSON */
+	static bool DumpHookStatsToJson(const FString& FilePath);
+	/** Resets all collected hook profiling data */
+	static void ResetHookStats();
 };
 
-template <typename T, typename E>
-struct THandlerLists {
-	TArray<T> HandlersBefore;
-	TArray<E> HandlersAfter;
+/**
+ * Marks the calling thread as being inside of a hook for the guard lifetime. Has to be entered before the hook reads its handler snapshots or trampoline
+ * Only writes the state of the calling thread, so hot hooks called from many threads at once never contend on shared memory
+ */
+struct FNativeHookCallGuard {
+	FNativeHookThreadState* ThreadState;
+
+	FNativeHookCallGuard() : ThreadState(FNativeHookManagerInternal::GetCurrentThreadState()) {
+		if (ThreadState->CallDepth++ == 0) {
+			ThreadState->ActiveEpoch.store(FNativeHookManagerInternal::GlobalEpoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+			//Snapshot loads following it can never be reordered before the epoch is published, pairs with the fence in the reclamation
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+		}
+	}
+
+	~FNativeHookCallGuard() {
+		if (--ThreadState->CallDepth == 0) {
+			ThreadState->ActiveEpoch.store(0, std::memory_order_release);
+		}
+	}
 };
 
+/** Returns hook profiling data to record the call into, or NULL when profiling is disabled */
+FORCEINLINE FNativeHookStats* BeginProfiledHookCall(FNativeHookStats* HookStats) {
+	if (UNLIKELY(FNativeHookManagerInternal::bProfilingEnabled)) {
+		HookStats->InvocationCount.fetch_add(1, std::memory_order_relaxed);
+		return HookStats;
+	}
+	return NULL;
+}
+
+/**
+ * Measures exclusive time of the before handlers and time of the original function call
+ * Time spent inside of the nested calls of the scope is subtracted from the time of the handler calling it
+ */
+struct FCallScopeProfiler {
+	struct FFrame {
+		uint64 StartCycles;
+		uint64 SavedNestedCycles;
+	};
+	
+	FNativeHookStats* Stats;
+	uint64 NestedCycles;
+
+	explicit FCallScopeProfiler(FNativeHookStats* Stats) : Stats(Stats), NestedCycles(0) {}
+
+	FORCEINLINE bool IsActive() const {
+		return Stats != NULL;
+	}
+
+	FORCEINLINE FFrame Enter() {
+		const FFrame Frame{FPlatformTime::Cycles64(), NestedCycles};
+		NestedCycles = 0;
+		return Frame;
+	}
+
+	FORCEINLINE void LeaveHandler(const FFrame& Frame, FNativeHookHandlerStats* HandlerStats) {
+		const uint64 ElapsedCycles = FPlatformTime::Cycles64() - Frame.StartCycles;
+		HandlerStats->Record(ElapsedCycles - NestedCycles);
+		NestedCycles = Frame.SavedNestedCycles + ElapsedCycles;
+	}
+
+	FORCEINLINE void LeaveOriginalCall(const FFrame& Frame) {
+		const uint64 ElapsedCycles = FPlatformTime::Cycles64() - Frame.StartCycles;
+		Stats->RecordOriginalCall(ElapsedCycles);
+		NestedCycles = Frame.SavedNestedCycles + ElapsedCycles;
+	}
+};
+
+template<typename TSignature>
+class THookHandler;
+
+/** Hook handler together with the handle used to remove it and the profiling data of it */
+template<typename TSignature>
+struct THookHandlerEntry {
+	THookHandler<TSignature> Handler;
+	FDelegateHandle Handle;
+	FNativeHookHandlerStats* Stats;
+};
+
+/**
+ * Handler lists of the single hooked function, shared by all modules hooking it
+ *
+ * Published handler arrays are immutable. Hook invocation loads the current snapshot once per call and never locks,
+ * while registration copies the array, modifies the copy and publishes it under the registration lock (copy-on-write).
+ * Replaced arrays are freed once no call which could have loaded them is in progress anymore, see FNativeHookCallGuard
+ * That way, handlers can be registered from any thread while the hook is being called on the others
+ */
 template <typename T, typename E>
-THandlerLists<T, E>* createHandlerLists(void* RealFunctionAddress) {
-	void* handlerListRaw = FNativeHookManagerInternal::GetHandlerListInternal(RealFunctionAddress);
-	if (handlerListRaw == nullptr) {
-		handlerListRaw = new THandlerLists<T, E>();
-		FNativeHookManagerInternal::SetHandlerListInstanceInternal(RealFunctionAddress, handlerListRaw);
+struct THandlerLists : FNativeHookHandlerListsBase {
+	using BeforeArrayType = TArray<THookHandlerEntry<T>>;
+	using AfterArrayType = TArray<THookHandlerEntry<E>>;
+
+	std::atomic<const BeforeArrayType*> HandlersBefore;
+	std::atomic<const AfterArrayType*> HandlersAfter;
+
+	THandlerLists(void* FunctionAddress, FNativeHookStats* Stats) : FNativeHookHandlerListsBase(FunctionAddress, Stats),
+		HandlersBefore(new BeforeArrayType()), HandlersAfter(new AfterArrayType()) {}
+
+	static FNativeHookHandlerListsBase* Create(void* FunctionAddress, FNativeHookStats* Stats) {
+		return new THandlerLists(FunctionAddress, Stats);
+	}
+
+	FORCEINLINE const BeforeArrayType* GetHandlersBefore() const {
+		return HandlersBefore.load(std::memory_order_acquire);
+	}
+
+	FORCEINLINE const AfterArrayType* GetHandlersAfter() const {
+		return HandlersAfter.load(std::memory_order_acquire);
+	}
+
+	FDelegateHandle AddHandlerBefore(THookHandler<T>&& Handler, const TCHAR* OwnerModuleName) {
+		FScopeLock Lock(&FNativeHookManagerInternal::GetRegistrationLock());
+		const FDelegateHandle Handle(FDelegateHandle::GenerateNewHandle);
+		FNativeHookHandlerStats* HandlerStats = FNativeHookManagerInternal::RegisterHandlerStats(Stats.load(std::memory_order_relaxed), OwnerModuleName, false);
+		PublishModifiedHandlers(HandlersBefore, [&](BeforeArrayType& Handlers) {
+			Handlers.Add({MoveTemp(Handler), Handle, HandlerStats});
+		});
+		return Handle;
+	}
+
+	FDelegateHandle AddHandlerAfter(THookHandler<E>&& Handler, const TCHAR* OwnerModuleName) {
+		FScopeLock Lock(&FNativeHookManagerInternal::GetRegistrationLock());
+		const FDelegateHandle Handle(FDelegateHandle::GenerateNewHandle);
+		FNativeHookHandlerStats* HandlerStats = FNativeHookManagerInternal::RegisterHandlerStats(Stats.load(std::memory_order_relaxed), OwnerModuleName, true);
+		PublishModifiedHandlers(HandlersAfter, [&](AfterArrayType& Handlers) {
+			Handlers.Add({MoveTemp(Handler), Handle, HandlerStats});
+		});
+		return Handle;
+	}
+
+	/** Removes handler with the provided handle, uninstalling the hook if it was the last one. Returns true if handler was found */
+	bool RemoveHandler(FDelegateHandle Handle) {
+		FScopeLock Lock(&FNativeHookManagerInternal::GetRegistrationLock());
+		if (!RemoveHandlerFromList(HandlersBefore, Handle) && !RemoveHandlerFromList(HandlersAfter, Handle)) {
+			return false;
+		}
+		if (GetHandlersBefore()->Num() == 0 && GetHandlersAfter()->Num() == 0) {
+			FNativeHookManagerInternal::UnregisterHookFunction(this);
+		}
+		return true;
+	}
+
+private:
+	//Should only be called while holding the registration lock
+	template<typename TArrayType>
+	bool RemoveHandlerFromList(std::atomic<const TArrayType*>& Snapshot, FDelegateHandle Handle) {
+		const TArrayType* CurrentHandlers = Snapshot.load(std::memory_order_relaxed);
+		const int32 HandlerIndex = CurrentHandlers->IndexOfByPredicate([&](const typename TArrayType::ElementType& Entry) {
+			return Entry.Handle == Handle;
+		});
+		if (HandlerIndex == INDEX_NONE) {
+			return false;
+		}
+		FNativeHookManagerInternal::UnregisterHandlerStats(this, (*CurrentHandlers)[HandlerIndex].Stats);
+		PublishModifiedHandlers(Snapshot, [&](TArrayType& Handlers) {
+			Handlers.RemoveAt(HandlerIndex);
+		});
+		return true;
+	}
+
+	//Should only be called while holding the registration lock
+	template<typename TArrayType, typename TModifier>
+	void PublishModifiedHandlers(std::atomic<const TArrayType*>& Snapshot, TModifier&& Modifier) {
+		const TArrayType* OldHandlers = Snapshot.load(std::memory_order_relaxed);
+		TArrayType* NewHandlers = new TArrayType(*OldHandlers);
+		Modifier(*NewHandlers);
+		Snapshot.store(NewHandlers, std::memory_order_release);
+		//Replaced snapshot might still be iterated by the calls in progress, so it is only freed once they are done
+		FNativeHookManagerInternal::RetireAllocation([OldHandlers]() { delete OldHandlers; });
+	}
+};
+
+/** Records time of the original function call when it is called directly, bypassing the CallScope */
+struct FScopedOriginalCallTimer {
+	FNativeHookStats* Stats;
+	uint64 StartCycles;
+
+	explicit FScopedOriginalCallTimer(FNativeHookStats* Stats) : Stats(Stats), StartCycles(Stats != NULL ? FPlatformTime::Cycles64() : 0) {}
+
+	~FScopedOriginalCallTimer() {
+		if (UNLIKELY(Stats != NULL)) {
+			Stats->RecordOriginalCall(FPlatformTime::Cycles64() - StartCycles);
+		}
+	}
+};
+
+/** Calls the original function through the provided callable directly, used when the hook only has after handlers */
+template<typename TCallable>
+FORCEINLINE auto callOriginalFunction(FNativeHookStats* Stats, TCallable&& Callable) -> decltype(Callable()) {
+	FScopedOriginalCallTimer Timer(Stats);
+	return Callable();
+}
+
+/** Calls after handlers of the hook, recording time of each one of them if profiling is active */
+template<typename T, typename... ArgumentTypes>
+FORCEINLINE void callHandlersAfter(const TArray<THookHandlerEntry<T>>& Handlers, FNativeHookStats* Stats, ArgumentTypes&&... Args) {
+	if (UNLIKELY(Stats != NULL)) {
+		for (const THookHandlerEntry<T>& Entry : Handlers) {
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			Entry.Handler(Args...);
+			Entry.Stats->Record(FPlatformTime::Cycles64() - StartCycles);
+		}
+	} else {
+		for (const THookHandlerEntry<T>& Entry : Handlers) {
+			Entry.Handler(Args...);
+		}
 	}
-	return static_cast<THandlerLists<T, E>*>(handlerListRaw);
 }
 
+/**
+ * Type-erased hook handler stored directly inside of the contiguous handler array
+ *
+ * Unlike std::function, it never allocates or copies anything when invoked:
+ * - plain function pointers and captureless lambdas are stored and called as raw function pointers
+ * - small trivially copyable functors (lambdas capturing a few pointers or values) are stored in the inline buffer
+ * - anything else is allocated on the heap once during registration, never during the call
+ *
+ * Inline contents are always trivially copyable, so the handler can be safely relocated by TArray
+ */
+template<typename ReturnType, typename... ArgumentTypes>
+class THookHandler<ReturnType(ArgumentTypes...)> {
+public:
+	using FunctionPointerType = ReturnType(*)(ArgumentTypes...);
+	static constexpr SIZE_T InlineStorageSize = 3 * sizeof(void*);
+private:
+	using InvokerType = ReturnType(*)(void* Storage, ArgumentTypes... Args);
+	//Copies callable from Source into Destination, or destroys Destination if Source is NULL
+	using ManagerType = void(*)(void* Destination, const void* Source);
+
+	union {
+		FunctionPointerType FunctionPointer;
+		void* HeapCallable;
+		alignas(void*) uint8 InlineStorage[InlineStorageSize];
+	};
+	InvokerType Invoker;
+	ManagerType Manager;
+
+	static ReturnType InvokeFunctionPointer(void* Storage, ArgumentTypes... Args) {
+		return (*static_cast<FunctionPointerType*>(Storage))(Forward<ArgumentTypes>(Args)...);
+	}
+
+	template<typename TCallable>
+	static ReturnType InvokeInline(void* Storage, ArgumentTypes... Args) {
+		return (*static_cast<TCallable*>(Storage))(Forward<ArgumentTypes>(Args)...);
+	}
+
+	template<typename TCallable>
+	static ReturnType InvokeHeap(void* Storage, ArgumentTypes... Args) {
+		return (**static_cast<TCallable**>(Storage))(Forward<ArgumentTypes>(Args)...);
+	}
+
+	template<typename TCallable>
+	static void ManageHeap(void* Destination, const void* Source) {
+		if (Source != NULL) {
+			*static_cast<TCallable**>(Destination) = new TCallable(**static_cast<TCallable* const*>(Source));
+		} else {
+			delete *static_cast<TCallable**>(Destination);
+		}
+	}
+
+	template<typename TCallable>
+	void Initialize(TCallable&& Callable, std::integral_constant<int, 0>) {
+		FunctionPointer = Callable;
+		Invoker = &InvokeFunctionPointer;
+	}
+
+	template<typename TCallable>
+	void Initialize(TCallable&& Callable, std::integral_constant<int, 1>) {
+		using CallableType = std::decay_t<TCallable>;
+		new (InlineStorage) CallableType(Forward<TCallable>(Callable));
+		Invoker = &InvokeInline<CallableType>;
+	}
+
+	template<typename TCallable>
+	void Initialize(TCallable&& Callable, std::integral_constant<int, 2>) {
+		using CallableType = std::decay_t<TCallable>;
+		HeapCallable = new CallableType(Forward<TCallable>(Callable));
+		Invoker = &InvokeHeap<CallableType>;
+		Manager = &ManageHeap<CallableType>;
+	}
+
+	template<typename CallableType>
+	using StorageKind = std::integral_constant<int,
+		std::is_convertible<CallableType, FunctionPointerType>::value ? 0 :
+		(sizeof(CallableType) <= InlineStorageSize && alignof(CallableType) <= alignof(void*) &&
+			std::is_trivially_copyable<CallableType>::value) ? 1 : 2>;
+public:
+	template<typename TCallable, typename = std::enable_if_t<!std::is_same<std::decay_t<TCallable>, THookHandler>::value>>
+	THookHandler(TCallable&& Callable) : Invoker(NULL), Manager(NULL) {
+		Initialize(Forward<TCallable>(Callable), StorageKind<std::decay_t<TCallable>>{});
+	}
+
+	THookHandler(const THookHandler& Other) : Invoker(Other.Invoker), Manager(Other.Manager) {
+		FMemory::Memcpy(InlineStorage, Other.InlineStorage, InlineStorageSize);
+		if (Manager != NULL) {
+			Manager(InlineStorage, Other.InlineStorage);
+		}
+	}
+
+	THookHandler(THookHandler&& Other) noexcept : Invoker(Other.Invoker), Manager(Other.Manager) {
+		FMemory::Memcpy(InlineStorage, Other.InlineStorage, InlineStorageSize);
+		Other.Manager = NULL;
+	}
+
+	THookHandler& operator=(const THookHandler& Other) {
+		if (this != &Other) {
+			this->~THookHandler();
+			new (this) THookHandler(Other);
+		}
+		return *this;
+	}
+
+	THookHandler& operator=(THookHandler&& Other) noexcept {
+		if (this != &Other) {
+			this->~THookHandler();
+			new (this) THookHandler(MoveTemp(Other));
+		}
+		return *this;
+	}
+
+	~THookHandler() {
+		if (Manager != NULL) {
+			Manager(InlineStorage, NULL);
+		}
+	}
+
+	FORCEINLINE ReturnType operator()(ArgumentTypes... Args) const {
+		return Invoker(const_cast<uint8*>(InlineStorage), Forward<ArgumentTypes>(Args)...);
+	}
+};
+
 template <typename TCallable, TCallable Callable>
 struct HookInvoker;
 
@@ -82,17 +541,19 @@ struct CallScope<void(*)(Args...)> {
 public:
 	typedef void HookType(Args...);
 	typedef void HookFuncSig(CallScope<void(*)(Args...)>&, Args...);
-	typedef std::function<HookFuncSig> HookFunc;
+	typedef THookHandler<HookFuncSig> HookFunc;
+	typedef THookHandlerEntry<HookFuncSig> HookEntry;
 
 private:
-	TArray<HookFunc>* functionList;
-	size_t handlerPtr = 0;
+	const TArray<HookEntry>* functionList;
+	int32 handlerPtr = 0;
 	HookType* function;
+	FCallScopeProfiler profiler;
 
 	bool forwardCall = true;
 
 public:
-	CallScope(TArray<HookFunc>* functionList, HookType* function) : functionList(functionList), function(function) {}
+	CallScope(const TArray<HookEntry>* functionList, HookType* function, FNativeHookStats* stats = NULL) : functionList(functionList), function(function), profiler(stats) {}
 
 	inline bool shouldForwardCall() const {
 		return forwardCall;
@@ -103,16 +564,38 @@ public:
 	}
 
 	inline void operator()(Args... args) {
+		if (UNLIKELY(profiler.IsActive())) {
+			profiledCall(args...);
+			return;
+		}
+		if (functionList == nullptr || handlerPtr >= functionList->Num()) {
+			function(args...);
+			forwardCall = false;
+		} else {
+			const int32 cachePtr = handlerPtr + 1;
+			const HookEntry& entry = (*functionList)[handlerPtr++];
+			entry.Handler(*this, args...);
+			if (handlerPtr == cachePtr && forwardCall) {
+				(*this)(args...);
+			}
+		}
+	}
+
+private:
+	FORCENOINLINE void profiledCall(Args... args) {
+		const FCallScopeProfiler::FFrame frame = profiler.Enter();
 		if (functionList == nullptr || handlerPtr >= functionList->Num()) {
 			function(args...);
 			forwardCall = false;
+			profiler.LeaveOriginalCall(frame);
 		} else {
-			auto cachePtr = handlerPtr + 1;
-			auto& handler = (*functionList)[handlerPtr++];
-			handler(*this, args...);
+			const int32 cachePtr = handlerPtr + 1;
+			const HookEntry& entry = (*functionList)[handlerPtr++];
+			entry.Handler(*this, args...);
 			if (handlerPtr == cachePtr && forwardCall) {
 				(*this)(args...);
 			}
+			profiler.LeaveHandler(frame, entry.Stats);
 		}
 	}
 };
@@ -123,43 +606,74 @@ struct CallScope<Result(*)(Args...)> {
 public:
 	// typedef Result HookType(Args...);
 	typedef void HookFuncSig(CallScope<Result(*)(Args...)>&, Args...);
-	typedef std::function<HookFuncSig> HookFunc;
+	typedef THookHandler<HookFuncSig> HookFunc;
+	typedef THookHandlerEntry<HookFuncSig> HookEntry;
 
-    typedef std::function<Result(Args...)> HookType;
+	//Stored as THookHandler so capturing trampolines (see applyCallUserTypeByValue) do not allocate
+	typedef THookHandler<Result(Args...)> HookType;
 private:
-	TArray<HookFunc>* functionList;
-	size_t handlerPtr = 0;
+	const TArray<HookEntry>* functionList;
+	int32 handlerPtr = 0;
 	HookType function;
+	FCallScopeProfiler profiler;
 	
 	bool forwardCall = true;
 	Result result;
 
 public:
-	CallScope(TArray<HookFunc>* functionList, HookType function) : functionList(functionList), function(function) {}
+	CallScope(const TArray<HookEntry>* functionList, HookType function, FNativeHookStats* stats = NULL) : functionList(functionList), function(MoveTemp(function)), profiler(stats) {}
 
 	inline bool shouldForwardCall() {
 		return forwardCall;
 	}
-	inline Result getResult() {
+	inline const Result& getResult() const {
 		return result;
 	}
 
+	//Moves result out of the scope, should only be used once all handlers have been called
+	inline Result&& moveResult() {
+		return MoveTemp(result);
+	}
+
 	void Override(const Result& newResult) {
 		this->forwardCall = false;
 		this->result = newResult;
 	}
 
-	inline Result operator()(Args... args) {
+	//Returns reference to the result stored in the scope, so nested calls do not copy it
+	inline const Result& operator()(Args... args) {
+		if (UNLIKELY(profiler.IsActive())) {
+			return profiledCall(args...);
+		}
+		if (functionList == nullptr || handlerPtr >= functionList->Num()) {
+			result = function(args...);
+			this->forwardCall = false;
+		} else {
+			const int32 cachePtr = handlerPtr + 1;
+			const HookEntry& entry = (*functionList)[handlerPtr++];
+			entry.Handler(*this, args...);
+			if (handlerPtr == cachePtr && forwardCall) {
+				(*this)(args...);
+			}
+		}
+		return result;
+	}
+
+private:
+	FORCENOINLINE const Result& profiledCall(Args... args) {
+		const FCallScopeProfiler::FFrame frame = profiler.Enter();
 		if (functionList == nullptr || handlerPtr >= functionList->Num()) {
 			result = function(args...);
 			this->forwardCall = false;
+			profiler.LeaveOriginalCall(frame);
 		} else {
-			auto cachePtr = handlerPtr + 1;
-			auto handler = (*functionList)[handlerPtr++];
-			handler(*this, args...);
+			const int32 cachePtr = handlerPtr + 1;
+			const HookEntry& entry = (*functionList)[handlerPtr++];
+			entry.Handler(*this, args...);
 			if (handlerPtr == cachePtr && forwardCall) {
 				(*this)(args...);
 			}
+			profiler.LeaveHandler(frame, entry.Stats);
 		}
 		return result;
 	}
@@ -189,27 +703,43 @@ public:
 	using ScopeType = CallScope<TCallable>;
 	using HandlerSignature = void(ScopeType&, ArgumentTypes...);
 	using HandlerSignatureAfter = typename HandlerAfterFunc<ReturnType, ArgumentTypes...>::Value;
-	using Handler = std::function<HandlerSignature>;
-	using HandlerAfter = std::function<HandlerSignatureAfter>;
+	using Handler = THookHandler<HandlerSignature>;
+	using HandlerAfter = THookHandler<HandlerSignatureAfter>;
+	using HandlerListsType = THandlerLists<HandlerSignature, HandlerSignatureAfter>;
 private:
-	static TArray<Handler>* handlersBefore;
-	static TArray<HandlerAfter>* handlersAfter;
+	static HandlerListsType* handlerLists;
 	static TCallable functionPtr;
-	static bool bHookInitialized;
 public:
+	//Each apply function is specialized at compile time for the return type of the hooked function and has a separate path
+	//for the hooks that only have after handlers: original function is called directly without building a CallScope
+	//and result is passed to the after handlers by reference
 	static ReturnType applyCall(ArgumentTypes... args) {
-		ScopeType scope(handlersBefore, functionPtr);
+		FNativeHookCallGuard CallGuard;
+		FNativeHookStats* Stats = BeginProfiledHookCall(handlerLists->Stats.load(std::memory_order_relaxed));
+		const typename HandlerListsType::BeforeArrayType* HandlersBefore = handlerLists->GetHandlersBefore();
+		if (HandlersBefore->Num() == 0) {
+			ReturnType Result = callOriginalFunction(Stats, [&]() { return functionPtr(args...); });
+			callHandlersAfter(*handlerLists->GetHandlersAfter(), Stats, Result, args...);
+			return Result;
+		}
+		ScopeType scope(HandlersBefore, functionPtr, Stats);
 		scope(args...);
-		for (HandlerAfter& handler : *handlersAfter)
-			handler(scope.getResult(), args...);
-		return scope.getResult();
+		callHandlersAfter(*handlerLists->GetHandlersAfter(), Stats, scope.getResult(), args...);
+		return scope.moveResult();
 	}
 
 	static void applyCallVoid(ArgumentTypes... args) {
-		ScopeType scope(handlersBefore, functionPtr);
+		FNativeHookCallGuard CallGuard;
+		FNativeHookStats* Stats = BeginProfiledHookCall(handlerLists->Stats.load(std::memory_order_relaxed));
+		const typename HandlerListsType::BeforeArrayType* HandlersBefore = handlerLists->GetHandlersBefore();
+		if (HandlersBefore->Num() == 0) {
+			callOriginalFunction(Stats, [&]() { functionPtr(args...); });
+			callHandlersAfter(*handlerLists->GetHandlersAfter(), Stats, args...);
+			return;
+		}
+		ScopeType scope(HandlersBefore, functionPtr, Stats);
 		scope(args...);
-		for (HandlerAfter& handler : *handlersAfter)
-			handler(args...);
+		callHandlersAfter(*handlerLists->GetHandlersAfter(), Stats, args...);
 	}
 
 private:
@@ -225,25 +755,42 @@ private:
 		return getApplyRef(std::is_same<ReturnType, void>{});
 	}
 public:
+	//Install the hook and add the handler under a single registration lock, so removal of the last handler
+	//on another thread can never uninstall the hook between the two and leave the new handler on an unhooked function
+	static FDelegateHandle subscribeBefore(const FString& DebugSymbolName, Handler handler, const TCHAR* OwnerModuleName = SML_HOOK_OWNER_MODULE_NAME) {
+		FScopeLock Lock(&FNativeHookManagerInternal::GetRegistrationLock());
+		InstallHook(DebugSymbolName);
+		return handlerLists->AddHandlerBefore(MoveTemp(handler), OwnerModuleName);
+	}
+
+	static FDelegateHandle subscribeAfter(const FString& DebugSymbolName, HandlerAfter handler, const TCHAR* OwnerModuleName = SML_HOOK_OWNER_MODULE_NAME) {
+		FScopeLock Lock(&FNativeHookManagerInternal::GetRegistrationLock());
+		InstallHook(DebugSymbolName);
+		return handlerLists->AddHandlerAfter(MoveTemp(handler), OwnerModuleName);
+	}
+
 	//This hook invoker is for global non-member static functions, so we don't have to deal with
 	//member function pointers and virtual functions here
 	static void InstallHook(const FString& DebugSymbolName) {
-		if (!bHookInitialized) {
-			bHookInitialized = true;
+		FScopeLock Lock(&FNativeHookManagerInternal::GetRegistrationLock());
+		//Hook is installed again if it has been uninstalled after removing all of the handlers
+		if (handlerLists == nullptr || !handlerLists->bHookInstalled) {
 			void* HookFunctionPointer = static_cast<void*>(getApplyCall());
-			void* RealFunctionAddress = FNativeHookManagerInternal::RegisterHookFunction(DebugSymbolName, Callable, NULL, 0, HookFunctionPointer, (void**) &functionPtr);
-			auto* HandlerLists = createHandlerLists<Handler, HandlerAfter>(RealFunctionAddress);
-			handlersBefore = &HandlerLists->HandlersBefore;
-			handlersAfter = &HandlerLists->HandlersAfter;
+			FNativeHookManagerInternal::RegisterHookFunction(DebugSymbolName, Callable, NULL, 0, HookFunctionPointer, (void**) &functionPtr,
+				&HandlerListsType::Create, (void**) &handlerLists);
 		}
 	}
 
-	static void addHandlerBefore(Handler handler) {
-		handlersBefore->Add(handler);
+	static FDelegateHandle addHandlerBefore(Handler handler, const TCHAR* OwnerModuleName = SML_HOOK_OWNER_MODULE_NAME) {
+		return handlerLists->AddHandlerBefore(MoveTemp(handler), OwnerModuleName);
+	}
+
+	static FDelegateHandle addHandlerAfter(HandlerAfter handler, const TCHAR* OwnerModuleName = SML_HOOK_OWNER_MODULE_NAME) {
+		return handlerLists->AddHandlerAfter(MoveTemp(handler), OwnerModuleName);
 	}
 
-	static void addHandlerAfter(HandlerAfter handler) {
-		handlersAfter->Add(handler);
+	static bool removeHandler(FDelegateHandle Handle) {
+		return handlerLists != nullptr && handlerLists->RemoveHandler(Handle);
 	}
 };
 
@@ -259,30 +806,42 @@ public:
 	typedef typename HandlerAfterFunc<ReturnType, ConstCorrectThisPtr, ArgumentTypes...>::Value HandlerSignatureAfter;
 	typedef ReturnType HookType(ConstCorrectThisPtr, ArgumentTypes...);
 
-	using Handler = std::function<HandlerSignature>;
-	using HandlerAfter = std::function<HandlerSignatureAfter>;
+	using Handler = THookHandler<HandlerSignature>;
+	using HandlerAfter = THookHandler<HandlerSignatureAfter>;
+	using HandlerListsType = THandlerLists<HandlerSignature, HandlerSignatureAfter>;
 private:
-    static TArray<Handler>* handlersBefore;
-	static TArray<HandlerAfter>* handlersAfter;
+	static HandlerListsType* handlerLists;
 	static HookType* functionPtr;
-	static bool bHookInitialized;
 
 	//Methods which return class/struct/union by value have out pointer inserted
 	//as first parameter after this pointer, with all arguments shifted right by 1 for it
 	static ReturnType* applyCallUserTypeByValue(CallableType* self, ReturnType* outReturnValue, ArgumentTypes... args) {
+		using TrampolineType = ReturnType*(*)(ConstCorrectThisPtr, ReturnType*, ArgumentTypes...);
+		FNativeHookCallGuard CallGuard;
+		FNativeHookStats* Stats = BeginProfiledHookCall(handlerLists->Stats.load(std::memory_order_relaxed));
+		const typename HandlerListsType::BeforeArrayType* HandlersBefore = handlerLists->GetHandlersBefore();
+
+		//Without before handlers, original function writes directly into outReturnValue,
+		//and after handlers observe it there, so the result is never copied
+		if (HandlersBefore->Num() == 0) {
+			callOriginalFunction(Stats, [&]() { reinterpret_cast<TrampolineType>(functionPtr)(self, outReturnValue, args...); });
+			callHandlersAfter(*handlerLists->GetHandlersAfter(), Stats, static_cast<const ReturnType&>(*outReturnValue), self, args...);
+			return outReturnValue;
+		}
+		
 		// Capture the pointer of the return value
 		// so ScopeType does not have to know about that special case
-		auto Trampoline = [&](ConstCorrectThisPtr self_, ArgumentTypes... args_) -> ReturnType {
-			(reinterpret_cast<ReturnType*(*)(ConstCorrectThisPtr, ReturnType*, ArgumentTypes...)>(functionPtr))(self_, outReturnValue, args_...);
-			return *outReturnValue;
+		auto Trampoline = [outReturnValue](ConstCorrectThisPtr self_, ArgumentTypes... args_) -> ReturnType {
+			reinterpret_cast<TrampolineType>(functionPtr)(self_, outReturnValue, args_...);
+			//outReturnValue is overwritten with the final result at the end of the call anyway
+			return MoveTemp(*outReturnValue);
 		};
 
-		ScopeType scope(handlersBefore, Trampoline);
+		ScopeType scope(HandlersBefore, Trampoline, Stats);
 		scope(self, args...);
-		for (HandlerAfter& handler : *handlersAfter)
-			handler(scope.getResult(), self, args...);
-		//We always return outReturnValue, so copy our result to output variable and return it
-		*outReturnValue = scope.getResult();
+		callHandlersAfter(*handlerLists->GetHandlersAfter(), Stats, scope.getResult(), self, args...);
+		//We always return outReturnValue, so move our result to output variable and return it
+		*outReturnValue = scope.moveResult();
 		return outReturnValue;
 	}
 
@@ -290,19 +849,33 @@ private:
 	//If it were returning user type by value, first argument would be R*, which is incorrect - that's why we need separate
 	//applyCallUserType with correct argument order
 	static ReturnType applyCallScalar(CallableType* self, ArgumentTypes... args) {
-		ScopeType scope(handlersBefore, functionPtr);
+		FNativeHookCallGuard CallGuard;
+		FNativeHookStats* Stats = BeginProfiledHookCall(handlerLists->Stats.load(std::memory_order_relaxed));
+		const typename HandlerListsType::BeforeArrayType* HandlersBefore = handlerLists->GetHandlersBefore();
+		if (HandlersBefore->Num() == 0) {
+			ReturnType Result = callOriginalFunction(Stats, [&]() { return functionPtr(self, args...); });
+			callHandlersAfter(*handlerLists->GetHandlersAfter(), Stats, Result, self, args...);
+			return Result;
+		}
+		ScopeType scope(HandlersBefore, functionPtr, Stats);
 		scope(self, args...);
-		for (HandlerAfter& handler : *handlersAfter)
-			handler(scope.getResult(), self, args...);
+		callHandlersAfter(*handlerLists->GetHandlersAfter(), Stats, scope.getResult(), self, args...);
 		return scope.getResult();
 	}
 
 	//Call for void return type - nothing special to do with void
 	static void applyCallVoid(CallableType* self, ArgumentTypes... args) {
-		ScopeType scope(handlersBefore, functionPtr);
+		FNativeHookCallGuard CallGuard;
+		FNativeHookStats* Stats = BeginProfiledHookCall(handlerLists->Stats.load(std::memory_order_relaxed));
+		const typename HandlerListsType::BeforeArrayType* HandlersBefore = handlerLists->GetHandlersBefore();
+		if (HandlersBefore->Num() == 0) {
+			callOriginalFunction(Stats, [&]() { functionPtr(self, args...); });
+			callHandlersAfter(*handlerLists->GetHandlersAfter(), Stats, self, args...);
+			return;
+		}
+		ScopeType scope(HandlersBefore, functionPtr, Stats);
 		scope(self, args...);
-		for (HandlerAfter& handler : *handlersAfter)
-			handler(self, args...);
+		callHandlersAfter(*handlerLists->GetHandlersAfter(), Stats, self, args...);
 	}
 
     static void* getApplyCall1(std::true_type) {
@@ -328,33 +901,49 @@ private:
     	return getApplyCall1(std::is_same<ReturnType, void>{});
 	}
 public:
+	//Install the hook and add the handler under a single registration lock, so removal of the last handler
+	//on another thread can never uninstall the hook between the two and leave the new handler on an unhooked function
+	static FDelegateHandle subscribeBefore(const FString& DebugSymbolName, Handler handler, void* SampleObjectInstance = NULL, const TCHAR* OwnerModuleName = SML_HOOK_OWNER_MODULE_NAME) {
+		FScopeLock Lock(&FNativeHookManagerInternal::GetRegistrationLock());
+		InstallHook(DebugSymbolName, SampleObjectInstance);
+		return handlerLists->AddHandlerBefore(MoveTemp(handler), OwnerModuleName);
+	}
+
+	static FDelegateHandle subscribeAfter(const FString& DebugSymbolName, HandlerAfter handler, void* SampleObjectInstance = NULL, const TCHAR* OwnerModuleName = SML_HOOK_OWNER_MODULE_NAME) {
+		FScopeLock Lock(&FNativeHookManagerInternal::GetRegistrationLock());
+		InstallHook(DebugSymbolName, SampleObjectInstance);
+		return handlerLists->AddHandlerAfter(MoveTemp(handler), OwnerModuleName);
+	}
+
 	//Handles normal member function hooking, e.g hooking fixed symbol implementation in executable
 	static void InstallHook(const FString& DebugSymbolName, void* SampleObjectInstance = NULL) {
-		if (!bHookInitialized) {
-			bHookInitialized = true;
+		FScopeLock Lock(&FNativeHookManagerInternal::GetRegistrationLock());
+		//Hook is installed again if it has been uninstalled after removing all of the handlers
+		if (handlerLists == nullptr || !handlerLists->bHookInstalled) {
 			void* HookFunctionPointer = getApplyCall();
 			TMemberFunctionPointer<TCallable> RawFunctionPointer{};
 			RawFunctionPointer.MemberFunctionPointer = Callable;
 			const FMemberFunctionPointer MemberFunctionPointer = ConvertFunctionPointer(&RawFunctionPointer);
 			
-			void* RealFunctionAddress = FNativeHookManagerInternal::RegisterHookFunction(DebugSymbolName,
+			FNativeHookManagerInternal::RegisterHookFunction(DebugSymbolName,
 				MemberFunctionPointer.FunctionAddress,
 				SampleObjectInstance,
 				MemberFunctionPointer.ThisAdjustment,
-				HookFunctionPointer, (void**) &functionPtr);
-			
-			auto* HandlerLists = createHandlerLists<Handler, HandlerAfter>(RealFunctionAddress);
-			handlersBefore = &HandlerLists->HandlersBefore;
-			handlersAfter = &HandlerLists->HandlersAfter;
+				HookFunctionPointer, (void**) &functionPtr,
+				&HandlerListsType::Create, (void**) &handlerLists);
 		}
 	}
 
-	static void addHandlerBefore(Handler handler) {
-		handlersBefore->Add(handler);
+	static FDelegateHandle addHandlerBefore(Handler handler, const TCHAR* OwnerModuleName = SML_HOOK_OWNER_MODULE_NAME) {
+		return handlerLists->AddHandlerBefore(MoveTemp(handler), OwnerModuleName);
 	}
 
-	static void addHandlerAfter(HandlerAfter handler) {
-		handlersAfter->Add(handler);
+	static FDelegateHandle addHandlerAfter(HandlerAfter handler, const TCHAR* OwnerModuleName = SML_HOOK_OWNER_MODULE_NAME) {
+		return handlerLists->AddHandlerAfter(MoveTemp(handler), OwnerModuleName);
+	}
+
+	static bool removeHandler(FDelegateHandle Handle) {
+		return handlerLists != nullptr && handlerLists->RemoveHandler(Handle);
 	}
 };
 
@@ -377,44 +966,37 @@ template <typename TCallable, TCallable Callable, bool bIsConst, typename Return
 typename HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::HookType* HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::functionPtr = nullptr;
 
 template <typename TCallable, TCallable Callable, bool bIsConst, typename ReturnType, typename CallableType, typename... ArgumentTypes>
-bool HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::bHookInitialized = false;
-
-template <typename TCallable, TCallable Callable, bool bIsConst, typename ReturnType, typename CallableType, typename... ArgumentTypes>
-TArray<typename HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::Handler>* HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::handlersBefore = nullptr;
-
-template <typename TCallable, TCallable Callable, bool bIsConst, typename ReturnType, typename CallableType, typename... ArgumentTypes>
-TArray<typename HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::HandlerAfter>* HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::handlersAfter = nullptr;
+typename HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::HandlerListsType* HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::handlerLists = nullptr;
 
 
 template <typename TCallable, TCallable Callable, typename ReturnType, typename... ArgumentTypes>
 typename HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::HookType HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::functionPtr = nullptr;
 
 template <typename TCallable, TCallable Callable, typename ReturnType, typename... ArgumentTypes>
-bool HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::bHookInitialized = false;
+typename HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::HandlerListsType* HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::handlerLists = nullptr;
 
-template <typename TCallable, TCallable Callable, typename ReturnType, typename... ArgumentTypes>
-TArray<typename HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::Handler>* HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::handlersBefore = nullptr;
-
-template <typename TCallable, TCallable Callable, typename ReturnType, typename... ArgumentTypes>
-TArray<typename HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::HandlerAfter>* HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::handlersAfter = nullptr;
 
+//SUBSCRIBE_METHOD* macros return FDelegateHandle that can be passed to UNSUBSCRIBE_METHOD to remove the handler later
+//Once the last handler of the function is removed, hook is uninstalled and original function runs without any overhead,
+//except for hooks installed by the hook transaction, which stay installed and only pass the calls through
 
 #define SUBSCRIBE_METHOD(MethodReference, Handler) \
-HookInvoker<decltype(&MethodReference), &MethodReference>::InstallHook(TEXT(#MethodReference)); \
-HookInvoker<decltype(&MethodReference), &MethodReference>::addHandlerBefore(Handler);
+HookInvoker<decltype(&MethodReference), &MethodReference>::subscribeBefore(TEXT(#MethodReference), Handler)
 
 #define SUBSCRIBE_METHOD_AFTER(MethodReference, Handler) \
-HookInvoker<decltype(&MethodReference), &MethodReference>::InstallHook(TEXT(#MethodReference)); \
-HookInvoker<decltype(&MethodReference), &MethodReference>::addHandlerAfter(Handler);
+HookInvoker<decltype(&MethodReference), &MethodReference>::subscribeAfter(TEXT(#MethodReference), Handler)
 
 #define SUBSCRIBE_METHOD_VIRTUAL(MethodReference, SampleObjectInstance, Handler) \
-HookInvoker<decltype(&MethodReference), &MethodReference>::InstallHook(TEXT(#MethodReference), SampleObjectInstance); \
-HookInvoker<decltype(&MethodReference), &MethodReference>::addHandlerBefore(Handler);
+HookInvoker<decltype(&MethodReference), &MethodReference>::subscribeBefore(TEXT(#MethodReference), Handler, SampleObjectInstance)
 
 #define SUBSCRIBE_METHOD_VIRTUAL_AFTER(MethodReference, SampleObjectInstance, Handler) \
-HookInvoker<decltype(&MethodReference), &MethodReference>::InstallHook(TEXT(#MethodReference), SampleObjectInstance); \
-HookInvoker<decltype(&MethodReference), &MethodReference>::addHandlerAfter(Handler);
+HookInvoker<decltype(&MethodReference), &MethodReference>::subscribeAfter(TEXT(#MethodReference), Handler, SampleObjectInstance)
 
 #define SUBSCRIBE_METHOD_EXPLICIT_VIRTUAL_AFTER(MethodSignature, MethodReference, SampleObjectInstance, Handler) \
-HookInvoker<MethodSignature, &MethodReference>::InstallHook(TEXT(#MethodReference), SampleObjectInstance); \
-HookInvoker<MethodSignature, &MethodReference>::addHandlerAfter(Handler);
\ No newline at end of file
+HookInvoker<MethodSignature, &MethodReference>::subscribeAfter(TEXT(#MethodReference), Handler, SampleObjectInstance)
+
+#define UNSUBSCRIBE_METHOD(MethodReference, HandlerHandle) \
+HookInvoker<decltype(&MethodReference), &MethodReference>::removeHandler(HandlerHandle)
+
+#define UNSUBSCRIBE_METHOD_EXPLICIT(MethodSignature, MethodReference, HandlerHandle) \
+HookInvoker<MethodSignature, &MethodReference>::removeHandler(HandlerHandle)
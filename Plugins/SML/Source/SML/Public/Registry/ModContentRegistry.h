@@ -3,6 +3,7 @@
 #include "FGSchematic.h"
 #include "FGRecipe.h"
 #include "Engine/DataTable.h"
+#include "Engine/StreamableManager.h"
 #include "Subsystem/ModSubsystem.h"
 #include "ModContentRegistry.generated.h"
 
@@ -77,6 +78,8 @@ private:
     
     TArray<TSharedPtr<T>> RegistrationList;
     TMap<KeyType, TSharedPtr<T>> RegistrationMap;
+    /** Registrations grouped by the mod reference of their owner, in registration order */
+    TMap<FName, TArray<TSharedPtr<T>>> RegistrationsByOwner;
     
     //Used for fast AddReferencedObjects implementation
     //It cannot be UPROPERTY() because UHT won't understand UPROPERTY() declaration inside template struct
@@ -94,6 +97,7 @@ public:
         TSharedPtr<T> RegistrationEntry = MakeShareable(new T{ObjectInfo});
         RegistrationList.Add(RegistrationEntry);
         RegistrationMap.Add(RegistrationEntry->RegisteredObject, RegistrationEntry);
+        RegistrationsByOwner.FindOrAdd(RegistrationEntry->OwnedByModReference).Add(RegistrationEntry);
         ReferencedObjects.Add(RegistrationEntry->RegisteredObject);
         RegistrationCounter++;
         return RegistrationEntry;
@@ -108,10 +112,24 @@ public:
         return RegistrationList;
     }
 
+    FORCEINLINE TArrayView<const TSharedPtr<T>> GetObjectsOwnedBy(const FName& OwnerModReference) const {
+        const TArray<TSharedPtr<T>>* OwnedObjects = RegistrationsByOwner.Find(OwnerModReference);
+        return OwnedObjects ? TArrayView<const TSharedPtr<T>>(*OwnedObjects) : TArrayView<const TSharedPtr<T>>();
+    }
+
     FORCEINLINE int64 GetRegistrationCounter() const {
         return RegistrationCounter;
     }
 
+    /**
+     * Returns objects registered after registration counter had the provided value
+     * Registrations are never removed, so registration list doubles as a log of additions
+     */
+    FORCEINLINE TArrayView<const TSharedPtr<T>> GetObjectsRegisteredSince(int64 PreviousRegistrationCounter) const {
+        const int32 FirstIndex = (int32) FMath::Clamp<int64>(PreviousRegistrationCounter, 0, RegistrationList.Num());
+        return MakeArrayView(RegistrationList.GetData() + FirstIndex, RegistrationList.Num() - FirstIndex);
+    }
+
     FORCEINLINE void AddReferencedObjects(UObject* Outer, FReferenceCollector& ReferenceCollector) {
         ReferenceCollector.AddReferencedObjects(ReferencedObjects, Outer);
     }
@@ -122,6 +140,18 @@ struct FMissingObjectStruct {
     FString ObjectPath;
 };
 
+/** Dependencies of the content class, extracted from its CDO ahead of the actual registration */
+struct FContentDependencyInfo {
+    /** Mod reference of the plugin owning the content class */
+    FName OwnerModReference;
+    /** Content referenced by the class: schematics for research trees, recipes for schematics and item descriptors for recipes */
+    TArray<UClass*> ReferencedContent;
+    /** Material customization recipe referenced by the recipe, if there is one */
+    UClass* CustomizationRecipe = NULL;
+    /** Number of recipe ingredients at the start of ReferencedContent, the rest of it are recipe products */
+    int32 NumIngredients = 0;
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnSchematicRegistered, TSubclassOf<UFGSchematic>, Schematic, FSchematicRegistrationInfo, RegistrationInfo);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnResearchTreeRegistered, TSubclassOf<UFGResearchTree>, ResearchTree, FResearchTreeRegistrationInfo, RegistrationInfo);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnRecipeRegistered, TSubclassOf<UFGRecipe>, Recipe, FRecipeRegistrationInfo, RegistrationInfo);
@@ -183,6 +213,18 @@ public:
     UFUNCTION(BlueprintCallable, CustomThunk)
     void RegisterRecipe(const FName ModReference, TSubclassOf<UFGRecipe> Recipe);
     
+    /**
+     * Registers schematics and research trees of a single mod in one batch
+     * Dependencies of the whole batch are extracted from CDOs level by level first, and then content is
+     * registered in the same order individual Register calls would register it
+     * Time spent on both phases is logged per mod
+     *
+     * @param ModReference identifier of the mod who is performing this registration
+     * @param Schematics schematics to be registered, as if by RegisterSchematic
+     * @param ResearchTrees research trees to be registered after schematics, as if by RegisterResearchTree
+     */
+    void RegisterContentBatch(const FName ModReference, const TArray<TSubclassOf<UFGSchematic>>& Schematics, const TArray<TSubclassOf<UFGResearchTree>>& ResearchTrees);
+    
     /** Register resource sink item points for each item row in the passed table object */
     UFUNCTION(BlueprintCallable, CustomThunk)
     void RegisterResourceSinkItemPointTable(const FName ModReference, UDataTable* PointTable);
@@ -203,6 +245,7 @@ public:
     UFUNCTION(BlueprintPure)
     FORCEINLINE TArray<FRecipeRegistrationInfo> GetRegisteredRecipes() const {
         TArray<FRecipeRegistrationInfo> RegistrationInfos;
+        RegistrationInfos.Reserve(RecipeRegistryState.GetAllObjects().Num());
         for (const TSharedPtr<FRecipeRegistrationInfo>& RegistrationInfo : RecipeRegistryState.GetAllObjects()) {
             RegistrationInfos.Add(*RegistrationInfo);
         }
@@ -220,6 +263,7 @@ public:
     UFUNCTION(BlueprintPure)
     FORCEINLINE TArray<FResearchTreeRegistrationInfo> GetRegisteredResearchTrees() const {
         TArray<FResearchTreeRegistrationInfo> RegistrationInfos;
+        RegistrationInfos.Reserve(ResearchTreeRegistryState.GetAllObjects().Num());
         for (const TSharedPtr<FResearchTreeRegistrationInfo>& RegistrationInfo : ResearchTreeRegistryState.GetAllObjects()) {
             RegistrationInfos.Add(*RegistrationInfo);
         }
@@ -237,6 +281,7 @@ public:
     UFUNCTION(BlueprintPure)
     FORCEINLINE TArray<FSchematicRegistrationInfo> GetRegisteredSchematics() const {
         TArray<FSchematicRegistrationInfo> RegistrationInfos;
+        RegistrationInfos.Reserve(SchematicRegistryState.GetAllObjects().Num());
         for (const TSharedPtr<FSchematicRegistrationInfo>& RegistrationInfo : SchematicRegistryState.GetAllObjects()) {
             RegistrationInfos.Add(*RegistrationInfo);
         }
@@ -250,6 +295,58 @@ public:
         return RegistrationInfo.IsValid() ? *RegistrationInfo : FSchematicRegistrationInfo{};
     }
 
+    /**
+     * Zero-copy accessors for native code. Returned views point directly into the registry state,
+     * entries must not be modified, and views are only valid until the next registration
+     */
+
+    /** Returns all currently registered recipes */
+    FORCEINLINE TArrayView<const TSharedPtr<FRecipeRegistrationInfo>> GetRegisteredRecipesView() const {
+        return RecipeRegistryState.GetAllObjects();
+    }
+
+    /** Returns all currently registered schematics */
+    FORCEINLINE TArrayView<const TSharedPtr<FSchematicRegistrationInfo>> GetRegisteredSchematicsView() const {
+        return SchematicRegistryState.GetAllObjects();
+    }
+
+    /** Returns all currently registered research trees */
+    FORCEINLINE TArrayView<const TSharedPtr<FResearchTreeRegistrationInfo>> GetRegisteredResearchTreesView() const {
+        return ResearchTreeRegistryState.GetAllObjects();
+    }
+
+    /** Returns recipes owned by the provided mod */
+    FORCEINLINE TArrayView<const TSharedPtr<FRecipeRegistrationInfo>> GetRecipesOwnedBy(const FName ModReference) const {
+        return RecipeRegistryState.GetObjectsOwnedBy(ModReference);
+    }
+
+    /** Returns schematics owned by the provided mod */
+    FORCEINLINE TArrayView<const TSharedPtr<FSchematicRegistrationInfo>> GetSchematicsOwnedBy(const FName ModReference) const {
+        return SchematicRegistryState.GetObjectsOwnedBy(ModReference);
+    }
+
+    /** Returns research trees owned by the provided mod */
+    FORCEINLINE TArrayView<const TSharedPtr<FResearchTreeRegistrationInfo>> GetResearchTreesOwnedBy(const FName ModReference) const {
+        return ResearchTreeRegistryState.GetObjectsOwnedBy(ModReference);
+    }
+
+    /** Returns item descriptors owned by the provided mod. Only includes item descriptors known to the registry so far */
+    FORCEINLINE TArrayView<const TSharedPtr<FItemRegistrationInfo>> GetItemDescriptorsOwnedBy(const FName ModReference) const {
+        return ItemRegistryState.GetObjectsOwnedBy(ModReference);
+    }
+
+    /** Returns registered recipes having provided item descriptor as one of their products */
+    TArrayView<const TSubclassOf<UFGRecipe>> GetRecipesProducingItem(TSubclassOf<UFGItemDescriptor> ItemDescriptor) const;
+
+    /** Returns registered recipes having provided item descriptor as one of their ingredients */
+    TArrayView<const TSubclassOf<UFGRecipe>> GetRecipesConsumingItem(TSubclassOf<UFGItemDescriptor> ItemDescriptor) const;
+
+    /**
+     * Returns all currently loaded item descriptors. Result is cached and only rebuilt when item descriptors have been registered
+     * or any classes have been loaded since the last call, instead of iterating all loaded classes every time
+     */
+    TArrayView<const TSharedPtr<FItemRegistrationInfo>> GetLoadedItemDescriptorsView();
+
     /** Returns true when given recipe is registered */
     UFUNCTION(BlueprintPure)
     FORCEINLINE bool IsRecipeRegistered(TSubclassOf<UFGRecipe> Recipe) const {
@@ -301,6 +398,9 @@ private:
     int64 SchematicManagerInternalState;
     int64 ResearchManagerInternalState;
 
+    /** Amount of schematics purchased in the schematic manager at the moment of the last flush, used to detect unlock state changes */
+    int32 SchematicManagerPurchasedSchematicCount;
+
     /** True when we have subscribed to schematic manager delegates already */
     bool bSubscribedToSchematicManager;
 
@@ -328,11 +428,44 @@ private:
     /** List of all registered research trees */
     TInternalRegistryState<FResearchTreeRegistrationInfo> ResearchTreeRegistryState;
 
-    /** Flushes schematic registry state into schematic manager */
-    void FlushStateToSchematicManager(class AFGSchematicManager* SchematicManager) const;
+    /** Registered recipes indexed by item descriptors they produce. Both keys and values are kept alive by registry states */
+    TMap<UClass*, TArray<TSubclassOf<UFGRecipe>>> RecipesByProducedItem;
+
+    /** Registered recipes indexed by item descriptors they consume */
+    TMap<UClass*, TArray<TSubclassOf<UFGRecipe>>> RecipesByConsumedItem;
+
+    /** Cached registration entries of all loaded item descriptors, returned by GetLoadedItemDescriptorsView */
+    TArray<TSharedPtr<FItemRegistrationInfo>> LoadedItemDescriptorsCache;
+
+    /** Whenever LoadedItemDescriptorsCache is up to date. Reset when item descriptors are registered */
+    bool bLoadedItemDescriptorsCacheValid;
+
+    /** Registered classes version number at the moment LoadedItemDescriptorsCache was built. Cache is rebuilt once it changes */
+    uint64 LoadedItemDescriptorsCacheClassesVersion;
+
+    /** Marks loaded item descriptors cache outdated, so it is rebuilt on the next access */
+    void InvalidateLoadedItemDescriptorsCache();
+
+    /**
+     * Flushes schematic registry state into schematic manager
+     * Only schematics registered after the provided registration counter are appended and tested for availability, negative counter means full rebuild
+     * Available schematics are rebuilt from the whole registry when manager unlock state has changed since the last flush,
+     * since availability of the schematics flushed earlier might have changed with it
+     */
+    void FlushStateToSchematicManager(class AFGSchematicManager* SchematicManager, int64 FlushedRegistrationCounter, bool bUnlockStateChanged) const;
+
+    /**
+     * Flushes research tree registry state into research manager
+     * Only research trees registered after the provided registration counter are appended and checked for unlocking, negative counter means full rebuild
+     * Research trees flushed earlier are unlocked by the research manager itself once schematics they depend on are purchased
+     */
+    void FlushStateToResearchManager(class AFGResearchManager* ResearchManager, int64 FlushedRegistrationCounter) const;
+
+    /** Compares schematic manager lists against a full rebuild and replaces them with it on mismatch */
+    void VerifySchematicManagerState(class AFGSchematicManager* SchematicManager) const;
 
-    /** Flushes research tree registry state into research manager */
-    void FlushStateToResearchManager(class AFGResearchManager* ResearchManager) const;
+    /** Compares research manager lists against a full rebuild and replaces them with it on mismatch */
+    void VerifyResearchManagerState(class AFGResearchManager* ResearchManager) const;
 
     /** Subscribes to schematic manager delegates */
     void SubscribeToSchematicManager(AFGSchematicManager* SchematicManager);
@@ -343,9 +476,42 @@ private:
     /** Quick version of UBlueprintAssetHelperLibrary, using predefined mod reference for vanilla content */
     static FName FindContentOwnerFast(UClass* ContentClass);
 
+    /** Converts resolved content owner name to the mod reference, reporting content with no owner and falling back to the game */
+    static FName ValidateContentOwner(UClass* ContentClass, const FString& ContentOwnerName);
+
+    /** Dependencies extracted by the currently running content batch registration, empty otherwise */
+    TMap<UClass*, FContentDependencyInfo> PrefetchedDependencies;
+
+    /**
+     * Extracts dependencies of the provided content and everything it references into PrefetchedDependencies
+     * Has to be called on the game thread, but reads default objects on the worker threads
+     */
+    void PrefetchContentDependencies(const TArray<UClass*>& Schematics, const TArray<UClass*>& ResearchTrees);
+
+    /** Resolves owners of all prefetched content, looking up owners of the asset classes on worker threads in parallel */
+    void ResolvePrefetchedContentOwners();
+
+    /** Returns owner of the content class, using prefetched dependencies when they are available */
+    FName FindContentOwner(UClass* ContentClass) const;
+
 	/** Called when module content registration is finished and registry can be frozen */
 	void NotifyModuleRegistrationFinished();
 
+    /** Handle for vanilla content that was not loaded yet at Init and is being streamed in, invalid once discovery has finished */
+    TSharedPtr<FStreamableHandle> VanillaContentStreamHandle;
+
+    /**
+     * Starts streaming in vanilla content that is not loaded yet, before the registry itself is spawned,
+     * so it loads together with the world. Returned handle has to be kept alive until the registry is initialized
+     */
+    static TSharedPtr<FStreamableHandle> StreamVanillaContentInAdvance();
+
+    /** Registers vanilla content once it has been streamed in. Does nothing if it has been registered already */
+    void OnVanillaContentStreamed();
+
+    /** Blocks until vanilla content streaming finishes and registers it. Called before world modules register their content and before freezing */
+    void WaitForVanillaContentDiscovery();
+
 	/** Flushed pending resource sink registrations into the resource sink subsystem, if it is available */
 	void FlushPendingResourceSinkRegistrations();
    
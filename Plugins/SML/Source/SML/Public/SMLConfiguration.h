@@ -34,6 +34,30 @@ public:
     * See UFGCheatManager for command list
     */
     bool bEnableCheatConsoleCommands;
+
+    /**
+    * Whenever to keep binary copies of the mod configuration files in the Saved folder
+    * Unchanged configuration files are loaded from these copies, skipping JSON parsing on startup
+    */
+    bool bEnableConfigBinaryCache;
+
+    /**
+    * Maximum amount of mod messages accepted from a single connection per second, 0 means no limit
+    * Messages above the limit are dropped, and mods can react to it through UModNetworkHandler::OnModMessageRateLimitExceeded
+    */
+    int32 MaxModMessagesPerSecond;
+
+    /**
+    * Maximum amount of uncompressed mod message data in bytes accepted from a single connection per second, 0 means no limit
+    * Note that a single message larger than this limit is always dropped
+    */
+    int32 MaxModMessageBytesPerSecond;
+
+    /**
+    * Interval in seconds between log lines with the mod message traffic statistics of all connections, 0 disables them
+    * Same statistics can be logged on demand with SML.Network.DumpStats console command
+    */
+    float NetworkStatisticsLogInterval;
 public:
     /** Deserializes configuration from JSON object */
     static void ReadFromJson(const TSharedPtr<class FJsonObject>& Json, FSMLConfiguration& OutConfiguration, bool* OutIsMissingSections = NULL);
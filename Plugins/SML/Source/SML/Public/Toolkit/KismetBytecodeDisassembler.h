@@ -10,7 +10,10 @@ public:
 	/** Parses a block of statements until it hits return */
 	TArray<TSharedPtr<FJsonValue>> SerializeFunction(UStruct* Function);
 
-	/** Computes length of the statement in bytes and returns it. Returns false if given index does not correspond to any statement (e.g if it is inside of some statement) */
+	/**
+	 * Computes length of the statement in bytes and returns it. Returns false if given index does not correspond to any statement (e.g if it is inside of some statement)
+	 * Indexes the whole function on every call, use FSMLKismetStatementIndex directly for repeated lookups
+	 */
 	bool GetStatementLength(UStruct* Function, int32 StatementIndex, int32& OutStatementLength);
 
 	/** Returns index of the first statement using given opcode */
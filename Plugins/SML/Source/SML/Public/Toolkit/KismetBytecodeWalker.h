@@ -0,0 +1,45 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/** Receives expressions encountered by FSMLKismetBytecodeWalker */
+class SML_API ISMLKismetBytecodeVisitor {
+public:
+	virtual ~ISMLKismetBytecodeVisitor() {}
+
+	/**
+	 * Called for every expression once it has been fully walked, so sub-expressions are always visited before the expression containing them
+	 * Expressions with zero depth are statements, e.g. their offsets are valid jump targets
+	 */
+	virtual void VisitExpression(uint8 Opcode, int32 Offset, int32 Length, int32 Depth) = 0;
+
+	/**
+	 * Called before the walker decodes statement at the provided offset. Visitors that decode statements themselves can return true
+	 * and report the statement length, so the walker advances past it without decoding it again and without visiting its expressions
+	 */
+	virtual bool ConsumeStatement(int32 Offset, int32& OutLength) { return false; }
+};
+
+/**
+ * Walks script bytecode and reports opcode, offset and length of every expression without allocating anything
+ * Unlike FSMLKismetBytecodeDisassembler it does not decode operands, so it is cheap enough for
+ * runtime use like statement lookup during blueprint hook installation
+ */
+class SML_API FSMLKismetBytecodeWalker {
+public:
+	explicit FSMLKismetBytecodeWalker(const TArray<uint8>& InScript) : Script(InScript) {}
+
+	/** Walks statements starting at the provided offset until the end of the script, skipping statements consumed by the visitor */
+	void WalkStatements(int32 StartOffset, ISMLKismetBytecodeVisitor& Visitor) const;
+
+	/** Walks expression at ScriptIndex, advancing it past the expression. Visitor can be NULL to just skip the expression */
+	void WalkExpression(int32& ScriptIndex, ISMLKismetBytecodeVisitor* Visitor, int32 Depth = 0) const;
+
+	/** Advances ScriptIndex past the expression starting at it, including all of its sub-expressions */
+	FORCEINLINE void SkipExpression(int32& ScriptIndex) const { WalkExpression(ScriptIndex, NULL); }
+private:
+	const TArray<uint8>& Script;
+
+	void SkipString(int32& ScriptIndex) const;
+	void SkipString8(int32& ScriptIndex) const;
+	void SkipString16(int32& ScriptIndex) const;
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * Index of statement boundaries inside of the function's script bytecode
+ * Built in a single FSMLKismetBytecodeWalker pass without materializing expressions, and updated in place
+ * when the script is patched, so repeated statement lookups don't have to re-parse the whole function
+ */
+class SML_API FSMLKismetStatementIndex {
+public:
+	/** Rebuilds index from scratch using the current script of the provided function */
+	void Build(UStruct* Function);
+
+	/** Returns true if the index has been built */
+	FORCEINLINE bool IsBuilt() const { return ScriptSize != INDEX_NONE; }
+
+	/** Computes length of the statement in bytes. Returns false if given index does not correspond to any statement */
+	bool GetStatementLength(int32 StatementIndex, int32& OutStatementLength) const;
+
+	/** Returns index of the first statement at or after StartIndex using given opcode */
+	bool FindFirstStatementOfType(int32 StartIndex, uint8 StatementOpcode, int32& OutStatementIndex) const;
+
+	/**
+	 * Updates index after statements in range [PatchOffset, PatchOffset + PatchLength) have been replaced
+	 * with a single EX_Jump followed by EX_EndOfScript padding, and new code has been appended to the
+	 * function's script starting at AppendedCodeOffset
+	 */
+	void NotifyScriptPatched(UStruct* Function, int32 PatchOffset, int32 PatchLength, int32 AppendedCodeOffset);
+private:
+	/** Offsets of the statements, in ascending order */
+	TArray<int32> StatementOffsets;
+	/** Opcodes of the statements, parallel to StatementOffsets */
+	TArray<uint8> StatementOpcodes;
+	/** Size of the script this index describes, used to compute length of the last statement */
+	int32 ScriptSize = INDEX_NONE;
+
+	/** Walks statements starting at the provided offset and appends them to the index */
+	void AppendStatements(UStruct* Function, int32 StartOffset);
+};
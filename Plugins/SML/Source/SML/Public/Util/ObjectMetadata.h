@@ -22,4 +22,10 @@ public:
         }
         return Cast<T>(*Result);
     }
+
+    template<typename T>
+    T* FindSubObject(const FString& Name) const {
+        UObject* const* Result = Subobjects.Find(Name);
+        return Result != NULL ? Cast<T>(*Result) : NULL;
+    }
 };
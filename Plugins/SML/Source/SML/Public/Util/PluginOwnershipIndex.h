@@ -0,0 +1,75 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class IPlugin;
+
+/** Describes plugin owning some mount point or module */
+struct SML_API FPluginOwnerEntry {
+    /** Name of the owning plugin */
+    FString PluginName;
+    /** True if the owning plugin is considered a mod by UModLoadingLibrary::IsPluginAMod */
+    bool bIsMod = false;
+};
+
+/** Ownership information of the single plugin, as it is stored in the index */
+struct SML_API FPluginOwnershipInfo {
+    FPluginOwnerEntry Owner;
+    /** Mount point of the plugin content without leading and trailing slashes, empty if plugin has no content */
+    FString MountPoint;
+    /** Names of the modules declared by the plugin */
+    TArray<FName> ModuleNames;
+
+    /** Collects ownership information of the provided plugin */
+    static FPluginOwnershipInfo FromPlugin(IPlugin& Plugin);
+};
+
+/**
+ * Persistent index mapping content mount points and native module names to the enabled plugins owning them
+ * Global index is populated from the plugin manager on first use and rebuilt whenever UModLoadingLibrary reports
+ * a plugin being created or mounted, so ownership lookups, including the ones that miss,
+ * are a single hash of the path segment instead of a scan over every enabled plugin
+ *
+ * Lookups are safe to perform from multiple threads at once
+ */
+class SML_API FPluginOwnershipIndex {
+public:
+    /** Creates an empty index. Only the global index tracks the plugin manager, other ones are populated using Build */
+    explicit FPluginOwnershipIndex(bool bTrackPluginManager = false);
+
+    /** Returns global ownership index instance, tracking plugins enabled in the plugin manager */
+    static FPluginOwnershipIndex& Get();
+
+    /** Marks the index as outdated, so it is rebuilt from the enabled plugins on the next lookup */
+    void Invalidate();
+
+    /** Replaces contents of the index with the provided plugins. Earlier plugins take priority over later ones */
+    void Build(const TArray<FPluginOwnershipInfo>& Plugins);
+
+    /** Finds plugin owning the provided mount point, specified without leading and trailing slashes */
+    bool FindOwnerForMountPoint(const FString& MountPoint, FPluginOwnerEntry& OutOwner);
+
+    /**
+     * Finds the first plugin declaring the module with the provided name
+     * When bModsOnly is set, plugins that are not mods are skipped, so a mod declaring the same module is preferred over them
+     */
+    bool FindOwnerForModule(FName ModuleName, bool bModsOnly, FPluginOwnerEntry& OutOwner);
+
+    /**
+     * Rebuilds the index from the enabled plugins if it has been invalidated. Does nothing unless the index tracks the plugin manager
+     * Called by lookups automatically, but should be called on the game thread before performing lookups from worker threads,
+     * so they never have to query the plugin manager
+     */
+    void EnsureIndexUpToDate();
+private:
+
+    /** Replaces contents of the index. Caller must hold the write lock */
+    void BuildInternal(const TArray<FPluginOwnershipInfo>& Plugins);
+
+    FRWLock IndexLock;
+    const bool bTrackPluginManager;
+    bool bIndexBuilt = false;
+    TMap<FString, FPluginOwnerEntry> OwnerByMountPoint;
+    TMap<FName, FPluginOwnerEntry> OwnerByModuleName;
+    /** Same as above, but only considering mod plugins */
+    TMap<FName, FPluginOwnerEntry> ModOwnerByModuleName;
+};